@@ -1,84 +1,1267 @@
-/*
- * 算法库
- */
-#ifndef ALGORITHM_H
-#define ALGORITHM_H
-
-#include "memory.h"
-
-namespace bitstl
-{
-    /*
-     * swap函数
-     */
-    template<typename T>
-    constexpr inline void swap(T& lhs, T& rhs)
-    {
-        auto tmp(move(lhs));
-        lhs = move(rhs);
-        rhs = move(tmp);
-    }
-
-    template<typename T, size_t N>
-    constexpr inline void swap(T(&a)[N], T(&b)[N])
-    {
-        for (size_t n = 0; n < N; ++n)
-            swap(a[n], b[n]);
-    }
-
-    // 从first开始填充count个元素
-    template<typename OutputIterator, typename Size, typename T>
-    OutputIterator fill_n(OutputIterator first, Size count, const T& value)
-    {
-        for (Size i = 0; i < count; ++i)
-            *first++ = value;
-        return first;
-    }
-
-    // 从first到last填充元素
-    template<typename ForwardIterator, typename T>
-    void fill(ForwardIterator first, ForwardIterator last, const T& value)
-    {
-        for (; first != last; ++first)
-            *first = value;
-    }
-
-    // 将first至last的元素复制到以dest_first开始的内存中
-    template<typename InputIterator, typename OutputIterator>
-    OutputIterator copy(InputIterator first, InputIterator last, OutputIterator dest_first)
-    {
-        // (void)用于避免逗号运算符被重载的情况
-        for (; first != last; (void)++first, (void)++dest_first)
-            *dest_first = *first;
-
-        return dest_first;
-    }
-
-    // 根据条件pred将first至last的元素复制到以dest_first开始的内存中
-    template<typename InputIterator, typename OutputIterator, typename UnaryPredicate>
-    OutputIterator copy_if(InputIterator first, InputIterator last, OutputIterator dest_first, UnaryPredicate pred)
-    {
-        for (; first != last; ++first)
-        {
-            if (pred(*first))
-            {
-                *dest_first = *first;
-                ++dest_first;
-            }
-        }
-        return dest_first;
-    }
-
-    // 将first至last的元素移动到以dest_first开始的内存中
-    template<typename InputIterator, typename OutputIterator>
-    OutputIterator move(InputIterator first, InputIterator last, OutputIterator dest_first)
-    {
-        for (; first != last; (void)++first, (void)++dest_first)
-            *dest_first = move(*first);
-
-        return dest_first;
-    }
-}
-
-#endif // !ALGORITHM_H
-
+/*
+ * 算法库
+ */
+#ifndef ALGORITHM_H
+#define ALGORITHM_H
+
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "iterator.h"
+#include "allocator.h"
+#include "memory.h"
+#include "simd.h"
+
+namespace bitstl
+{
+    /*
+     * swap函数
+     */
+    template<typename T>
+    constexpr inline void swap(T& lhs, T& rhs)
+    {
+        auto tmp(bitstl::move(lhs));
+        lhs = bitstl::move(rhs);
+        rhs = bitstl::move(tmp);
+    }
+
+    template<typename T, size_t N>
+    constexpr inline void swap(T(&a)[N], T(&b)[N])
+    {
+        for (size_t n = 0; n < N; ++n)
+            swap(a[n], b[n]);
+    }
+
+    /*
+     * 连续内存的批量操作
+     * 迭代器为连续迭代器且元素可平凡复制时，copy、move使用memmove，fill、fill_n使用memset或原始指针上的循环
+     */
+    // 判断能否以memmove将InputIterator的元素复制（移动）到OutputIterator
+    template<typename InputIterator, typename OutputIterator, bool Move, typename = void>
+    inline constexpr bool is_memmove_copyable = false;
+
+    template<typename InputIterator, typename OutputIterator, bool Move>
+    inline constexpr bool is_memmove_copyable<InputIterator, OutputIterator, Move,
+        void_t<iterator_concept_t<InputIterator>, iterator_concept_t<OutputIterator>>> =
+        is_contiguous_iterator<InputIterator> && is_contiguous_iterator<OutputIterator>
+        && is_same_v<typename iterator_traits<InputIterator>::value_type, typename iterator_traits<OutputIterator>::value_type>
+        && !std::is_const_v<std::remove_reference_t<typename iterator_traits<OutputIterator>::reference>>
+        && std::is_trivially_copyable_v<typename iterator_traits<OutputIterator>::value_type>
+        && (Move ? std::is_trivially_move_assignable_v<typename iterator_traits<OutputIterator>::value_type>
+                 : std::is_trivially_copy_assignable_v<typename iterator_traits<OutputIterator>::value_type>);
+
+    // 判断能否直接写入ForwardIterator指向的原始内存进行填充
+    template<typename ForwardIterator, typename = void>
+    inline constexpr bool is_memset_fillable = false;
+
+    template<typename ForwardIterator>
+    inline constexpr bool is_memset_fillable<ForwardIterator, void_t<iterator_concept_t<ForwardIterator>>> =
+        is_contiguous_iterator<ForwardIterator>
+        && !std::is_const_v<std::remove_reference_t<typename iterator_traits<ForwardIterator>::reference>>
+        && std::is_trivially_copyable_v<typename iterator_traits<ForwardIterator>::value_type>
+        && std::is_trivially_copy_assignable_v<typename iterator_traits<ForwardIterator>::value_type>;
+
+    // 将first开始的count个元素复制到dest，区间可以重叠
+    template<typename T>
+    inline void memmove_n(T* dest, const T* first, size_t count)
+    {
+        if (count)
+            std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(T));
+    }
+
+    // 以value填充first开始的count个元素
+    // value的各字节相同时（如0、-1、单字节类型）使用memset
+    // 否则大小整除16的类型先拼出16bytes的模式，每次写入64bytes，其余类型逐个赋值
+    template<typename T>
+    inline void fill_contiguous(T* first, size_t count, const T& value)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, std::addressof(value), sizeof(T));
+        bool same = true;
+        for (size_t i = 1; i < sizeof(T); ++i)
+            same = same && bytes[i] == bytes[0];
+        if (same)
+        {
+            if (count)
+                std::memset(static_cast<void*>(first), bytes[0], count * sizeof(T));
+            return;
+        }
+
+        if constexpr (16 % sizeof(T) == 0)
+        {
+            unsigned char pattern[16];
+            for (size_t i = 0; i < 16; i += sizeof(T))
+                std::memcpy(pattern + i, bytes, sizeof(T));
+            unsigned char* p = reinterpret_cast<unsigned char*>(first);
+            const size_t total = count * sizeof(T);
+            size_t i = 0;
+            // 定长的memcpy会被编译为单条宽存储指令
+            for (; i + 64 <= total; i += 64)
+            {
+                std::memcpy(p + i, pattern, 16);
+                std::memcpy(p + i + 16, pattern, 16);
+                std::memcpy(p + i + 32, pattern, 16);
+                std::memcpy(p + i + 48, pattern, 16);
+            }
+            for (; i + 16 <= total; i += 16)
+                std::memcpy(p + i, pattern, 16);
+            if (i != total)
+                std::memcpy(p + i, pattern, total - i);
+        }
+        else
+        {
+            // 复制到局部变量，避免value与区间可能重叠而每次重新读取
+            const T tmp = value;
+            for (size_t i = 0; i < count; ++i)
+                first[i] = tmp;
+        }
+    }
+
+    // 从first开始填充count个元素
+    template<typename OutputIterator, typename Size, typename T>
+    OutputIterator fill_n(OutputIterator first, Size count, const T& value)
+    {
+        if constexpr (is_memset_fillable<OutputIterator>)
+        {
+            if (count <= 0)
+                return first;
+            const typename iterator_traits<OutputIterator>::value_type tmp(value);
+            fill_contiguous(bitstl::to_address(first), static_cast<size_t>(count), tmp);
+            return first + count;
+        }
+        else
+        {
+            for (Size i = 0; i < count; ++i)
+                *first++ = value;
+            return first;
+        }
+    }
+
+    // 从first到last填充元素
+    template<typename ForwardIterator, typename T>
+    void fill(ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        if constexpr (is_memset_fillable<ForwardIterator>)
+        {
+            const typename iterator_traits<ForwardIterator>::value_type tmp(value);
+            fill_contiguous(bitstl::to_address(first), static_cast<size_t>(last - first), tmp);
+        }
+        else
+        {
+            for (; first != last; ++first)
+                *first = value;
+        }
+    }
+
+    // 将first至last的元素复制到以dest_first开始的内存中
+    template<typename InputIterator, typename OutputIterator>
+    OutputIterator copy(InputIterator first, InputIterator last, OutputIterator dest_first)
+    {
+        if constexpr (is_memmove_copyable<InputIterator, OutputIterator, false>)
+        {
+            const auto count = last - first;
+            memmove_n(bitstl::to_address(dest_first), bitstl::to_address(first), static_cast<size_t>(count));
+            return dest_first + count;
+        }
+        else
+        {
+            // (void)用于避免逗号运算符被重载的情况
+            for (; first != last; (void)++first, (void)++dest_first)
+                *dest_first = *first;
+
+            return dest_first;
+        }
+    }
+
+    // 根据条件pred将first至last的元素复制到以dest_first开始的内存中
+    template<typename InputIterator, typename OutputIterator, typename UnaryPredicate>
+    OutputIterator copy_if(InputIterator first, InputIterator last, OutputIterator dest_first, UnaryPredicate pred)
+    {
+        for (; first != last; ++first)
+        {
+            if (pred(*first))
+            {
+                *dest_first = *first;
+                ++dest_first;
+            }
+        }
+        return dest_first;
+    }
+
+    // 将first至last的元素移动到以dest_first开始的内存中
+    template<typename InputIterator, typename OutputIterator>
+    OutputIterator move(InputIterator first, InputIterator last, OutputIterator dest_first)
+    {
+        if constexpr (is_memmove_copyable<InputIterator, OutputIterator, true>)
+        {
+            const auto count = last - first;
+            memmove_n(bitstl::to_address(dest_first), bitstl::to_address(first), static_cast<size_t>(count));
+            return dest_first + count;
+        }
+        else
+        {
+            for (; first != last; (void)++first, (void)++dest_first)
+                *dest_first = bitstl::move(*first);
+
+            return dest_first;
+        }
+    }
+
+    /*
+     * 遍历与变换
+     */
+    // 对first至last的每个元素调用f，返回f
+    template<typename InputIterator, typename UnaryFunction>
+    UnaryFunction for_each(InputIterator first, InputIterator last, UnaryFunction f)
+    {
+        for (; first != last; ++first)
+            f(*first);
+        return f;
+    }
+
+    // 对first开始的count个元素调用f，返回最后一个元素之后的位置
+    template<typename InputIterator, typename Size, typename UnaryFunction>
+    InputIterator for_each_n(InputIterator first, Size count, UnaryFunction f)
+    {
+        for (Size i = 0; i < count; (void)++first, ++i)
+            f(*first);
+        return first;
+    }
+
+    // 将op作用于first至last的每个元素，结果写入以dest_first开始的区间
+    template<typename InputIterator, typename OutputIterator, typename UnaryOperation>
+    OutputIterator transform(InputIterator first, InputIterator last, OutputIterator dest_first, UnaryOperation op)
+    {
+        for (; first != last; (void)++first, (void)++dest_first)
+            *dest_first = op(*first);
+        return dest_first;
+    }
+
+    // 将op作用于两个区间对应的元素，第二个区间至少与第一个一样长
+    template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename BinaryOperation>
+    OutputIterator transform(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+        OutputIterator dest_first, BinaryOperation op)
+    {
+        for (; first1 != last1; (void)++first1, (void)++first2, (void)++dest_first)
+            *dest_first = op(*first1, *first2);
+        return dest_first;
+    }
+
+    /*
+     * 查找与比较
+     * 迭代器为连续迭代器且元素为算术类型时，find、count、mismatch、equal使用simd.h中的向量内核
+     * lexicographical_compare先以mismatch找到首个不同的位置，再比较该位置的元素
+     */
+    // 判断能否以向量内核在InputIterator的元素中查找T类型的值
+    // 整数之间的==经过整型提升和算术转换后与元素类型上的比较一一对应，浮点数要求类型相同
+    template<typename InputIterator, typename T, typename = void>
+    inline constexpr bool is_simd_findable = false;
+
+    template<typename InputIterator, typename T>
+    inline constexpr bool is_simd_findable<InputIterator, T, void_t<iterator_concept_t<InputIterator>>> =
+        is_contiguous_iterator<InputIterator>
+        && simd::is_vectorizable_v<typename iterator_traits<InputIterator>::value_type>
+        && (is_same_v<typename iterator_traits<InputIterator>::value_type, remove_cv_t<T>>
+            || (std::is_integral_v<typename iterator_traits<InputIterator>::value_type> && std::is_integral_v<T>));
+
+    // 判断能否以向量内核逐个比较两个区间的元素
+    template<typename InputIterator1, typename InputIterator2, typename = void>
+    inline constexpr bool is_simd_comparable = false;
+
+    template<typename InputIterator1, typename InputIterator2>
+    inline constexpr bool is_simd_comparable<InputIterator1, InputIterator2,
+        void_t<iterator_concept_t<InputIterator1>, iterator_concept_t<InputIterator2>>> =
+        is_contiguous_iterator<InputIterator1> && is_contiguous_iterator<InputIterator2>
+        && is_same_v<typename iterator_traits<InputIterator1>::value_type, typename iterator_traits<InputIterator2>::value_type>
+        && simd::is_vectorizable_v<typename iterator_traits<InputIterator1>::value_type>;
+
+    // 返回first至last中首个等于value的元素，不存在时返回last
+    template<typename InputIterator, typename T>
+    InputIterator find(InputIterator first, InputIterator last, const T& value)
+    {
+        if constexpr (is_simd_findable<InputIterator, T>)
+        {
+            using value_type = typename iterator_traits<InputIterator>::value_type;
+            // 转换后不再与value相等，说明没有元素能等于value（如在unsigned char中查找300）
+            const value_type target = static_cast<value_type>(value);
+            if (!(target == value))
+                return last;
+            const size_t count = static_cast<size_t>(last - first);
+            return first + simd::find(bitstl::to_address(first), count, target);
+        }
+        else
+        {
+            for (; first != last; ++first)
+                if (*first == value)
+                    return first;
+            return last;
+        }
+    }
+
+    template<typename InputIterator, typename UnaryPredicate>
+    InputIterator find_if(InputIterator first, InputIterator last, UnaryPredicate pred)
+    {
+        for (; first != last; ++first)
+            if (pred(*first))
+                return first;
+        return last;
+    }
+
+    // 返回first至last中等于value的元素个数
+    template<typename InputIterator, typename T>
+    typename iterator_traits<InputIterator>::difference_type
+        count(InputIterator first, InputIterator last, const T& value)
+    {
+        using difference_type = typename iterator_traits<InputIterator>::difference_type;
+        if constexpr (is_simd_findable<InputIterator, T>)
+        {
+            using value_type = typename iterator_traits<InputIterator>::value_type;
+            const value_type target = static_cast<value_type>(value);
+            if (!(target == value))
+                return 0;
+            const size_t count = static_cast<size_t>(last - first);
+            return static_cast<difference_type>(simd::count(bitstl::to_address(first), count, target));
+        }
+        else
+        {
+            difference_type result = 0;
+            for (; first != last; ++first)
+                if (*first == value)
+                    ++result;
+            return result;
+        }
+    }
+
+    template<typename InputIterator, typename UnaryPredicate>
+    typename iterator_traits<InputIterator>::difference_type
+        count_if(InputIterator first, InputIterator last, UnaryPredicate pred)
+    {
+        typename iterator_traits<InputIterator>::difference_type result = 0;
+        for (; first != last; ++first)
+            if (pred(*first))
+                ++result;
+        return result;
+    }
+
+    // 返回first至last中首次出现s_first至s_last的位置，不存在时返回last，子序列为空时返回first
+    template<typename ForwardIterator1, typename ForwardIterator2, typename BinaryPredicate>
+    ForwardIterator1 search(ForwardIterator1 first, ForwardIterator1 last,
+        ForwardIterator2 s_first, ForwardIterator2 s_last, BinaryPredicate pred)
+    {
+        if (s_first == s_last)
+            return first;
+        // 先以find_if定位与子序列首元素匹配的位置，再逐个比较其余元素
+        for (;; ++first)
+        {
+            first = bitstl::find_if(first, last, [&](const auto& x) { return pred(x, *s_first); });
+            if (first == last)
+                return last;
+            ForwardIterator1 it = first;
+            for (ForwardIterator2 s_it = s_first;; ++it, ++s_it)
+            {
+                if (s_it == s_last)
+                    return first;
+                if (it == last)
+                    return last;
+                if (!pred(*it, *s_it))
+                    break;
+            }
+        }
+    }
+
+    template<typename ForwardIterator1, typename ForwardIterator2>
+    ForwardIterator1 search(ForwardIterator1 first, ForwardIterator1 last, ForwardIterator2 s_first, ForwardIterator2 s_last)
+    {
+        return bitstl::search(first, last, s_first, s_last, std::equal_to<>());
+    }
+
+    // 移除满足pred的元素，其余元素保持原顺序移到区间前部，返回新的尾后位置
+    template<typename ForwardIterator, typename UnaryPredicate>
+    ForwardIterator remove_if(ForwardIterator first, ForwardIterator last, UnaryPredicate pred)
+    {
+        first = bitstl::find_if(first, last, pred);
+        if (first != last)
+        {
+            for (ForwardIterator it = first; ++it != last;)
+            {
+                if (!pred(*it))
+                {
+                    *first = bitstl::move(*it);
+                    ++first;
+                }
+            }
+        }
+        return first;
+    }
+
+    // 返回两个区间中首个不相等的元素，第二个区间至少与第一个一样长
+    template<typename InputIterator1, typename InputIterator2>
+    std::pair<InputIterator1, InputIterator2>
+        mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+    {
+        if constexpr (is_simd_comparable<InputIterator1, InputIterator2>)
+        {
+            const auto n = simd::mismatch(bitstl::to_address(first1), bitstl::to_address(first2),
+                static_cast<size_t>(last1 - first1));
+            return { first1 + n, first2 + n };
+        }
+        else
+        {
+            for (; first1 != last1 && *first1 == *first2; (void)++first1, (void)++first2);
+            return { first1, first2 };
+        }
+    }
+
+    template<typename InputIterator1, typename InputIterator2>
+    std::pair<InputIterator1, InputIterator2>
+        mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2)
+    {
+        if constexpr (is_simd_comparable<InputIterator1, InputIterator2>)
+        {
+            const auto len1 = last1 - first1;
+            const auto len2 = last2 - first2;
+            return bitstl::mismatch(first1, len1 < len2 ? last1 : first1 + len2, first2);
+        }
+        else
+        {
+            for (; first1 != last1 && first2 != last2 && *first1 == *first2; (void)++first1, (void)++first2);
+            return { first1, first2 };
+        }
+    }
+
+    template<typename InputIterator1, typename InputIterator2, typename BinaryPredicate>
+    std::pair<InputIterator1, InputIterator2>
+        mismatch(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, BinaryPredicate pred)
+    {
+        for (; first1 != last1 && pred(*first1, *first2); (void)++first1, (void)++first2);
+        return { first1, first2 };
+    }
+
+    // 判断两个区间的元素是否逐个相等，第二个区间至少与第一个一样长
+    template<typename InputIterator1, typename InputIterator2>
+    bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2)
+    {
+        return bitstl::mismatch(first1, last1, first2).first == last1;
+    }
+
+    // 随机访问迭代器先比较长度
+    template<typename InputIterator1, typename InputIterator2>
+    bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2)
+    {
+        if constexpr (is_random_access_iterator<InputIterator1> && is_random_access_iterator<InputIterator2>)
+        {
+            if (last1 - first1 != last2 - first2)
+                return false;
+            return bitstl::mismatch(first1, last1, first2).first == last1;
+        }
+        else
+        {
+            auto result = bitstl::mismatch(first1, last1, first2, last2);
+            return result.first == last1 && result.second == last2;
+        }
+    }
+
+    template<typename InputIterator1, typename InputIterator2, typename BinaryPredicate>
+    bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, BinaryPredicate pred)
+    {
+        return bitstl::mismatch(first1, last1, first2, pred).first == last1;
+    }
+
+    // 按字典序判断第一个区间是否小于第二个区间
+    // 浮点数含NaN时不满足“不相等即有先后”，只对整数类型使用mismatch
+    template<typename InputIterator1, typename InputIterator2>
+    bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2)
+    {
+        if constexpr (is_simd_comparable<InputIterator1, InputIterator2>
+            && std::is_integral_v<typename iterator_traits<InputIterator1>::value_type>)
+        {
+            const auto result = bitstl::mismatch(first1, last1, first2, last2);
+            if (result.second == last2)
+                return false;
+            return result.first == last1 || *result.first < *result.second;
+        }
+        else
+        {
+            for (; first1 != last1 && first2 != last2; (void)++first1, (void)++first2)
+            {
+                if (*first1 < *first2)
+                    return true;
+                if (*first2 < *first1)
+                    return false;
+            }
+            return first1 == last1 && first2 != last2;
+        }
+    }
+
+    template<typename InputIterator1, typename InputIterator2, typename Compare>
+    bool lexicographical_compare(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2, Compare comp)
+    {
+        for (; first1 != last1 && first2 != last2; (void)++first1, (void)++first2)
+        {
+            if (comp(*first1, *first2))
+                return true;
+            if (comp(*first2, *first1))
+                return false;
+        }
+        return first1 == last1 && first2 != last2;
+    }
+
+    /*
+     * 二分查找
+     */
+    // 返回有序区间中首个不小于value的元素
+    template<typename ForwardIterator, typename T, typename Compare>
+    ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T& value, Compare comp)
+    {
+        auto len = bitstl::distance(first, last);
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            ForwardIterator mid = first;
+            bitstl::advance(mid, half);
+            if (comp(*mid, value))
+            {
+                first = ++mid;
+                len -= half + 1;
+            }
+            else
+                len = half;
+        }
+        return first;
+    }
+
+    template<typename ForwardIterator, typename T>
+    ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        return bitstl::lower_bound(first, last, value, std::less<>());
+    }
+
+    // 返回有序区间中首个大于value的元素
+    template<typename ForwardIterator, typename T, typename Compare>
+    ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last, const T& value, Compare comp)
+    {
+        auto len = bitstl::distance(first, last);
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            ForwardIterator mid = first;
+            bitstl::advance(mid, half);
+            if (!comp(value, *mid))
+            {
+                first = ++mid;
+                len -= half + 1;
+            }
+            else
+                len = half;
+        }
+        return first;
+    }
+
+    template<typename ForwardIterator, typename T>
+    ForwardIterator upper_bound(ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        return bitstl::upper_bound(first, last, value, std::less<>());
+    }
+
+    /*
+     * 归并
+     */
+    // 将两个有序区间归并至d_first开始的区间，稳定：相等的元素中来自第一个区间的在前
+    template<typename InputIterator1, typename InputIterator2, typename OutputIterator, typename Compare>
+    OutputIterator merge(InputIterator1 first1, InputIterator1 last1,
+        InputIterator2 first2, InputIterator2 last2, OutputIterator d_first, Compare comp)
+    {
+        for (; first1 != last1 && first2 != last2; ++d_first)
+        {
+            if (comp(*first2, *first1))
+            {
+                *d_first = *first2;
+                ++first2;
+            }
+            else
+            {
+                *d_first = *first1;
+                ++first1;
+            }
+        }
+        d_first = bitstl::copy(first1, last1, d_first);
+        return bitstl::copy(first2, last2, d_first);
+    }
+
+    template<typename InputIterator1, typename InputIterator2, typename OutputIterator>
+    OutputIterator merge(InputIterator1 first1, InputIterator1 last1,
+        InputIterator2 first2, InputIterator2 last2, OutputIterator d_first)
+    {
+        return bitstl::merge(first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    /*
+     * 排序
+     * 参考JDK的Arrays.sort()（见README第11条）：
+     * sort为双轴快排，区间长度小于47时使用插入排序，递归过深时退化为堆排序，
+     * 长度达到286且由少于67个单调块组成时改用归并单调块的类TimSort
+     * stable_sort为类TimSort：识别单调块，过短的块以二分插入排序补足minrun，按栈上的长度不变式归并
+     */
+    namespace sort_detail
+    {
+        constexpr ptrdiff_t insertion_sort_threshold = 47;
+        constexpr ptrdiff_t run_check_threshold      = 286;
+        constexpr ptrdiff_t max_run_count            = 67;
+        constexpr ptrdiff_t min_merge                = 32;
+
+        template<typename RandomIterator>
+        void iter_swap(RandomIterator a, RandomIterator b)
+        {
+            bitstl::swap(*a, *b);
+        }
+
+        template<typename BidirectionalIterator>
+        void reverse(BidirectionalIterator first, BidirectionalIterator last)
+        {
+            while (first != last && first != --last)
+                sort_detail::iter_swap(first++, last);
+        }
+
+        // 将last之前的元素插入到已排序的[first, last)中，要求插入位置之前存在不大于它的元素
+        template<typename RandomIterator, typename Compare>
+        void unguarded_linear_insert(RandomIterator last, Compare& comp)
+        {
+            auto value = bitstl::move(*last);
+            RandomIterator next = last - 1;
+            while (comp(value, *next))
+            {
+                *last = bitstl::move(*next);
+                last = next--;
+            }
+            *last = bitstl::move(value);
+        }
+
+        // 小于首元素的元素整体后移，其余元素的插入无需检查边界
+        template<typename RandomIterator, typename Compare>
+        void insertion_sort(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            if (first == last)
+                return;
+            for (RandomIterator i = first + 1; i != last; ++i)
+            {
+                if (comp(*i, *first))
+                {
+                    auto value = bitstl::move(*i);
+                    for (RandomIterator j = i; j != first; --j)
+                        *j = bitstl::move(*(j - 1));
+                    *first = bitstl::move(value);
+                }
+                else
+                    sort_detail::unguarded_linear_insert(i, comp);
+            }
+        }
+
+        // first之前的元素不大于区间内的所有元素（快排中非最左侧的部分）
+        template<typename RandomIterator, typename Compare>
+        void unguarded_insertion_sort(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            for (RandomIterator i = first; i != last; ++i)
+                sort_detail::unguarded_linear_insert(i, comp);
+        }
+
+        // 将value放入以hole为空位、长度为len的堆中，先下沉到叶子再上浮
+        template<typename RandomIterator, typename Distance, typename T, typename Compare>
+        void adjust_heap(RandomIterator first, Distance hole, Distance len, T value, Compare& comp)
+        {
+            const Distance top = hole;
+            Distance child = hole;
+            while (child < (len - 1) / 2)
+            {
+                child = 2 * (child + 1);
+                if (comp(*(first + child), *(first + (child - 1))))
+                    --child;
+                *(first + hole) = bitstl::move(*(first + child));
+                hole = child;
+            }
+            if ((len & 1) == 0 && child == (len - 2) / 2)
+            {
+                child = 2 * (child + 1);
+                *(first + hole) = bitstl::move(*(first + (child - 1)));
+                hole = child - 1;
+            }
+            Distance parent = (hole - 1) / 2;
+            while (hole > top && comp(*(first + parent), value))
+            {
+                *(first + hole) = bitstl::move(*(first + parent));
+                hole = parent;
+                parent = (hole - 1) / 2;
+            }
+            *(first + hole) = bitstl::move(value);
+        }
+
+        template<typename RandomIterator, typename Compare>
+        void heap_sort(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            using difference_type = typename iterator_traits<RandomIterator>::difference_type;
+            const difference_type len = last - first;
+            if (len < 2)
+                return;
+            for (difference_type parent = (len - 2) / 2; ; --parent)
+            {
+                auto value = bitstl::move(*(first + parent));
+                sort_detail::adjust_heap(first, parent, len, bitstl::move(value), comp);
+                if (parent == 0)
+                    break;
+            }
+            for (difference_type n = len - 1; n > 0; --n)
+            {
+                auto value = bitstl::move(*(first + n));
+                *(first + n) = bitstl::move(*first);
+                sort_detail::adjust_heap(first, difference_type(0), n, bitstl::move(value), comp);
+            }
+        }
+
+        // 返回*a、*b、*c中的中位数
+        template<typename RandomIterator, typename Compare>
+        RandomIterator median_of_three(RandomIterator a, RandomIterator b, RandomIterator c, Compare& comp)
+        {
+            if (comp(*a, *b))
+                return comp(*b, *c) ? b : (comp(*a, *c) ? c : a);
+            return comp(*a, *c) ? a : (comp(*b, *c) ? c : b);
+        }
+
+        // 以*first为轴的三路划分，返回等于轴的区间[lo, hi)，[first, lo)小于轴，[hi, last)大于轴，要求last - first >= 2
+        template<typename RandomIterator, typename Compare>
+        std::pair<RandomIterator, RandomIterator> partition_three_way(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            const auto& pivot = *first;
+
+            // [first + 1, less)小于轴，[less, k)等于轴，(great, last)大于轴
+            RandomIterator less = first + 1;
+            RandomIterator great = last - 1;
+            for (RandomIterator k = less; k <= great; ++k)
+            {
+                if (comp(*k, pivot))
+                {
+                    if (k != less)
+                        sort_detail::iter_swap(k, less);
+                    ++less;
+                }
+                else if (comp(pivot, *k))
+                {
+                    bool exhausted = false;
+                    while (comp(pivot, *great))
+                    {
+                        if (great-- == k)
+                        {
+                            exhausted = true;
+                            break;
+                        }
+                    }
+                    if (exhausted)
+                        break;
+                    if (comp(*great, pivot))
+                    {
+                        auto value = bitstl::move(*k);
+                        if (k != less)
+                            *k = bitstl::move(*less);
+                        *less = bitstl::move(*great);
+                        *great = bitstl::move(value);
+                        ++less;
+                    }
+                    else
+                        sort_detail::iter_swap(k, great);
+                    --great;
+                }
+            }
+
+            // 轴归位后[less - 1, great]均等于轴
+            sort_detail::iter_swap(first, less - 1);
+            return { less - 1, great + 1 };
+        }
+
+        /*
+         * 双轴快排
+         * 在间隔约为长度1/7的五个位置取样并排序，第二、四个样本作为轴p1、p2，将区间分为<p1、[p1, p2]、>p2三部分
+         * 样本中有相等元素时认为重复元素较多，以第三个样本为轴进行三路划分
+         * 中间部分超过长度的4/7时，先将其中等于p1、p2的元素移至两端，只对严格位于两轴之间的元素递归
+         * leftmost为false时first之前的元素不大于区间内的所有元素，插入排序可省去边界检查
+         * depth_limit耗尽时改用堆排序，保证最坏O(nlogn)
+         */
+        template<typename RandomIterator, typename Compare>
+        void quick_sort(RandomIterator first, RandomIterator last, int depth_limit, bool leftmost, Compare& comp)
+        {
+            using difference_type = typename iterator_traits<RandomIterator>::difference_type;
+            const difference_type len = last - first;
+            if (len < insertion_sort_threshold)
+            {
+                if (leftmost)
+                    sort_detail::insertion_sort(first, last, comp);
+                else
+                    sort_detail::unguarded_insertion_sort(first, last, comp);
+                return;
+            }
+            if (depth_limit == 0)
+            {
+                sort_detail::heap_sort(first, last, comp);
+                return;
+            }
+            --depth_limit;
+
+            // 约为len / 7
+            const difference_type seventh = (len >> 3) + (len >> 6) + 1;
+            const RandomIterator e3 = first + len / 2;
+            const RandomIterator e2 = e3 - seventh;
+            const RandomIterator e1 = e2 - seventh;
+            const RandomIterator e4 = e3 + seventh;
+            const RandomIterator e5 = e4 + seventh;
+
+            // 五个样本的插入排序
+            RandomIterator samples[5] = { e1, e2, e3, e4, e5 };
+            for (int i = 1; i < 5; ++i)
+                for (int j = i; j > 0 && comp(*samples[j], *samples[j - 1]); --j)
+                    sort_detail::iter_swap(samples[j], samples[j - 1]);
+
+            const bool distinct = comp(*e1, *e2) && comp(*e2, *e3) && comp(*e3, *e4) && comp(*e4, *e5);
+            if (distinct)
+            {
+                // 两轴暂存于首尾，划分过程不会访问
+                sort_detail::iter_swap(first, e2);
+                sort_detail::iter_swap(last - 1, e4);
+                const auto& p1 = *first;
+                const auto& p2 = *(last - 1);
+
+                RandomIterator less = first + 1;  // [first + 1, less)小于p1
+                RandomIterator great = last - 2;  // (great, last - 1)大于p2
+                while (comp(*less, p1))
+                    ++less;
+                while (comp(p2, *great))
+                    --great;
+
+                // [less, k)位于两轴之间，[k, great]尚未划分
+                for (RandomIterator k = less; k <= great; ++k)
+                {
+                    if (comp(*k, p1))
+                    {
+                        if (k != less)
+                            sort_detail::iter_swap(k, less);
+                        ++less;
+                    }
+                    else if (comp(p2, *k))
+                    {
+                        bool exhausted = false;
+                        while (comp(p2, *great))
+                        {
+                            if (great-- == k)
+                            {
+                                exhausted = true;
+                                break;
+                            }
+                        }
+                        if (exhausted)
+                            break;
+                        if (comp(*great, p1))
+                        {
+                            // *k -> great，*great -> less，*less -> k
+                            auto value = bitstl::move(*k);
+                            if (k != less)
+                                *k = bitstl::move(*less);
+                            *less = bitstl::move(*great);
+                            *great = bitstl::move(value);
+                            ++less;
+                        }
+                        else
+                            sort_detail::iter_swap(k, great);
+                        --great;
+                    }
+                }
+
+                // 两轴归位
+                sort_detail::iter_swap(first, less - 1);
+                sort_detail::iter_swap(last - 1, great + 1);
+                const RandomIterator pivot1 = less - 1;
+                const RandomIterator pivot2 = great + 1;
+
+                sort_detail::quick_sort(first, pivot1, depth_limit, leftmost, comp);
+                sort_detail::quick_sort(pivot2 + 1, last, depth_limit, false, comp);
+
+                if (less < e1 && e5 < great)
+                {
+                    // 中间部分的元素x满足p1 <= x <= p2，x等于p1即!comp(p1, x)，等于p2即!comp(x, p2)
+                    while (less <= great && !comp(*pivot1, *less))
+                        ++less;
+                    while (less <= great && !comp(*great, *pivot2))
+                        --great;
+                    for (RandomIterator k = less; k <= great; ++k)
+                    {
+                        if (!comp(*pivot1, *k))
+                        {
+                            if (k != less)
+                                sort_detail::iter_swap(k, less);
+                            ++less;
+                        }
+                        else if (!comp(*k, *pivot2))
+                        {
+                            bool exhausted = false;
+                            while (!comp(*great, *pivot2))
+                            {
+                                if (great-- == k)
+                                {
+                                    exhausted = true;
+                                    break;
+                                }
+                            }
+                            if (exhausted)
+                                break;
+                            if (!comp(*pivot1, *great))
+                            {
+                                auto value = bitstl::move(*k);
+                                if (k != less)
+                                    *k = bitstl::move(*less);
+                                *less = bitstl::move(*great);
+                                *great = bitstl::move(value);
+                                ++less;
+                            }
+                            else
+                                sort_detail::iter_swap(k, great);
+                            --great;
+                        }
+                    }
+                }
+                sort_detail::quick_sort(less, great + 1, depth_limit, false, comp);
+            }
+            else
+            {
+                // 以e3为轴的三路划分
+                sort_detail::iter_swap(first, e3);
+                const auto equal_range = sort_detail::partition_three_way(first, last, comp);
+                sort_detail::quick_sort(first, equal_range.first, depth_limit, leftmost, comp);
+                sort_detail::quick_sort(equal_range.second, last, depth_limit, false, comp);
+            }
+        }
+
+        // 2 * floor(log2(len))
+        template<typename Distance>
+        int depth_limit(Distance len)
+        {
+            int depth = 0;
+            for (; len > 1; len >>= 1)
+                depth += 2;
+            return depth;
+        }
+
+        /*
+         * TimSort
+         */
+        // 返回从first开始的单调块的结尾，严格递减的块被翻转为递增（非严格递减的翻转会破坏稳定性）
+        template<typename RandomIterator, typename Compare>
+        RandomIterator count_run_and_make_ascending(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            RandomIterator run_end = first + 1;
+            if (run_end == last)
+                return last;
+            if (comp(*run_end++, *first))
+            {
+                while (run_end != last && comp(*run_end, *(run_end - 1)))
+                    ++run_end;
+                sort_detail::reverse(first, run_end);
+            }
+            else
+            {
+                while (run_end != last && !comp(*run_end, *(run_end - 1)))
+                    ++run_end;
+            }
+            return run_end;
+        }
+
+        // 判断区间是否由少于max_run_count个单调块组成，只读不写
+        template<typename RandomIterator, typename Compare>
+        bool is_highly_structured(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            ptrdiff_t count = 0;
+            for (RandomIterator run = first; run != last; )
+            {
+                if (++count >= max_run_count)
+                    return false;
+                RandomIterator run_end = run + 1;
+                if (run_end == last)
+                    break;
+                if (comp(*run_end++, *run))
+                {
+                    while (run_end != last && comp(*run_end, *(run_end - 1)))
+                        ++run_end;
+                }
+                else
+                {
+                    while (run_end != last && !comp(*run_end, *(run_end - 1)))
+                        ++run_end;
+                }
+                run = run_end;
+            }
+            return true;
+        }
+
+        // [first, start)已排序，以二分查找将[start, last)逐个插入，相等元素插入到已有元素之后以保持稳定
+        template<typename RandomIterator, typename Compare>
+        void binary_insertion_sort(RandomIterator first, RandomIterator start, RandomIterator last, Compare& comp)
+        {
+            for (; start != last; ++start)
+            {
+                RandomIterator pos = bitstl::upper_bound(first, start, *start, comp);
+                if (pos == start)
+                    continue;
+                auto value = bitstl::move(*start);
+                for (RandomIterator j = start; j != pos; --j)
+                    *j = bitstl::move(*(j - 1));
+                *pos = bitstl::move(value);
+            }
+        }
+
+        // 长度不小于min_merge时返回[min_merge / 2, min_merge]内的值，使len / minrun接近且不超过2的幂
+        template<typename Distance>
+        Distance min_run_length(Distance len)
+        {
+            Distance r = 0;
+            while (len >= min_merge)
+            {
+                r |= len & 1;
+                len >>= 1;
+            }
+            return len + r;
+        }
+
+        // 归并用的未初始化缓冲区，每次归并时移动构造元素，归并完成后析构
+        template<typename T>
+        class merge_buffer
+        {
+        public:
+            explicit merge_buffer(size_t max_size) noexcept : max_size_(max_size) {}
+
+            merge_buffer(const merge_buffer&) = delete;
+            merge_buffer& operator=(const merge_buffer&) = delete;
+
+            ~merge_buffer()
+            {
+                if (data_)
+                    allocator<T>().deallocate(data_, capacity_);
+            }
+
+            // 容量按两倍增长，不超过max_size
+            T* reserve(size_t n)
+            {
+                if (n > capacity_)
+                {
+                    size_t new_capacity = capacity_ ? capacity_ * 2 : size_t(256);
+                    if (new_capacity < n)
+                        new_capacity = n;
+                    if (new_capacity > max_size_)
+                        new_capacity = max_size_ > n ? max_size_ : n;
+                    T* new_data = allocator<T>().allocate(new_capacity);
+                    if (data_)
+                        allocator<T>().deallocate(data_, capacity_);
+                    data_ = new_data;
+                    capacity_ = new_capacity;
+                }
+                return data_;
+            }
+
+        private:
+            T*     data_     = nullptr;
+            size_t capacity_ = 0;
+            size_t max_size_;
+        };
+
+        // 析构缓冲区中已构造的元素，比较函数抛出异常时同样生效
+        template<typename T>
+        struct constructed_guard
+        {
+            T*     first;
+            size_t count;
+
+            ~constructed_guard()
+            {
+                if constexpr (!std::is_trivially_destructible_v<T>)
+                    for (size_t i = 0; i < count; ++i)
+                        (first + i)->~T();
+            }
+        };
+
+        // 将[first, mid)移入缓冲区，从前向后归并，len1 <= len2
+        template<typename RandomIterator, typename T, typename Compare>
+        void merge_lo(RandomIterator first, RandomIterator mid, RandomIterator last, T* buffer, Compare& comp)
+        {
+            constructed_guard<T> guard{ buffer, 0 };
+            for (RandomIterator i = first; i != mid; ++i, ++guard.count)
+                ::new (static_cast<void*>(buffer + guard.count)) T(bitstl::move(*i));
+
+            T* cursor1 = buffer;
+            T* const last1 = buffer + guard.count;
+            RandomIterator cursor2 = mid;
+            RandomIterator dest = first;
+            while (cursor1 != last1 && cursor2 != last)
+            {
+                if (comp(*cursor2, *cursor1))
+                    *dest++ = bitstl::move(*cursor2++);
+                else
+                    *dest++ = bitstl::move(*cursor1++);
+            }
+            for (; cursor1 != last1; ++cursor1, ++dest)
+                *dest = bitstl::move(*cursor1);
+        }
+
+        // 将[mid, last)移入缓冲区，从后向前归并，len1 > len2
+        template<typename RandomIterator, typename T, typename Compare>
+        void merge_hi(RandomIterator first, RandomIterator mid, RandomIterator last, T* buffer, Compare& comp)
+        {
+            constructed_guard<T> guard{ buffer, 0 };
+            for (RandomIterator i = mid; i != last; ++i, ++guard.count)
+                ::new (static_cast<void*>(buffer + guard.count)) T(bitstl::move(*i));
+
+            RandomIterator cursor1 = mid;
+            T* cursor2 = buffer + guard.count;
+            RandomIterator dest = last;
+            while (cursor1 != first && cursor2 != buffer)
+            {
+                if (comp(*(cursor2 - 1), *(cursor1 - 1)))
+                    *--dest = bitstl::move(*--cursor1);
+                else
+                    *--dest = bitstl::move(*--cursor2);
+            }
+            while (cursor2 != buffer)
+                *--dest = bitstl::move(*--cursor2);
+        }
+
+        // 归并相邻的两个有序块，先以二分查找去掉已在最终位置的前缀与后缀，再以较短的一侧作为缓冲
+        template<typename RandomIterator, typename Compare>
+        void merge_runs(RandomIterator first, RandomIterator mid, RandomIterator last,
+            merge_buffer<typename iterator_traits<RandomIterator>::value_type>& buffer, Compare& comp)
+        {
+            first = bitstl::upper_bound(first, mid, *mid, comp);
+            if (first == mid)
+                return;
+            last = bitstl::lower_bound(mid, last, *(mid - 1), comp);
+            if (mid == last)
+                return;
+            const auto len1 = mid - first;
+            const auto len2 = last - mid;
+            if (len1 <= len2)
+                sort_detail::merge_lo(first, mid, last, buffer.reserve(static_cast<size_t>(len1)), comp);
+            else
+                sort_detail::merge_hi(first, mid, last, buffer.reserve(static_cast<size_t>(len2)), comp);
+        }
+
+        template<typename RandomIterator, typename Compare>
+        void tim_sort(RandomIterator first, RandomIterator last, Compare& comp)
+        {
+            using difference_type = typename iterator_traits<RandomIterator>::difference_type;
+            using value_type      = typename iterator_traits<RandomIterator>::value_type;
+
+            difference_type remaining = last - first;
+            if (remaining < 2)
+                return;
+            if (remaining < min_merge)
+            {
+                RandomIterator run_end = sort_detail::count_run_and_make_ascending(first, last, comp);
+                sort_detail::binary_insertion_sort(first, run_end, last, comp);
+                return;
+            }
+
+            merge_buffer<value_type> buffer(static_cast<size_t>(remaining / 2));
+            const difference_type min_run = sort_detail::min_run_length(remaining);
+
+            // 待归并的块，长度满足run_len[i - 2] > run_len[i - 1] + run_len[i]且run_len[i - 1] > run_len[i]，
+            // 因此栈深不超过log(φ, n)，85足够容纳2^64个元素
+            RandomIterator run_base[85];
+            difference_type run_len[85];
+            int stack_size = 0;
+
+            auto merge_at = [&](int i)
+            {
+                sort_detail::merge_runs(run_base[i], run_base[i + 1], run_base[i + 1] + run_len[i + 1], buffer, comp);
+                run_len[i] += run_len[i + 1];
+                if (i == stack_size - 3)
+                {
+                    run_base[i + 1] = run_base[i + 2];
+                    run_len[i + 1] = run_len[i + 2];
+                }
+                --stack_size;
+            };
+
+            RandomIterator lo = first;
+            do
+            {
+                RandomIterator run_end = sort_detail::count_run_and_make_ascending(lo, last, comp);
+                difference_type run = run_end - lo;
+                if (run < min_run)
+                {
+                    const difference_type force = remaining <= min_run ? remaining : min_run;
+                    sort_detail::binary_insertion_sort(lo, run_end, lo + force, comp);
+                    run = force;
+                }
+
+                run_base[stack_size] = lo;
+                run_len[stack_size] = run;
+                ++stack_size;
+
+                // 恢复栈的长度不变式（包含对原始TimSort不变式缺陷的修正）
+                while (stack_size > 1)
+                {
+                    int n = stack_size - 2;
+                    if ((n > 0 && run_len[n - 1] <= run_len[n] + run_len[n + 1])
+                        || (n > 1 && run_len[n - 2] <= run_len[n] + run_len[n - 1]))
+                    {
+                        if (run_len[n - 1] < run_len[n + 1])
+                            --n;
+                    }
+                    else if (run_len[n] > run_len[n + 1])
+                        break;
+                    merge_at(n);
+                }
+
+                lo += run;
+                remaining -= run;
+            } while (remaining != 0);
+
+            while (stack_size > 1)
+            {
+                int n = stack_size - 2;
+                if (n > 0 && run_len[n - 1] < run_len[n + 1])
+                    --n;
+                merge_at(n);
+            }
+        }
+    }
+
+    // 不稳定排序，平均及最坏O(nlogn)
+    template<typename RandomIterator, typename Compare>
+    void sort(RandomIterator first, RandomIterator last, Compare comp)
+    {
+        const auto len = last - first;
+        if (len < 2)
+            return;
+        // 基本有序的数组归并单调块更快
+        if (len >= sort_detail::run_check_threshold && sort_detail::is_highly_structured(first, last, comp))
+        {
+            sort_detail::tim_sort(first, last, comp);
+            return;
+        }
+        sort_detail::quick_sort(first, last, sort_detail::depth_limit(len), true, comp);
+    }
+
+    template<typename RandomIterator>
+    void sort(RandomIterator first, RandomIterator last)
+    {
+        bitstl::sort(first, last, std::less<>());
+    }
+
+    // 稳定排序，O(nlogn)，需要至多n / 2个元素的额外空间
+    template<typename RandomIterator, typename Compare>
+    void stable_sort(RandomIterator first, RandomIterator last, Compare comp)
+    {
+        sort_detail::tim_sort(first, last, comp);
+    }
+
+    template<typename RandomIterator>
+    void stable_sort(RandomIterator first, RandomIterator last)
+    {
+        bitstl::stable_sort(first, last, std::less<>());
+    }
+}
+
+#endif // !ALGORITHM_H
@@ -1,88 +1,181 @@
-/*
- * 内存分配器萃取接口
- */
-#ifndef ALLOCATOR_TRAITS_H
-#define ALLOCATOR_TRAITS_H
-
-#include "memory.h"
-
-namespace bitstl
-{
-    template<typename Alloc>
-    struct allocator_traits
-    {
-    public:
-        using allocator_type  = Alloc;
-        // allocator类定义的类型
-        using value_type      = typename Alloc::value_type;
-        using size_type       = typename Alloc::size_type;
-        using difference_type = typename Alloc::difference_type;
-        using propagate_on_container_move_assignment = typename Alloc::propagate_on_container_move_assignment;
-        using is_always_equal                        = type_identity_t<typename Alloc::is_always_equal>;
-        // allocator类未定义的类型
-        using pointer            = value_type*;
-        using const_pointer      = const value_type*;
-        using void_pointer       = void*;
-        using const_void_pointer = const void*;
-        using propagate_on_container_copy_assignment = false_type;
-        using propagate_on_container_swap            = false_type;
-
-    private:
-        template<typename A, typename T>
-        struct rebind : replace_first_arg<A, T>
-        {
-            static_assert(
-                is_same<
-                typename replace_first_arg<A, typename A::value_type>::type, 
-                A>(),
-                "allocator_traits<A>::rebind_alloc<A::value_type> must be A");
-        };
-
-    public:
-        // 重绑定分配器到另一类型T
-        template<typename T>
-        using rebind_alloc  = typename rebind<Alloc, T>::type;
-        template<typename T>
-        using rebind_traits = allocator_traits<rebind_alloc<T>>;
-
-        [[nodiscard]]
-        static constexpr pointer allocate(Alloc& a, size_type n)
-        {
-            return a.allocate(n);
-        }
-
-        static constexpr void deallocate(Alloc& a, pointer p, size_type n)
-        {
-            a.deallocate(p, n);
-        }
-
-        // alloactor类的construct函数自C++20废弃
-        template<typename T, typename... Args>
-        static constexpr void construct(Alloc& a, T* p, Args&&... args)
-        {
-            construct_at(p, std::forward<Args>(args)...);
-        }
-
-        // alloactor类的destroy函数自C++20废弃
-        template<typename T>
-        static constexpr void destroy(Alloc& a, T* p)
-        {
-            destroy_at(p);
-        }
-
-        // alloactor类的max_size函数自C++20废弃
-        static constexpr size_type max_size(const Alloc& a)
-            noexcept
-        {
-            return std::numeric_limits<size_type>::max() / sizeof(value_type);
-        }
-
-        static constexpr Alloc select_on_container_copy_construction(const Alloc& a)
-        {
-            return a;
-        }
-    };
-}
-
-#endif // !ALLOCATOR_TRAITS_H
-
+/*
+ * 内存分配器萃取接口
+ */
+#ifndef ALLOCATOR_TRAITS_H
+#define ALLOCATOR_TRAITS_H
+
+#include "memory.h"
+
+namespace bitstl
+{
+    /*
+     * 检查Alloc是否定义了某成员类型，未定义时使用Default
+     */
+#define BITSTL_ALLOC_MEMBER_OR(NAME)                                          \
+    template<typename Alloc, typename Default, typename = void>               \
+    struct alloc_##NAME##_or { using type = Default; };                       \
+    template<typename Alloc, typename Default>                                \
+    struct alloc_##NAME##_or<Alloc, Default, void_t<typename Alloc::NAME>>    \
+    { using type = typename Alloc::NAME; }
+
+    BITSTL_ALLOC_MEMBER_OR(size_type);
+    BITSTL_ALLOC_MEMBER_OR(difference_type);
+    BITSTL_ALLOC_MEMBER_OR(propagate_on_container_copy_assignment);
+    BITSTL_ALLOC_MEMBER_OR(propagate_on_container_move_assignment);
+    BITSTL_ALLOC_MEMBER_OR(propagate_on_container_swap);
+    BITSTL_ALLOC_MEMBER_OR(is_always_equal);
+
+#undef BITSTL_ALLOC_MEMBER_OR
+
+    // 检查Alloc是否定义了select_on_container_copy_construction成员函数
+    template<typename Alloc, typename = void>
+    struct has_select_on_copy : false_type {};
+
+    template<typename Alloc>
+    struct has_select_on_copy<Alloc,
+        void_t<decltype(std::declval<const Alloc&>().select_on_container_copy_construction())>>
+        : true_type {};
+
+    // 检查Alloc是否定义了allocate_at_least成员函数
+    template<typename Alloc, typename = void>
+    struct has_allocate_at_least : false_type {};
+
+    template<typename Alloc>
+    struct has_allocate_at_least<Alloc,
+        void_t<decltype(std::declval<Alloc&>().allocate_at_least(size_t()))>>
+        : true_type {};
+
+    // 检查Alloc是否定义了try_expand成员函数
+    template<typename Alloc, typename = void>
+    struct has_try_expand : false_type {};
+
+    template<typename Alloc>
+    struct has_try_expand<Alloc,
+        void_t<decltype(std::declval<Alloc&>().try_expand(
+            std::declval<typename Alloc::value_type*>(), size_t(), size_t()))>>
+        : true_type {};
+
+    // allocate_at_least的返回值，count为实际分配的对象个数，释放时须使用count
+    template<typename Pointer, typename SizeType = size_t>
+    struct allocation_result
+    {
+        Pointer  ptr;
+        SizeType count;
+    };
+
+    template<typename Alloc>
+    struct allocator_traits
+    {
+    public:
+        using allocator_type  = Alloc;
+        // allocator类定义的类型，未定义时使用默认值
+        using value_type      = typename Alloc::value_type;
+        using size_type       = typename alloc_size_type_or<Alloc, size_t>::type;
+        using difference_type = typename alloc_difference_type_or<Alloc, ptrdiff_t>::type;
+        using propagate_on_container_copy_assignment = typename alloc_propagate_on_container_copy_assignment_or<Alloc, false_type>::type;
+        using propagate_on_container_move_assignment = typename alloc_propagate_on_container_move_assignment_or<Alloc, false_type>::type;
+        using propagate_on_container_swap            = typename alloc_propagate_on_container_swap_or<Alloc, false_type>::type;
+        // 无状态的分配器总是相等
+        using is_always_equal = typename alloc_is_always_equal_or<Alloc,
+            integral_constant<bool, std::is_empty_v<Alloc>>>::type;
+        // allocator类未定义的类型
+        using pointer            = value_type*;
+        using const_pointer      = const value_type*;
+        using void_pointer       = void*;
+        using const_void_pointer = const void*;
+
+    private:
+        // Alloc定义了rebind<T>::other时优先使用，否则替换Alloc的第一个模板参数
+        // 适配器类分配器（如tracking_allocator<Alloc>）的第一个模板参数不是value_type，必须定义rebind
+        template<typename A, typename T, typename = void>
+        struct rebind : replace_first_arg<A, T>
+        {
+            static_assert(
+                is_same<
+                typename replace_first_arg<A, typename A::value_type>::type, 
+                A>(),
+                "allocator_traits<A>::rebind_alloc<A::value_type> must be A");
+        };
+
+        template<typename A, typename T>
+        struct rebind<A, T, void_t<typename A::template rebind<T>::other>>
+        {
+            using type = typename A::template rebind<T>::other;
+        };
+
+    public:
+        // 重绑定分配器到另一类型T
+        template<typename T>
+        using rebind_alloc  = typename rebind<Alloc, T>::type;
+        template<typename T>
+        using rebind_traits = allocator_traits<rebind_alloc<T>>;
+
+        [[nodiscard]]
+        static constexpr pointer allocate(Alloc& a, size_type n)
+        {
+            return a.allocate(n);
+        }
+
+        static constexpr void deallocate(Alloc& a, pointer p, size_type n)
+        {
+            a.deallocate(p, n);
+        }
+
+        // C++23，分配至少n个对象的空间，返回实际可用的个数
+        // Alloc未定义该函数时等同于allocate(a, n)
+        [[nodiscard]]
+        static constexpr allocation_result<pointer, size_type> allocate_at_least(Alloc& a, size_type n)
+        {
+            if constexpr (has_allocate_at_least<Alloc>::value)
+            {
+                auto result = a.allocate_at_least(n);
+                return { result.ptr, static_cast<size_type>(result.count) };
+            }
+            else
+                return { a.allocate(n), n };
+        }
+
+        // 尝试原地将p处old_n个对象的空间扩展至new_n个，成功后须以new_n释放
+        // 失败时不做任何改动，Alloc未定义该函数时总是失败
+        static constexpr bool try_expand(Alloc& a, pointer p, size_type old_n, size_type new_n)
+        {
+            if constexpr (has_try_expand<Alloc>::value)
+                return a.try_expand(p, old_n, new_n);
+            else
+                return false;
+        }
+
+        // alloactor类的construct函数自C++20废弃
+        template<typename T, typename... Args>
+        static constexpr void construct(Alloc& a, T* p, Args&&... args)
+        {
+            bitstl::construct_at(p, std::forward<Args>(args)...);
+        }
+
+        // alloactor类的destroy函数自C++20废弃
+        template<typename T>
+        static constexpr void destroy(Alloc& a, T* p)
+        {
+            bitstl::destroy_at(p);
+        }
+
+        // alloactor类的max_size函数自C++20废弃
+        static constexpr size_type max_size(const Alloc& a)
+            noexcept
+        {
+            return std::numeric_limits<size_type>::max() / sizeof(value_type);
+        }
+
+        // 容器拷贝构造时获得的分配器，Alloc未定义该函数时复制a
+        static constexpr Alloc select_on_container_copy_construction(const Alloc& a)
+        {
+            if constexpr (has_select_on_copy<Alloc>::value)
+                return a.select_on_container_copy_construction();
+            else
+                return a;
+        }
+    };
+}
+
+#endif // !ALLOCATOR_TRAITS_H
+
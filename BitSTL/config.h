@@ -1,19 +1,30 @@
-/*
- * 基本设置  
- */
-#ifndef CONFIG_H
-#define CONFIG_H
-
-// https://devblogs.microsoft.com/oldnewthing/20220408-00/?p=106438
-// 用于两层noexcept嵌套，内层的是noexcept操作符，外层是noexcept说明符
-// noexcept(noexcept(...))
-#define NOEXCEPT_IF(...) noexcept(__VA_ARGS__)
-
-namespace bitstl
-{
-    using size_t    = unsigned long long int;
-    using ptrdiff_t = long long int;
-}
-
-#endif // !CONFIG_H
-
+/*
+ * 基本设置  
+ */
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// https://devblogs.microsoft.com/oldnewthing/20220408-00/?p=106438
+// 用于两层noexcept嵌套，内层的是noexcept操作符，外层是noexcept说明符
+// noexcept(noexcept(...))
+#define NOEXCEPT_IF(...) noexcept(__VA_ARGS__)
+
+// 放在循环之前，告诉编译器各次迭代之间没有依赖，可以向量化
+#if defined(_MSC_VER) && !defined(__clang__)
+#define BITSTL_IVDEP __pragma(loop(ivdep))
+#elif defined(__clang__)
+#define BITSTL_IVDEP _Pragma("clang loop vectorize(enable)")
+#elif defined(__GNUC__)
+#define BITSTL_IVDEP _Pragma("GCC ivdep")
+#else
+#define BITSTL_IVDEP
+#endif
+
+namespace bitstl
+{
+    using size_t    = unsigned long long int;
+    using ptrdiff_t = long long int;
+}
+
+#endif // !CONFIG_H
+
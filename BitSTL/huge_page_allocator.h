@@ -0,0 +1,327 @@
+/*
+ * 大页内存分配器
+ * 大块内存直接向系统映射并尽量使用大页，减少TLB缺失和首次访问时的缺页中断
+ */
+#ifndef HUGE_PAGE_ALLOCATOR_H
+#define HUGE_PAGE_ALLOCATOR_H
+
+#include <atomic>
+#include <cstdio>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "config.h"
+#include "type_traits.h"
+#include "allocator.h"
+#include "allocator_traits.h"
+
+namespace bitstl
+{
+    /*
+     * 直接向系统映射内存
+     * Linux：mmap匿名映射，优先使用预留的显式大页（MAP_HUGETLB），
+     *        失败时按大页大小对齐映射并以madvise(MADV_HUGEPAGE)请求透明大页
+     * Windows：优先使用VirtualAlloc(MEM_LARGE_PAGES)（需要SeLockMemoryPrivilege权限），失败时使用普通页
+     * 映射长度统一上调为大页大小的倍数，释放时由请求大小即可算出映射长度
+     */
+    class huge_page_alloc
+    {
+    public:
+        // 系统的普通页大小
+        static size_t page_size()
+            noexcept
+        {
+            static const size_t size = detect_page_size();
+            return size;
+        }
+
+        // 系统的（默认）大页大小，无法得知时取2MiB
+        static size_t huge_page_size()
+            noexcept
+        {
+            static const size_t size = detect_huge_page_size();
+            return size;
+        }
+
+        // 上调至大页大小的倍数
+        static size_t round_up(size_t bytes)
+            noexcept
+        {
+            const size_t huge = huge_page_size();
+            return (bytes + huge - 1) / huge * huge;
+        }
+
+        static void* allocate(size_t n)
+        {
+            const size_t len = round_up(n ? n : 1);
+            void* result = map(len);
+            if (!result)
+                throw std::bad_alloc();
+            return result;
+        }
+
+        // n需与allocate时一致
+        static void deallocate(void* p, size_t n)
+            noexcept
+        {
+            unmap(p, round_up(n ? n : 1));
+        }
+
+        // 尝试原地将old_n bytes的映射扩展至new_n bytes，失败时映射不变
+        static bool try_expand(void* p, size_t old_n, size_t new_n)
+            noexcept
+        {
+            const size_t old_len = round_up(old_n ? old_n : 1);
+            const size_t new_len = round_up(new_n);
+            if (new_len <= old_len)
+                return true;
+            return remap(p, old_len, new_len);
+        }
+
+    private:
+        // 显式大页映射失败（未预留或无权限）后不再尝试，避免每次分配多一次系统调用
+        inline static std::atomic<bool> explicit_failed_{ false };
+
+#ifdef _WIN32
+        static size_t detect_page_size()
+            noexcept
+        {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return info.dwPageSize;
+        }
+
+        static size_t detect_huge_page_size()
+            noexcept
+        {
+            const size_t size = GetLargePageMinimum();
+            return size ? size : size_t(2) << 20;
+        }
+
+        static void* map(size_t len)
+            noexcept
+        {
+            if (!explicit_failed_.load(std::memory_order_relaxed))
+            {
+                if (void* p = VirtualAlloc(nullptr, len, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE))
+                    return p;
+                explicit_failed_.store(true, std::memory_order_relaxed);
+            }
+            return VirtualAlloc(nullptr, len, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        }
+
+        static void unmap(void* p, size_t)
+            noexcept
+        {
+            VirtualFree(p, 0, MEM_RELEASE);
+        }
+
+        // MEM_RELEASE只能释放整个区域，扩展出的相邻区域无法随之释放，不支持原地扩展
+        static bool remap(void*, size_t, size_t)
+            noexcept
+        {
+            return false;
+        }
+#else
+        static size_t detect_page_size()
+            noexcept
+        {
+            const long size = sysconf(_SC_PAGESIZE);
+            return size > 0 ? size_t(size) : size_t(4096);
+        }
+
+        // 读取/proc/meminfo中的"Hugepagesize:    2048 kB"
+        static size_t detect_huge_page_size()
+            noexcept
+        {
+            size_t size = size_t(2) << 20;
+            if (std::FILE* f = std::fopen("/proc/meminfo", "r"))
+            {
+                char line[128];
+                unsigned long long kb = 0;
+                while (std::fgets(line, sizeof(line), f))
+                {
+                    if (std::sscanf(line, "Hugepagesize: %llu kB", &kb) == 1)
+                    {
+                        size = size_t(kb) << 10;
+                        break;
+                    }
+                }
+                std::fclose(f);
+            }
+            return size;
+        }
+
+        static void* map(size_t len)
+            noexcept
+        {
+#ifdef MAP_HUGETLB
+            if (!explicit_failed_.load(std::memory_order_relaxed))
+            {
+                void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p != MAP_FAILED)
+                    return p;
+                explicit_failed_.store(true, std::memory_order_relaxed);
+            }
+#endif
+            // 多映射一个大页，截去首尾使起始地址按大页对齐，透明大页才能覆盖整个区间
+            const size_t huge = huge_page_size();
+            void* raw = mmap(nullptr, len + huge, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED)
+                return nullptr;
+
+            char* begin   = static_cast<char*>(raw);
+            char* aligned = reinterpret_cast<char*>(
+                (reinterpret_cast<size_t>(begin) + huge - 1) / huge * huge);
+            if (aligned != begin)
+                munmap(begin, aligned - begin);
+            if (const size_t tail = (begin + len + huge) - (aligned + len))
+                munmap(aligned + len, tail);
+
+#ifdef MADV_HUGEPAGE
+            madvise(aligned, len, MADV_HUGEPAGE);
+#endif
+            return aligned;
+        }
+
+        static void unmap(void* p, size_t len)
+            noexcept
+        {
+            munmap(p, len);
+        }
+
+        // 不允许移动的mremap，仅当映射之后的地址空间空闲时成功
+        static bool remap(void* p, size_t old_len, size_t new_len)
+            noexcept
+        {
+#ifdef __linux__
+            if (mremap(p, old_len, new_len, 0) == MAP_FAILED)
+                return false;
+#ifdef MADV_HUGEPAGE
+            madvise(static_cast<char*>(p) + old_len, new_len - old_len, MADV_HUGEPAGE);
+#endif
+            return true;
+#else
+            return false;
+#endif
+        }
+#endif
+    };
+
+    /*
+     * 使用大页映射的分配器
+     * 不小于threshold bytes的请求交由huge_page_alloc，其余情况退回allocator
+     * threshold是分配器的状态，阈值不同的分配器不相等，内存须由阈值相同的分配器释放
+     * 默认阈值为一个大页，更小的请求使用大页会浪费内存
+     */
+    template<typename T>
+    class huge_page_allocator
+    {
+    public:
+        using value_type      = T;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+
+        // 阈值随分配器传播，保证容器持有的内存总由分配它的阈值释放
+        using propagate_on_container_copy_assignment = true_type;
+        using propagate_on_container_move_assignment = true_type;
+        using propagate_on_container_swap            = true_type;
+        using is_always_equal                        = false_type;
+
+        huge_page_allocator() noexcept : threshold_(huge_page_alloc::huge_page_size()) {}
+
+        explicit huge_page_allocator(size_t threshold) noexcept : threshold_(threshold) {}
+
+        huge_page_allocator(const huge_page_allocator&) noexcept = default;
+
+        template<typename U>
+        huge_page_allocator(const huge_page_allocator<U>& other) noexcept : threshold_(other.threshold()) {}
+
+        huge_page_allocator& operator=(const huge_page_allocator&) noexcept = default;
+
+        size_t threshold()
+            const noexcept
+        {
+            return threshold_;
+        }
+
+        [[nodiscard]]
+        T* allocate(size_type n)
+        {
+            static_assert(sizeof(T) != 0, "cannot allocate incomplete types");
+
+            if (n > (size_t(-1) / sizeof(T)))
+                throw std::bad_array_new_length();
+
+            if (use_fallback(n))
+                return allocator<T>().allocate(n);
+            return static_cast<T*>(huge_page_alloc::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_type n)
+        {
+            if (use_fallback(n))
+                allocator<T>().deallocate(p, n);
+            else
+                huge_page_alloc::deallocate(p, n * sizeof(T));
+        }
+
+        // 映射长度上调为大页的倍数，多出的空间也可使用
+        [[nodiscard]]
+        allocation_result<T*, size_type> allocate_at_least(size_type n)
+        {
+            T* p = allocate(n);
+            if (use_fallback(n))
+                return { p, n };
+            return { p, huge_page_alloc::round_up(n * sizeof(T)) / sizeof(T) };
+        }
+
+        // 仅映射得到的内存可以原地扩展，成功后以new_n释放
+        bool try_expand(T* p, size_type old_n, size_type new_n)
+        {
+            if (use_fallback(old_n) || new_n > (size_t(-1) / sizeof(T)))
+                return false;
+            return huge_page_alloc::try_expand(p, old_n * sizeof(T), new_n * sizeof(T));
+        }
+
+        template<typename U>
+        friend bool operator==(const huge_page_allocator& lhs, const huge_page_allocator<U>& rhs)
+            noexcept
+        {
+            return lhs.threshold() == rhs.threshold();
+        }
+
+        template<typename U>
+        friend bool operator!=(const huge_page_allocator& lhs, const huge_page_allocator<U>& rhs)
+            noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        size_t threshold_;
+
+        // 映射的起始地址按页对齐，能满足不超过页大小的对齐要求
+        bool use_fallback(size_type n)
+            const noexcept
+        {
+            return n * sizeof(T) < threshold_ || alignof(T) > huge_page_alloc::page_size();
+        }
+    };
+}
+
+#endif // !HUGE_PAGE_ALLOCATOR_H
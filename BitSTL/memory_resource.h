@@ -0,0 +1,681 @@
+/*
+ * 多态内存资源
+ * 参考C++17的std::pmr，可逐对象指定内存资源类型
+ */
+#ifndef MEMORY_RESOURCE_H
+#define MEMORY_RESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+#include "config.h"
+#include "type_traits.h"
+
+namespace bitstl
+{
+    /*
+     * 内存资源的抽象基类
+     */
+    class memory_resource
+    {
+    public:
+        static constexpr size_t max_align = alignof(std::max_align_t);
+
+        memory_resource() = default;
+        memory_resource(const memory_resource&) = default;
+        virtual ~memory_resource() = default;
+
+        memory_resource& operator=(const memory_resource&) = default;
+
+        [[nodiscard]]
+        void* allocate(size_t bytes, size_t alignment = max_align)
+        {
+            return do_allocate(bytes, alignment);
+        }
+
+        void deallocate(void* p, size_t bytes, size_t alignment = max_align)
+        {
+            do_deallocate(p, bytes, alignment);
+        }
+
+        // 一个资源分配的内存可由另一个资源释放时两者相等
+        bool is_equal(const memory_resource& other)
+            const noexcept
+        {
+            return do_is_equal(other);
+        }
+
+        friend bool operator==(const memory_resource& lhs, const memory_resource& rhs)
+            noexcept
+        {
+            return &lhs == &rhs || lhs.is_equal(rhs);
+        }
+
+        friend bool operator!=(const memory_resource& lhs, const memory_resource& rhs)
+            noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+        virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+    };
+
+    /*
+     * 内存资源内部使用的工具函数
+     */
+    namespace resource_detail
+    {
+        constexpr size_t align_up(size_t n, size_t alignment)
+            noexcept
+        {
+            return (n + alignment - 1) & ~(alignment - 1);
+        }
+
+        // 不小于n的2的幂
+        constexpr size_t ceil_pow2(size_t n)
+            noexcept
+        {
+            size_t res = 1;
+            while (res < n)
+                res <<= 1;
+            return res;
+        }
+
+        // 使用::operator new、::operator delete的内存资源
+        class new_delete_resource_impl : public memory_resource
+        {
+        private:
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    return ::operator new(bytes, std::align_val_t(alignment));
+                return ::operator new(bytes);
+            }
+
+            void do_deallocate(void* p, size_t bytes, size_t alignment) override
+            {
+                if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                {
+                    ::operator delete(p, bytes, std::align_val_t(alignment));
+                    return;
+                }
+                ::operator delete(p, bytes);
+            }
+
+            bool do_is_equal(const memory_resource& other)
+                const noexcept override
+            {
+                return this == &other;
+            }
+        };
+
+        // 任何分配都抛出std::bad_alloc的内存资源
+        class null_memory_resource_impl : public memory_resource
+        {
+        private:
+            void* do_allocate(size_t, size_t) override
+            {
+                throw std::bad_alloc();
+            }
+
+            void do_deallocate(void*, size_t, size_t) override {}
+
+            bool do_is_equal(const memory_resource& other)
+                const noexcept override
+            {
+                return this == &other;
+            }
+        };
+    }
+
+    inline memory_resource* new_delete_resource()
+        noexcept
+    {
+        static resource_detail::new_delete_resource_impl res;
+        return &res;
+    }
+
+    inline memory_resource* null_memory_resource()
+        noexcept
+    {
+        static resource_detail::null_memory_resource_impl res;
+        return &res;
+    }
+
+    namespace resource_detail
+    {
+        inline std::atomic<memory_resource*>& default_resource()
+            noexcept
+        {
+            static std::atomic<memory_resource*> res{ new_delete_resource() };
+            return res;
+        }
+    }
+
+    inline memory_resource* get_default_resource()
+        noexcept
+    {
+        return resource_detail::default_resource().load();
+    }
+
+    // 返回旧的默认资源，r为空指针时恢复为new_delete_resource()
+    inline memory_resource* set_default_resource(memory_resource* r)
+        noexcept
+    {
+        return resource_detail::default_resource().exchange(r ? r : new_delete_resource());
+    }
+
+    /*
+     * 池资源的构造参数
+     * 为0时使用默认值
+     */
+    struct pool_options
+    {
+        size_t max_blocks_per_chunk        = 0; // 每次向上游申请的chunk中区块数目的上限
+        size_t largest_required_pool_block = 0; // 超过该大小的分配直接交由上游资源
+    };
+
+    /*
+     * 单调缓冲资源
+     * 以指针递增的方式从缓冲区中分配，deallocate不做任何事，release或析构时一次性释放所有内存
+     * 缓冲区用尽时向上游申请几何增长的新缓冲区
+     * 适用于生命周期一致的一批对象（如一次请求），省去逐个释放的开销
+     * 非线程安全
+     */
+    class monotonic_buffer_resource : public memory_resource
+    {
+    public:
+        explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource())
+            : upstream_(upstream), next_size_(initial_size) {}
+
+        monotonic_buffer_resource(size_t initial, memory_resource* upstream = get_default_resource())
+            : upstream_(upstream), next_size_(initial > sizeof(chunk) ? initial : initial_size) {}
+
+        // 优先使用用户提供的缓冲区，该缓冲区不会被释放
+        monotonic_buffer_resource(void* buffer, size_t buffer_size, memory_resource* upstream = get_default_resource())
+            : upstream_(upstream),
+            initial_buffer_(static_cast<char*>(buffer)), initial_buffer_size_(buffer_size),
+            current_(static_cast<char*>(buffer)), end_(static_cast<char*>(buffer) + buffer_size),
+            next_size_(buffer_size > initial_size / 2 ? buffer_size * 2 : initial_size) {}
+
+        monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+        monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+        ~monotonic_buffer_resource() override
+        {
+            release();
+        }
+
+        // 释放所有向上游申请的内存，重新从用户提供的缓冲区开始分配
+        void release()
+        {
+            while (chunks_)
+            {
+                chunk* next = chunks_->next;
+                upstream_->deallocate(chunks_, chunks_->size, chunks_->alignment);
+                chunks_ = next;
+            }
+            current_ = initial_buffer_;
+            end_ = initial_buffer_ + initial_buffer_size_;
+        }
+
+        memory_resource* upstream_resource()
+            const noexcept
+        {
+            return upstream_;
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            if (bytes == 0)
+                bytes = 1;
+            if (void* p = try_bump(bytes, alignment))
+                return p;
+
+            // 当前缓冲区不足，申请新缓冲区，chunk头部放在缓冲区起始处
+            size_t need = resource_detail::align_up(sizeof(chunk), alignment) + bytes;
+            size_t size = next_size_ > need ? next_size_ : resource_detail::ceil_pow2(need);
+            const size_t chunk_alignment = alignment > chunk_align ? alignment : chunk_align;
+            void* mem = upstream_->allocate(size, chunk_alignment);
+            chunks_ = ::new (mem) chunk{ chunks_, size, chunk_alignment };
+            current_ = static_cast<char*>(mem) + sizeof(chunk);
+            end_ = static_cast<char*>(mem) + size;
+            next_size_ = size * growth_factor;
+            return try_bump(bytes, alignment);
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {}
+
+        bool do_is_equal(const memory_resource& other)
+            const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        static constexpr size_t initial_size  = 1024;
+        static constexpr size_t growth_factor = 2;
+
+        // 向上游申请的缓冲区以单链表串联，用于release
+        struct chunk
+        {
+            chunk* next;
+            size_t size;
+            size_t alignment;
+        };
+        static constexpr size_t chunk_align = alignof(std::max_align_t);
+
+        memory_resource* upstream_;
+        char*  initial_buffer_      = nullptr;
+        size_t initial_buffer_size_ = 0;
+        char*  current_             = nullptr;
+        char*  end_                 = nullptr;
+        size_t next_size_;
+        chunk* chunks_              = nullptr;
+
+        void* try_bump(size_t bytes, size_t alignment)
+            noexcept
+        {
+            if (!current_)
+                return nullptr;
+            size_t addr = reinterpret_cast<size_t>(current_);
+            char* p = current_ + (resource_detail::align_up(addr, alignment) - addr);
+            if (p > end_ || static_cast<size_t>(end_ - p) < bytes)
+                return nullptr;
+            current_ = p + bytes;
+            return p;
+        }
+    };
+
+    /*
+     * 非同步池资源
+     * 按2的幂划分区块大小，每种大小由一个池管理，池中的空闲区块以单链表串联
+     * 池内存不足时向上游申请chunk，chunk中的区块数目几何增长至max_blocks_per_chunk
+     * 超过largest_required_pool_block的分配直接交由上游资源
+     * release或析构时一次性释放所有内存
+     * 非线程安全
+     */
+    class unsynchronized_pool_resource : public memory_resource
+    {
+    public:
+        unsynchronized_pool_resource()
+            : unsynchronized_pool_resource(pool_options(), get_default_resource()) {}
+
+        explicit unsynchronized_pool_resource(memory_resource* upstream)
+            : unsynchronized_pool_resource(pool_options(), upstream) {}
+
+        explicit unsynchronized_pool_resource(const pool_options& opts)
+            : unsynchronized_pool_resource(opts, get_default_resource()) {}
+
+        unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+            : upstream_(upstream), opts_(normalize(opts))
+        {
+            pool_num_ = 0;
+            for (size_t size = min_block; size <= opts_.largest_required_pool_block; size <<= 1)
+                ++pool_num_;
+            pools_ = static_cast<pool*>(upstream_->allocate(sizeof(pool) * pool_num_, alignof(pool)));
+            for (size_t i = 0; i < pool_num_; ++i)
+                ::new (pools_ + i) pool{ nullptr, nullptr, 1 };
+        }
+
+        unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+        unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+        ~unsynchronized_pool_resource() override
+        {
+            release();
+            upstream_->deallocate(pools_, sizeof(pool) * pool_num_, alignof(pool));
+        }
+
+        void release()
+        {
+            for (size_t i = 0; i < pool_num_; ++i)
+            {
+                pool& pl = pools_[i];
+                while (pl.chunks)
+                {
+                    chunk* next = pl.chunks->next;
+                    char* mem = reinterpret_cast<char*>(pl.chunks + 1) - pl.chunks->size;
+                    upstream_->deallocate(mem, pl.chunks->size, chunk_align(i));
+                    pl.chunks = next;
+                }
+                pl.free_list = nullptr;
+                pl.next_blocks = 1;
+            }
+            while (large_)
+            {
+                large_block* next = large_->next;
+                upstream_->deallocate(large_, large_->size, large_->alignment);
+                large_ = next;
+            }
+        }
+
+        memory_resource* upstream_resource()
+            const noexcept
+        {
+            return upstream_;
+        }
+
+        pool_options options()
+            const noexcept
+        {
+            return opts_;
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            const size_t index = pool_index(bytes, alignment);
+            if (index >= pool_num_)
+                return allocate_large(bytes, alignment);
+
+            pool& pl = pools_[index];
+            if (!pl.free_list)
+                refill(index);
+            free_block* block = pl.free_list;
+            pl.free_list = block->next;
+            return block;
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            const size_t index = pool_index(bytes, alignment);
+            if (index >= pool_num_)
+            {
+                deallocate_large(p, bytes, alignment);
+                return;
+            }
+
+            pool& pl = pools_[index];
+            free_block* block = static_cast<free_block*>(p);
+            block->next = pl.free_list;
+            pl.free_list = block;
+        }
+
+        bool do_is_equal(const memory_resource& other)
+            const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        static constexpr size_t min_block                    = sizeof(void*) * 2;
+        static constexpr size_t default_max_blocks_per_chunk = 1024;
+        static constexpr size_t default_largest_block        = 4096;
+        static constexpr size_t max_largest_block            = size_t(1) << 20;
+
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        // chunk头部放在chunk末尾，使区块从chunk起始处开始，保证区块按其大小对齐
+        struct chunk
+        {
+            chunk* next;
+            size_t size;
+        };
+
+        struct pool
+        {
+            free_block* free_list;
+            chunk*      chunks;
+            size_t      next_blocks; // 下次申请chunk时的区块数目
+        };
+
+        // 直接交由上游资源的分配，头部放在用户内存之前
+        struct large_block
+        {
+            large_block* prev;
+            large_block* next;
+            size_t       size;
+            size_t       alignment;
+        };
+
+        memory_resource* upstream_;
+        pool_options     opts_;
+        pool*            pools_;
+        size_t           pool_num_;
+        large_block*     large_ = nullptr;
+
+        static pool_options normalize(pool_options opts)
+            noexcept
+        {
+            if (opts.max_blocks_per_chunk == 0)
+                opts.max_blocks_per_chunk = default_max_blocks_per_chunk;
+            if (opts.largest_required_pool_block == 0)
+                opts.largest_required_pool_block = default_largest_block;
+            if (opts.largest_required_pool_block > max_largest_block)
+                opts.largest_required_pool_block = max_largest_block;
+            if (opts.largest_required_pool_block < min_block)
+                opts.largest_required_pool_block = min_block;
+            opts.largest_required_pool_block = resource_detail::ceil_pow2(opts.largest_required_pool_block);
+            return opts;
+        }
+
+        static constexpr size_t block_size(size_t index)
+            noexcept
+        {
+            return min_block << index;
+        }
+
+        // 区块按其大小对齐，因此对齐要求不超过区块大小时即可满足
+        size_t pool_index(size_t bytes, size_t alignment)
+            const noexcept
+        {
+            size_t size = bytes > alignment ? bytes : alignment;
+            size_t index = 0;
+            while (index < pool_num_ && block_size(index) < size)
+                ++index;
+            return index;
+        }
+
+        static constexpr size_t chunk_align(size_t index)
+            noexcept
+        {
+            return block_size(index) > alignof(std::max_align_t) ? block_size(index) : alignof(std::max_align_t);
+        }
+
+        void refill(size_t index)
+        {
+            pool& pl = pools_[index];
+            const size_t bsize = block_size(index);
+            const size_t blocks = pl.next_blocks;
+            const size_t chunk_bytes = resource_detail::align_up(bsize * blocks, alignof(chunk)) + sizeof(chunk);
+
+            char* mem = static_cast<char*>(upstream_->allocate(chunk_bytes, chunk_align(index)));
+            chunk* ck = ::new (mem + chunk_bytes - sizeof(chunk)) chunk{ pl.chunks, chunk_bytes };
+            pl.chunks = ck;
+
+            for (size_t i = blocks; i > 0; --i)
+            {
+                free_block* block = reinterpret_cast<free_block*>(mem + (i - 1) * bsize);
+                block->next = pl.free_list;
+                pl.free_list = block;
+            }
+
+            if (pl.next_blocks < opts_.max_blocks_per_chunk)
+                pl.next_blocks = pl.next_blocks * 2 < opts_.max_blocks_per_chunk
+                    ? pl.next_blocks * 2 : opts_.max_blocks_per_chunk;
+        }
+
+        static size_t large_header_size(size_t alignment)
+            noexcept
+        {
+            return resource_detail::align_up(sizeof(large_block), alignment);
+        }
+
+        void* allocate_large(size_t bytes, size_t alignment)
+        {
+            if (alignment < alignof(large_block))
+                alignment = alignof(large_block);
+            const size_t header = large_header_size(alignment);
+            const size_t total = header + bytes;
+            char* mem = static_cast<char*>(upstream_->allocate(total, alignment));
+            large_block* lb = ::new (mem + header - sizeof(large_block)) large_block{ nullptr, large_, total, alignment };
+            if (large_)
+                large_->prev = lb;
+            large_ = lb;
+            return mem + header;
+        }
+
+        void deallocate_large(void* p, size_t, size_t alignment)
+        {
+            if (alignment < alignof(large_block))
+                alignment = alignof(large_block);
+            large_block* lb = reinterpret_cast<large_block*>(static_cast<char*>(p) - sizeof(large_block));
+            if (lb->prev)
+                lb->prev->next = lb->next;
+            else
+                large_ = lb->next;
+            if (lb->next)
+                lb->next->prev = lb->prev;
+            char* mem = static_cast<char*>(p) - large_header_size(alignment);
+            upstream_->deallocate(mem, lb->size, lb->alignment);
+        }
+    };
+
+    /*
+     * 同步池资源
+     * 与unsynchronized_pool_resource相同，所有操作加锁，线程安全
+     */
+    class synchronized_pool_resource : public memory_resource
+    {
+    public:
+        synchronized_pool_resource() : impl_() {}
+
+        explicit synchronized_pool_resource(memory_resource* upstream) : impl_(upstream) {}
+
+        explicit synchronized_pool_resource(const pool_options& opts) : impl_(opts) {}
+
+        synchronized_pool_resource(const pool_options& opts, memory_resource* upstream) : impl_(opts, upstream) {}
+
+        synchronized_pool_resource(const synchronized_pool_resource&) = delete;
+        synchronized_pool_resource& operator=(const synchronized_pool_resource&) = delete;
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            impl_.release();
+        }
+
+        memory_resource* upstream_resource()
+            const noexcept
+        {
+            return impl_.upstream_resource();
+        }
+
+        pool_options options()
+            const noexcept
+        {
+            return impl_.options();
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            return impl_.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            impl_.deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const memory_resource& other)
+            const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        unsynchronized_pool_resource impl_;
+        std::mutex mtx_;
+    };
+
+    /*
+     * 多态分配器
+     * 将分配转发至运行时指定的memory_resource，不同资源的分配器类型相同
+     * 容器拷贝构造时不传播分配器，而是使用默认资源
+     */
+    template<typename T>
+    class polymorphic_allocator
+    {
+    public:
+        using value_type      = T;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+
+        // 分配器绑定于容器，移动赋值、拷贝赋值、交换时均不传播
+        using propagate_on_container_copy_assignment = false_type;
+        using propagate_on_container_move_assignment = false_type;
+        using propagate_on_container_swap            = false_type;
+        using is_always_equal                        = false_type;
+
+        polymorphic_allocator() noexcept : resource_(get_default_resource()) {}
+
+        // 允许由memory_resource*隐式转换
+        polymorphic_allocator(memory_resource* r) noexcept : resource_(r) {}
+
+        polymorphic_allocator(const polymorphic_allocator& other) = default;
+
+        template<typename U>
+        polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+            : resource_(other.resource()) {}
+
+        polymorphic_allocator& operator=(const polymorphic_allocator&) = delete;
+
+        [[nodiscard]]
+        T* allocate(size_type n)
+        {
+            if (n > (size_t(-1) / sizeof(T)))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_type n)
+        {
+            resource_->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        // 容器拷贝构造时使用默认资源
+        polymorphic_allocator select_on_container_copy_construction()
+            const
+        {
+            return polymorphic_allocator();
+        }
+
+        memory_resource* resource()
+            const noexcept
+        {
+            return resource_;
+        }
+
+        template<typename U>
+        friend bool operator==(const polymorphic_allocator& lhs, const polymorphic_allocator<U>& rhs)
+            noexcept
+        {
+            return *lhs.resource() == *rhs.resource();
+        }
+
+        template<typename U>
+        friend bool operator!=(const polymorphic_allocator& lhs, const polymorphic_allocator<U>& rhs)
+            noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        memory_resource* resource_;
+    };
+}
+
+#endif // !MEMORY_RESOURCE_H
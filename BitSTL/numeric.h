@@ -0,0 +1,160 @@
+/*
+ * 数值算法库
+ */
+#ifndef NUMERIC_H
+#define NUMERIC_H
+
+#include <functional>
+
+#include "config.h"
+#include "type_traits.h"
+#include "iterator.h"
+
+namespace bitstl
+{
+    // 按顺序从左到右累加
+    template<typename InputIterator, typename T, typename BinaryOperation>
+    T accumulate(InputIterator first, InputIterator last, T init, BinaryOperation op)
+    {
+        for (; first != last; ++first)
+            init = op(bitstl::move(init), *first);
+        return init;
+    }
+
+    template<typename InputIterator, typename T>
+    T accumulate(InputIterator first, InputIterator last, T init)
+    {
+        return bitstl::accumulate(first, last, bitstl::move(init), std::plus<>());
+    }
+
+    /*
+     * 规约，要求op满足结合律与交换律，允许以任意顺序与分组计算
+     * 随机访问迭代器上使用4个独立的累加器，消除相邻加法之间的依赖，便于流水线与向量化
+     */
+    template<typename InputIterator, typename T, typename BinaryOperation>
+    T reduce(InputIterator first, InputIterator last, T init, BinaryOperation op)
+    {
+        if constexpr (is_random_access_iterator<InputIterator> || std::random_access_iterator<InputIterator>)
+        {
+            if (last - first >= 8)
+            {
+                T acc0 = op(first[0], first[1]), acc1 = op(first[2], first[3]);
+                T acc2 = op(first[4], first[5]), acc3 = op(first[6], first[7]);
+                first += 8;
+                for (; last - first >= 4; first += 4)
+                {
+                    acc0 = op(bitstl::move(acc0), first[0]);
+                    acc1 = op(bitstl::move(acc1), first[1]);
+                    acc2 = op(bitstl::move(acc2), first[2]);
+                    acc3 = op(bitstl::move(acc3), first[3]);
+                }
+                init = op(bitstl::move(init), op(op(bitstl::move(acc0), bitstl::move(acc1)), op(bitstl::move(acc2), bitstl::move(acc3))));
+            }
+        }
+        return bitstl::accumulate(first, last, bitstl::move(init), op);
+    }
+
+    template<typename InputIterator, typename T>
+    T reduce(InputIterator first, InputIterator last, T init)
+    {
+        return bitstl::reduce(first, last, bitstl::move(init), std::plus<>());
+    }
+
+    template<typename InputIterator>
+    typename iterator_traits<InputIterator>::value_type reduce(InputIterator first, InputIterator last)
+    {
+        return bitstl::reduce(first, last, typename iterator_traits<InputIterator>::value_type());
+    }
+
+    // 对每个元素（或两个区间对应的元素）变换后规约
+    template<typename InputIterator, typename T, typename BinaryReductionOp, typename UnaryTransformOp>
+    T transform_reduce(InputIterator first, InputIterator last, T init, BinaryReductionOp reduce, UnaryTransformOp transform)
+    {
+        for (; first != last; ++first)
+            init = reduce(bitstl::move(init), transform(*first));
+        return init;
+    }
+
+    template<typename InputIterator1, typename InputIterator2, typename T, typename BinaryReductionOp, typename BinaryTransformOp>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init,
+        BinaryReductionOp reduce, BinaryTransformOp transform)
+    {
+        for (; first1 != last1; ++first1, ++first2)
+            init = reduce(bitstl::move(init), transform(*first1, *first2));
+        return init;
+    }
+
+    // 内积
+    template<typename InputIterator1, typename InputIterator2, typename T>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, T init)
+    {
+        return bitstl::transform_reduce(first1, last1, first2, bitstl::move(init), std::plus<>(), std::multiplies<>());
+    }
+
+    /*
+     * 前缀和
+     * 输出区间可以与输入区间相同（原地计算），每个元素先读出再写入结果
+     */
+    // d_first[i] = op(init, first[0], ..., first[i])
+    template<typename InputIterator, typename OutputIterator, typename BinaryOperation, typename T>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last, OutputIterator d_first, BinaryOperation op, T init)
+    {
+        for (; first != last; (void)++first, (void)++d_first)
+        {
+            init = op(bitstl::move(init), *first);
+            *d_first = init;
+        }
+        return d_first;
+    }
+
+    // d_first[i] = op(first[0], ..., first[i])
+    template<typename InputIterator, typename OutputIterator, typename BinaryOperation>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last, OutputIterator d_first, BinaryOperation op)
+    {
+        if (first == last)
+            return d_first;
+        typename iterator_traits<InputIterator>::value_type init = *first;
+        *d_first = init;
+        return bitstl::inclusive_scan(++first, last, ++d_first, op, bitstl::move(init));
+    }
+
+    template<typename InputIterator, typename OutputIterator>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last, OutputIterator d_first)
+    {
+        return bitstl::inclusive_scan(first, last, d_first, std::plus<>());
+    }
+
+    // d_first[i] = op(init, first[0], ..., first[i - 1])
+    template<typename InputIterator, typename OutputIterator, typename T, typename BinaryOperation>
+    OutputIterator exclusive_scan(InputIterator first, InputIterator last, OutputIterator d_first, T init, BinaryOperation op)
+    {
+        for (; first != last; (void)++first, (void)++d_first)
+        {
+            T next = op(init, *first);
+            *d_first = bitstl::move(init);
+            init = bitstl::move(next);
+        }
+        return d_first;
+    }
+
+    template<typename InputIterator, typename OutputIterator, typename T>
+    OutputIterator exclusive_scan(InputIterator first, InputIterator last, OutputIterator d_first, T init)
+    {
+        return bitstl::exclusive_scan(first, last, d_first, bitstl::move(init), std::plus<>());
+    }
+
+    // 按顺序计算的inclusive_scan
+    template<typename InputIterator, typename OutputIterator, typename BinaryOperation>
+    OutputIterator partial_sum(InputIterator first, InputIterator last, OutputIterator d_first, BinaryOperation op)
+    {
+        return bitstl::inclusive_scan(first, last, d_first, op);
+    }
+
+    template<typename InputIterator, typename OutputIterator>
+    OutputIterator partial_sum(InputIterator first, InputIterator last, OutputIterator d_first)
+    {
+        return bitstl::inclusive_scan(first, last, d_first, std::plus<>());
+    }
+}
+
+#endif // !NUMERIC_H
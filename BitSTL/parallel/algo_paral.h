@@ -1,379 +1,2000 @@
-/*
- * 并发算法库
- */
-#ifndef ALGO_PARAL_H
-#define ALGO_PARAL_H
-
-#include <numeric>
-#include <vector>
-#include <thread>
-#include <future>
-#include <cassert>
-
-#include "threadsafe/stack_ts.h"
-
-namespace bitstl
-{
-    using ulong = unsigned long;
-    using uint = unsigned int;
-
-    // 划分子任务
-    static void get_partition(const ulong data_length, ulong& thread_num, ulong& data_per_thread)
-    {
-        assert(data_length > 0);
-        const ulong min_per_thread = 20ul;
-        const ulong max_threads = (data_length + min_per_thread - 1) / min_per_thread;
-        const ulong hardware_threads = std::thread::hardware_concurrency();
-        thread_num = std::min(hardware_threads != 0 ? hardware_threads : 2, max_threads);
-        data_per_thread = data_length / thread_num;
-    }
-
-    template<typename Iterator, typename Func>
-    void for_each_paral(Iterator first, Iterator last, Func f)
-    {
-        ulong const data_length = std::distance(first, last);
-        if (!data_length)
-            return;
-
-        ulong thread_num = 0, data_per_thread = 0;
-        get_partition(data_length, thread_num, data_per_thread);
-
-        std::vector<std::future<void>> futures(thread_num - 1);
-        std::vector<std::thread> threads(thread_num - 1);
-
-        Iterator start = first;
-        for (ulong i = 0; i < (thread_num - 1); ++i)
-        {
-            Iterator end = start;
-            std::advance(end, data_per_thread);
-            std::packaged_task<void(void)> task([=]()
-            {
-                std::for_each(start, end, f);
-            });
-            futures[i] = task.get_future();
-            threads[i] = std::thread(std::move(task));
-            start = end;
-        }
-        std::for_each(start, last, f);
-        for (ulong i = 0; i < (thread_num - 1); ++i)
-        {
-            futures[i].get();
-            threads[i].join();
-        }            
-    }
-
-    template<typename Iterator, typename T>
-    struct accumulate_once
-    {
-        T operator()(Iterator first, Iterator last)
-        {
-            return std::accumulate(first, last, T());
-        }         
-    };
-
-    template<typename Iterator, typename T>
-    T accumulate_paral(Iterator first, Iterator last, T init)
-    {
-        const ulong data_length = std::distance(first, last);
-        if (!data_length)
-            return init;
-
-        ulong thread_num = 0, data_per_thread = 0;
-        get_partition(data_length, thread_num, data_per_thread);
-
-        std::vector<std::future<T>> futures(thread_num - 1);
-        std::vector<std::thread> threads(thread_num - 1);
-
-        Iterator start = first;
-        for (ulong i = 0; i < (thread_num - 1); ++i)
-        {
-            Iterator end = start;
-            std::advance(end, data_per_thread);
-            // 使用{}初始化而不是()初始化避免编译器将其作为函数声明
-            std::packaged_task<T(Iterator, Iterator)> task{ accumulate_once<Iterator, T>() };
-            futures[i] = task.get_future();
-            threads[i] = std::thread(std::move(task), start, end);
-            start = end;
-        }
-        
-        T res = init + accumulate_once<Iterator, T>()(start, last);
-
-        for (auto& thread : threads)
-            thread.join();
-
-        for (auto& future : futures)
-            res += future.get();
-
-        return res;
-    }
-
-    template<typename T, typename Comp>
-    struct sorter;
-
-    template<typename T, typename Comp>
-    std::list<T> quick_sort_paral(const std::list<T>& input, Comp comp)
-    {
-        if (input.empty())
-            return input;
-        static sorter<T, Comp> s;
-        return s.sort(input, comp);
-    }
-
-    template<typename T, typename Comp>
-    struct sorter
-    {
-        struct chunk_to_sort
-        {
-            std::list<T> data;
-            std::promise<std::list<T>> promise;
-
-            chunk_to_sort() = default;
-            // promise仅可移动
-            chunk_to_sort(chunk_to_sort&& other) : data(std::move(other.data)), promise(std::move(other.promise)) {}
-        };
-        stack_ts<chunk_to_sort> chunks;
-
-        std::vector<std::thread> threads;
-        const uint max_thread_count;
-        std::atomic_bool end;
-        Comp comp;
-
-        sorter() : max_thread_count(std::thread::hardware_concurrency()),
-            end(false) {}
-
-        ~sorter()
-        {
-            end.store(true);
-            for (uint i = 0; i < threads.size(); ++i)
-                threads[i].join();
-        }
-
-        void thread_work()
-        {
-            while (!end.load())
-            {
-                try_sort_chunk();
-                std::this_thread::yield();
-            }
-        }
-
-        void try_sort_chunk()
-        {
-            std::shared_ptr<chunk_to_sort> chunk = chunks.pop();
-            if (chunk)
-                chunk->promise.set_value(*do_sort(std::make_unique<std::list<T>>(chunk->data)));
-        }
-
-        // 若在do_sort中动态增加thread会导致同时有多个thread并发向threads中增加thread，造成不能百分百复现的访问冲突
-        std::list<T> sort(std::list<T> chunk_data, Comp _comp)
-        {
-            comp = _comp;
-            while (threads.size() < max_thread_count - 1)
-                threads.push_back(std::thread(&sorter<T, Comp>::thread_work, this));
-            return *do_sort(std::make_unique<std::list<T>>(chunk_data));
-        }
-
-        // 递归太深会导致stack overflow
-        std::unique_ptr<std::list<T>> do_sort(std::unique_ptr<std::list<T>> chunk_data)
-        {
-            if (chunk_data->empty() || chunk_data->size() == 1)
-                return std::move(chunk_data);
-
-            std::unique_ptr<std::list<T>> result = std::make_unique<std::list<T>>();
-
-            // 取第一个值作为划分轴
-            result->splice(result->begin(), *chunk_data, chunk_data->begin());
-            const T& partition_val = *(result->begin());
-            typename std::list<T>::iterator pivot =
-                std::partition(chunk_data->begin(), chunk_data->end(),
-                    [&](const T& v) {return comp(v, partition_val); });
-
-            chunk_to_sort new_lower_chunk;
-            new_lower_chunk.data.splice(new_lower_chunk.data.end(), *chunk_data, chunk_data->begin(), pivot);
-
-            std::future<std::list<T>> new_lower = new_lower_chunk.promise.get_future();
-
-            chunks.push(std::move(new_lower_chunk));
-
-            // 当前线程对后半排序
-            std::list<T> new_higher(*do_sort(std::move(chunk_data)));
-            result->splice(result->end(), new_higher);
-
-            // 其它线程对前半排序
-            while (new_lower.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
-                try_sort_chunk();
-
-            result->splice(result->begin(), new_lower.get());
-
-            return std::move(result);
-        }
-    };
-
-    template<typename Iterator, typename MatchType>
-    Iterator find_paral(Iterator first, Iterator last, MatchType match)
-    {
-        struct iteration
-        {
-            void operator()(
-                Iterator begin, Iterator end, MatchType match,
-                std::promise<Iterator>* result,
-                std::atomic<bool>* done)
-            {
-                try
-                {
-                    for (; (begin != end) && !done->load(); ++begin)
-                    {
-                        if (*begin == match)
-                        {
-                            result->set_value(begin);
-                            done->store(true);
-                            return;
-                        }
-                    }
-                }
-                catch (...)
-                {
-                    try
-                    {
-                        result->set_exception(std::current_exception());
-                        done->store(true);
-                    }
-                    catch (...)
-                    {}
-                }
-            }
-        };
-
-        const ulong data_length = std::distance(first, last);
-        if (!data_length)
-            return last;
-
-        ulong thread_num = 0, data_per_thread = 0;
-        get_partition(data_length, thread_num, data_per_thread);
-
-        std::promise<Iterator> result;
-        std::atomic<bool> done(false);
-        std::vector<std::thread> threads(thread_num - 1);
-
-        Iterator start = first;
-        for (ulong i = 0; i < (thread_num - 1); ++i)
-        {
-            Iterator end = start;
-            std::advance(end, data_per_thread);
-            threads[i] = std::thread(iteration(), start, end, match, &result, &done);
-            start = end;
-        }
-
-        iteration()(start, last, match, &result, &done);
-
-        for (auto& thread : threads)
-            thread.join();
-
-        if (!done.load())
-            return last;
-
-        return result.get_future().get();
-    }
-
-    // 线程栅栏，用于多线程同步
-    struct barrier
-    {
-        std::atomic_uint count;
-        std::atomic_uint spaces; 
-        std::atomic_uint generation;
-        barrier(uint _count) : count(_count), spaces(_count), generation(0) {}
-
-        void wait()
-        {
-            const uint g = generation.load();
-            // spaces减1，为0时代表count个线程均已到达barrier，可以进行下一步计算
-            if (!(--spaces))
-            {
-                // 当spaces为0时重置为count
-                spaces = count.load();
-                // 记录所有线程均到达barrier的次数
-                ++generation;
-            }
-            else
-            {
-                // 自己已到达barrier，等待其它线程
-                while (generation.load() == g)
-                    std::this_thread::yield();
-            }
-        }
-
-        // 结束对一个线程的同步
-        void done_waiting()
-        {
-            --count;
-            if (!--spaces)
-            {
-                spaces = count.load();
-                ++generation;
-            }
-        }
-    };
-
-    template<typename Iterator>
-    void partial_sum_paral(Iterator first, Iterator last)
-    {
-        typedef typename Iterator::value_type value_type;
-
-        const ulong data_length = std::distance(first, last);
-        if (data_length <= 1)
-            return;
-
-        barrier br(data_length);
-        // 此算法需要和数据量等同的线程数，仅适用于大规模并行计算机
-        std::vector<std::thread> threads(data_length - 1);
-
-        std::vector<value_type> buffer(first, last);
-        /*
-         * 计算前缀和
-         * 例：1, 1, 1, 1, 1
-         * 第一轮：将距离为1的数相加 1, 2, 2, 2, 2 前2个位置完成前缀和
-         * 第二轮：将距离为2的数相加 1, 2, 3, 4, 4 前4个位置完成前缀和
-         * 第三轮：将距离为4的数相加 1, 2, 3, 4, 5 所有位置完成前缀和
-         * 使用5个线程并发（每个位置对应1个线程），每一轮次内并发计算，距离按2的幂增加
-         * 所有线程均完成一个轮次后（barrier同步）才可进行下一轮次计算
-         * 已经完成计算的位置对应的线程即刻退出同步
-         */
-        auto process_pos = [&](Iterator first, Iterator last, uint i, barrier& b)
-            {
-                value_type& ith_element = *(first + i);
-                bool update_source = false;
-
-                // step即轮次，每一轮次原数据和buffer数据交替作为source和dest               
-                for (uint step = 0, stride = 1; stride <= i; ++step, stride *= 2)
-                {
-                    const value_type& source = (step % 2) ? buffer[i]          : ith_element;
-                    value_type&       dest   = (step % 2) ? ith_element        : buffer[i];
-                    const value_type& addend = (step % 2) ? buffer[i - stride] : *(first + i - stride);
-                    dest = source + addend;
-                    update_source = !(step % 2);
-
-                    b.wait();
-                }
-
-                if (update_source)
-                    ith_element = buffer[i];
-                // 该位置计算已完成，但后续位置计算时仍会用到buffer，因此buffer需要和原数据一致
-                else
-                    buffer[i] = ith_element;
-
-                b.done_waiting();
-            };
-
-        for (ulong i = 0; i < (data_length - 1); ++i)
-            threads[i] = std::thread(process_pos, first, last, i, std::ref(br));
-
-        process_pos(first, last, data_length - 1, br);
-
-        for (auto& thread : threads)
-            thread.join();
-    }
-}
-
-#endif // !ALGO_PARAL_H
-
-
+/*
+ * 并发算法库
+ */
+#ifndef ALGO_PARAL_H
+#define ALGO_PARAL_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <vector>
+#include <thread>
+#include <future>
+#include <cassert>
+
+#include "algorithm.h"
+#include "numeric.h"
+#include "radix_sort.h"
+#include "threadsafe/stack_ts.h"
+#include "thread_pool.h"
+#include "partitioner.h"
+#include "sync.h"
+
+namespace bitstl
+{
+    using ulong = unsigned long;
+    using uint = unsigned int;
+
+    // 划分子任务，子任务数不超过线程池的并发数
+    inline void get_partition(const thread_pool& pool, const ulong data_length, ulong& thread_num, ulong& data_per_thread)
+    {
+        assert(data_length > 0);
+        const ulong min_per_thread = 20ul;
+        const ulong max_threads = (data_length + min_per_thread - 1) / min_per_thread;
+        thread_num = std::min(static_cast<ulong>(pool.concurrency()), max_threads);
+        data_per_thread = data_length / thread_num;
+    }
+
+    // 在pool中执行f(0)至f(thread_num - 1)，其中f(thread_num - 1)由当前线程执行
+    // 所有任务结束后再重新抛出其中的异常
+    template<typename Func>
+    void run_paral(thread_pool& pool, ulong thread_num, Func& f)
+    {
+        pool.run(thread_num, f);
+    }
+
+    template<typename Func>
+    void run_paral(ulong thread_num, Func& f)
+    {
+        run_paral(thread_pool::default_pool(), thread_num, f);
+    }
+
+    // 将[first, last)划分为thread_num段，bounds[t]、bounds[t + 1]为第t段的首尾，适用于非随机访问迭代器
+    template<typename Iterator>
+    std::vector<Iterator> get_bounds(Iterator first, Iterator last, ulong thread_num, ulong data_per_thread)
+    {
+        std::vector<Iterator> bounds(thread_num + 1);
+        bounds[0] = first;
+        for (ulong t = 1; t < thread_num; ++t)
+        {
+            bounds[t] = bounds[t - 1];
+            std::advance(bounds[t], data_per_thread);
+        }
+        bounds[thread_num] = last;
+        return bounds;
+    }
+
+    // 另一区间中与bounds的各段一一对应的段的起点，如输出区间或第二个输入区间
+    template<typename Iterator, typename OtherIterator>
+    std::vector<OtherIterator> get_matching_bounds(const std::vector<Iterator>& bounds, OtherIterator other_first)
+    {
+        std::vector<OtherIterator> other_bounds(bounds.size() - 1);
+        other_bounds[0] = other_first;
+        for (std::size_t t = 1; t < other_bounds.size(); ++t)
+        {
+            other_bounds[t] = other_bounds[t - 1];
+            std::advance(other_bounds[t], std::distance(bounds[t - 1], bounds[t]));
+        }
+        return other_bounds;
+    }
+
+    namespace partition_detail
+    {
+        template<typename Iterator>
+        inline constexpr bool is_random_access_v = is_random_access_iterator<Iterator> || std::random_access_iterator<Iterator>;
+
+        // 作为划分器参数时才参与重载决议
+        template<typename Partitioner>
+        using enable_if_partitioner_t = std::enable_if_t<is_partitioner_v<Partitioner>, int>;
+
+        template<typename Partitioner>
+        using disable_if_partitioner_t = std::enable_if_t<!is_partitioner_v<Partitioner>, int>;
+    }
+
+    /*
+     * 以partitioner划分[first, last)并行执行f，迭代器须支持随机访问，否则按get_partition等分
+     * 不指定partitioner时使用auto_partitioner，元素很少或很廉价时在当前线程完成
+     */
+    template<typename Iterator, typename Func, typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    void for_each_paral(thread_pool& pool, Iterator first, Iterator last, Func f, Partitioner&& partitioner)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return;
+
+        if constexpr (partition_detail::is_random_access_v<Iterator>)
+        {
+            auto body = [&](std::size_t begin, std::size_t end)
+                {
+                    bitstl::for_each(first + begin, first + end, f);
+                };
+            partitioner.run(pool, data_length, body);
+        }
+        else
+        {
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+            auto process = [&](ulong t)
+                {
+                    bitstl::for_each(bounds[t], bounds[t + 1], f);
+                };
+            run_paral(pool, thread_num, process);
+        }
+    }
+
+    template<typename Iterator, typename Func>
+    void for_each_paral(thread_pool& pool, Iterator first, Iterator last, Func f)
+    {
+        for_each_paral(pool, first, last, f, auto_partitioner());
+    }
+
+    template<typename Iterator, typename Func, typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    void for_each_paral(Iterator first, Iterator last, Func f, Partitioner&& partitioner)
+    {
+        for_each_paral(thread_pool::default_pool(), first, last, f, partitioner);
+    }
+
+    template<typename Iterator, typename Func>
+    void for_each_paral(Iterator first, Iterator last, Func f)
+    {
+        for_each_paral(thread_pool::default_pool(), first, last, f);
+    }
+
+    template<typename Iterator, typename T>
+    struct accumulate_once
+    {
+        T operator()(Iterator first, Iterator last)
+        {
+            return std::accumulate(first, last, T());
+        }         
+    };
+
+    namespace accumulate_detail
+    {
+        // 按get_partition等分，各段的部分和按段的顺序返回
+        template<typename Iterator, typename T>
+        std::vector<T> partial_sums(thread_pool& pool, Iterator first, Iterator last, ulong data_length)
+        {
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+            std::vector<T> results(thread_num);
+            auto process = [&](ulong t)
+                {
+                    results[t] = accumulate_once<Iterator, T>()(bounds[t], bounds[t + 1]);
+                };
+            run_paral(pool, thread_num, process);
+            return results;
+        }
+    }
+
+    /*
+     * 以partitioner划分时块的个数事先未知，各块的部分和连同块的起点记入results，结束后按起点的顺序累加
+     * auto_partitioner的块边界取决于测得的耗时，浮点数的结果每次运行可能不同
+     * 迭代器不支持随机访问时按get_partition等分
+     */
+    template<typename Iterator, typename T, typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    T accumulate_paral(thread_pool& pool, Iterator first, Iterator last, T init, Partitioner&& partitioner)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return init;
+
+        T res = init;
+        if constexpr (partition_detail::is_random_access_v<Iterator>)
+        {
+            std::vector<std::pair<std::size_t, T>> results;
+            std::mutex mtx;
+            auto body = [&](std::size_t begin, std::size_t end)
+                {
+                    T result = accumulate_once<Iterator, T>()(first + begin, first + end);
+                    std::lock_guard<std::mutex> lk(mtx);
+                    results.emplace_back(begin, std::move(result));
+                };
+            partitioner.run(pool, data_length, body);
+            std::sort(results.begin(), results.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (auto& result : results)
+                res += result.second;
+        }
+        else
+        {
+            for (auto& result : accumulate_detail::partial_sums<Iterator, T>(pool, first, last, data_length))
+                res += result;
+        }
+        return res;
+    }
+
+    // 不指定划分器时按并发数等分，并发数不变时结果确定
+    template<typename Iterator, typename T>
+    T accumulate_paral(thread_pool& pool, Iterator first, Iterator last, T init)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return init;
+
+        T res = init;
+        for (auto& result : accumulate_detail::partial_sums<Iterator, T>(pool, first, last, data_length))
+            res += result;
+        return res;
+    }
+
+    template<typename Iterator, typename T, typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    T accumulate_paral(Iterator first, Iterator last, T init, Partitioner&& partitioner)
+    {
+        return accumulate_paral(thread_pool::default_pool(), first, last, init, partitioner);
+    }
+
+    template<typename Iterator, typename T>
+    T accumulate_paral(Iterator first, Iterator last, T init)
+    {
+        return accumulate_paral(thread_pool::default_pool(), first, last, init);
+    }
+
+    // 作为reduce_paral、transform_reduce_paral的op时以补偿求和累加浮点数，单独调用时即为加法
+    struct compensated_plus
+    {
+        template<typename T, typename U>
+        constexpr auto operator()(T&& lhs, U&& rhs)
+            const
+        {
+            return std::forward<T>(lhs) + std::forward<U>(rhs);
+        }
+    };
+
+    namespace reduce_detail
+    {
+        // 叶子块的大小固定，划分方式只取决于元素个数，与线程数无关
+        inline constexpr ulong leaf_size = 4096;
+
+        struct identity
+        {
+            template<typename T>
+            constexpr T&& operator()(T&& x)
+                const noexcept
+            {
+                return std::forward<T>(x);
+            }
+        };
+
+        // Kahan-Babuška-Neumaier补偿求和：error累计每次加法的舍入误差，最后再加回
+        template<typename T>
+        struct compensated
+        {
+            T sum;
+            T error;
+
+            void add(const T& x)
+            {
+                const T t = sum + x;
+                if (std::abs(sum) >= std::abs(x))
+                    error += (sum - t) + x;
+                else
+                    error += (x - t) + sum;
+                sum = t;
+            }
+
+            compensated& operator+=(const compensated& other)
+            {
+                add(other.sum);
+                error += other.error;
+                return *this;
+            }
+
+            T value()
+                const
+            {
+                return sum + error;
+            }
+        };
+
+        // 各叶子块的起点
+        template<typename Iterator>
+        std::vector<Iterator> get_leaves(Iterator first, ulong data_length)
+        {
+            std::vector<Iterator> leaves((data_length + leaf_size - 1) / leaf_size);
+            for (ulong t = 0; t < leaves.size(); ++t)
+            {
+                leaves[t] = first;
+                if (t + 1 < leaves.size())
+                    std::advance(first, leaf_size);
+            }
+            return leaves;
+        }
+
+        /*
+         * 按顺序规约叶子块[first, first + n)，n > 0，只要求op满足结合律
+         * 随机访问迭代器上分为4段同时推进，4个累加器之间没有依赖，最后按段的顺序合并
+         */
+        template<typename T, typename Iterator, typename BinaryOperation, typename UnaryOperation>
+        T reduce_leaf(Iterator first, ulong n, BinaryOperation& op, UnaryOperation& transform)
+        {
+            if constexpr (is_random_access_iterator<Iterator> || std::random_access_iterator<Iterator>)
+            {
+                if (n >= 8)
+                {
+                    const ulong q = n / 4;
+                    const Iterator p0 = first, p1 = first + q, p2 = first + 2 * q, p3 = first + 3 * q;
+                    T acc0 = transform(p0[0]), acc1 = transform(p1[0]), acc2 = transform(p2[0]), acc3 = transform(p3[0]);
+                    for (ulong i = 1; i < q; ++i)
+                    {
+                        acc0 = op(bitstl::move(acc0), transform(p0[i]));
+                        acc1 = op(bitstl::move(acc1), transform(p1[i]));
+                        acc2 = op(bitstl::move(acc2), transform(p2[i]));
+                        acc3 = op(bitstl::move(acc3), transform(p3[i]));
+                    }
+                    for (ulong i = 4 * q; i < n; ++i)
+                        acc3 = op(bitstl::move(acc3), transform(first[i]));
+                    return op(op(bitstl::move(acc0), bitstl::move(acc1)), op(bitstl::move(acc2), bitstl::move(acc3)));
+                }
+            }
+            T acc = transform(*first);
+            for (ulong i = 1; i < n; ++i)
+                acc = op(bitstl::move(acc), transform(*++first));
+            return acc;
+        }
+
+        /*
+         * 在pool中以leaf(t)规约各叶子块（线程动态领取），再按固定形状的二叉树合并：
+         * 第k层将下标为i、i + 2^k（i为2^(k+1)的倍数）的结果合并到i
+         * 每次合并的操作数只取决于叶子块数，结果与线程数、调度顺序无关，浮点数的结果逐位相同
+         */
+        template<typename T, typename Leaf, typename Combine>
+        T reduce_tree(thread_pool& pool, ulong leaf_num, Leaf leaf, Combine combine)
+        {
+            std::vector<std::optional<T>> partials(leaf_num);
+            if (leaf_num == 1)
+                partials[0].emplace(leaf(0));
+            else
+            {
+                std::atomic<ulong> next(0);
+                auto process = [&](ulong)
+                    {
+                        for (ulong t; (t = next.fetch_add(1, std::memory_order_relaxed)) < leaf_num;)
+                            partials[t].emplace(leaf(t));
+                    };
+                run_paral(pool, std::min(static_cast<ulong>(pool.concurrency()), leaf_num), process);
+            }
+
+            for (ulong width = 1; width < leaf_num; width *= 2)
+                for (ulong i = 0; i + width < leaf_num; i += 2 * width)
+                    *partials[i] = combine(bitstl::move(*partials[i]), bitstl::move(*partials[i + width]));
+            return bitstl::move(*partials[0]);
+        }
+    }
+
+    /*
+     * 可复现的并行规约，返回reduce(init, transform(first[0]), ..., transform(first[n - 1]))
+     * reduce只需满足结合律；区间按固定大小分块，块内按顺序规约，块间按固定形状的二叉树合并，结果与线程数无关
+     * reduce为compensated_plus时以补偿求和累加浮点数，块间同样合并和与误差
+     */
+    template<typename Iterator, typename T, typename BinaryOperation, typename UnaryOperation>
+    T transform_reduce_paral(thread_pool& pool, Iterator first, Iterator last, T init, BinaryOperation reduce, UnaryOperation transform)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return init;
+
+        const std::vector<Iterator> leaves = reduce_detail::get_leaves(first, data_length);
+        auto leaf_length = [&](ulong t) { return std::min(reduce_detail::leaf_size, data_length - t * reduce_detail::leaf_size); };
+
+        if constexpr (is_same_v<BinaryOperation, compensated_plus>)
+        {
+            static_assert(std::is_floating_point_v<T>, "compensated_plus requires a floating-point result type");
+            using accumulator = reduce_detail::compensated<T>;
+            auto leaf = [&](ulong t)
+                {
+                    Iterator it = leaves[t];
+                    accumulator acc{ static_cast<T>(transform(*it)), T() };
+                    for (ulong i = 1, n = leaf_length(t); i < n; ++i)
+                        acc.add(static_cast<T>(transform(*++it)));
+                    return acc;
+                };
+            auto combine = [](accumulator lhs, const accumulator& rhs) { return lhs += rhs; };
+            accumulator result{ init, T() };
+            result += reduce_detail::reduce_tree<accumulator>(pool, static_cast<ulong>(leaves.size()), leaf, combine);
+            return result.value();
+        }
+        else
+        {
+            auto leaf = [&](ulong t) { return reduce_detail::reduce_leaf<T>(leaves[t], leaf_length(t), reduce, transform); };
+            return reduce(bitstl::move(init), reduce_detail::reduce_tree<T>(pool, static_cast<ulong>(leaves.size()), leaf, reduce));
+        }
+    }
+
+    template<typename Iterator, typename T, typename BinaryOperation, typename UnaryOperation>
+    T transform_reduce_paral(Iterator first, Iterator last, T init, BinaryOperation reduce, UnaryOperation transform)
+    {
+        return transform_reduce_paral(thread_pool::default_pool(), first, last, bitstl::move(init), reduce, transform);
+    }
+
+    template<typename Iterator, typename T, typename BinaryOperation>
+    T reduce_paral(thread_pool& pool, Iterator first, Iterator last, T init, BinaryOperation op)
+    {
+        return transform_reduce_paral(pool, first, last, bitstl::move(init), op, reduce_detail::identity());
+    }
+
+    template<typename Iterator, typename T>
+    T reduce_paral(thread_pool& pool, Iterator first, Iterator last, T init)
+    {
+        return reduce_paral(pool, first, last, bitstl::move(init), std::plus<>());
+    }
+
+    template<typename Iterator, typename T, typename BinaryOperation>
+    T reduce_paral(Iterator first, Iterator last, T init, BinaryOperation op)
+    {
+        return reduce_paral(thread_pool::default_pool(), first, last, bitstl::move(init), op);
+    }
+
+    template<typename Iterator, typename T>
+    T reduce_paral(Iterator first, Iterator last, T init)
+    {
+        return reduce_paral(thread_pool::default_pool(), first, last, bitstl::move(init));
+    }
+
+    template<typename T, typename Comp>
+    struct sorter;
+
+    template<typename T, typename Comp>
+    std::list<T> quick_sort_paral(const std::list<T>& input, Comp comp)
+    {
+        if (input.empty())
+            return input;
+        static sorter<T, Comp> s;
+        return s.sort(input, comp);
+    }
+
+    /*
+     * quick_sort_paral的工作线程
+     * 没有待排序的块时先自旋spin_count次，再在条件变量上阻塞，直到有块压栈时才被唤醒
+     * 阻塞超过idle_timeout仍没有新块时线程退出，下次调用sort时按需重新创建，空闲时不占用CPU
+     */
+    template<typename T, typename Comp>
+    struct sorter
+    {
+        struct chunk_to_sort
+        {
+            std::list<T> data;
+            std::promise<std::list<T>> promise;
+
+            chunk_to_sort() = default;
+            // promise仅可移动
+            chunk_to_sort(chunk_to_sort&& other) : data(std::move(other.data)), promise(std::move(other.promise)) {}
+        };
+        stack_ts<chunk_to_sort> chunks;
+
+        struct worker
+        {
+            std::thread thread;
+            std::atomic_bool exited{ false };
+        };
+        std::vector<std::unique_ptr<worker>> workers;
+        std::mutex workers_mtx;  // 保护workers
+
+        static constexpr int spin_count = 64;
+        static constexpr std::chrono::milliseconds idle_timeout{ 200 };
+
+        std::mutex mtx;
+        std::condition_variable cond;
+        std::atomic<ulong> pending;   // 已压栈而未被取走的块数
+        std::atomic<ulong> sleeping;  // 阻塞中的线程数
+
+        const uint max_thread_count;
+        std::atomic_bool end;
+        Comp comp;
+
+        sorter() : pending(0), sleeping(0), max_thread_count(std::thread::hardware_concurrency()),
+            end(false) {}
+
+        ~sorter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                end.store(true);
+            }
+            cond.notify_all();
+            for (auto& w : workers)
+                w->thread.join();
+        }
+
+        void thread_work(worker* self)
+        {
+            int idle = 0;
+            while (!end.load())
+            {
+                if (try_sort_chunk())
+                    idle = 0;
+                else if (++idle < spin_count)
+                    std::this_thread::yield();
+                else if (!park())
+                    break;
+                else
+                    idle = 0;
+            }
+            self->exited.store(true);
+        }
+
+        // 阻塞至有新块或结束，超时仍无新块时返回false
+        bool park()
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            ++sleeping;
+            // 与push_chunk构成Dekker式同步：要么此处看到pending，要么push_chunk看到sleeping
+            const bool woken = cond.wait_for(lock, idle_timeout, [this]() { return pending.load() > 0 || end.load(); });
+            --sleeping;
+            return woken;
+        }
+
+        void push_chunk(chunk_to_sort&& chunk)
+        {
+            // 先计数再压栈，被取走时pending不会小于0
+            ++pending;
+            try
+            {
+                chunks.push(std::move(chunk));
+            }
+            catch (...)
+            {
+                --pending;
+                throw;
+            }
+            if (sleeping.load())
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                cond.notify_one();
+            }
+        }
+
+        bool try_sort_chunk()
+        {
+            if (!pending.load())
+                return false;
+            std::shared_ptr<chunk_to_sort> chunk = chunks.pop();
+            if (!chunk)
+                return false;
+            --pending;
+            try
+            {
+                chunk->promise.set_value(*do_sort(std::make_unique<std::list<T>>(std::move(chunk->data))));
+            }
+            catch (...)
+            {
+                chunk->promise.set_exception(std::current_exception());
+            }
+            return true;
+        }
+
+        // 回收已退出的线程并补足工作线程
+        // 若在do_sort中动态增加thread会导致同时有多个thread并发向threads中增加thread，造成不能百分百复现的访问冲突
+        void start_workers()
+        {
+            std::lock_guard<std::mutex> lock(workers_mtx);
+            for (auto it = workers.begin(); it != workers.end();)
+            {
+                if ((*it)->exited.load())
+                {
+                    (*it)->thread.join();
+                    it = workers.erase(it);
+                }
+                else
+                    ++it;
+            }
+            while (workers.size() + 1 < max_thread_count)
+            {
+                workers.push_back(std::make_unique<worker>());
+                workers.back()->thread = std::thread(&sorter<T, Comp>::thread_work, this, workers.back().get());
+            }
+        }
+
+        std::list<T> sort(std::list<T> chunk_data, Comp _comp)
+        {
+            comp = _comp;
+            start_workers();
+            return *do_sort(std::make_unique<std::list<T>>(std::move(chunk_data)));
+        }
+
+        // 递归太深会导致stack overflow
+        std::unique_ptr<std::list<T>> do_sort(std::unique_ptr<std::list<T>> chunk_data)
+        {
+            if (chunk_data->empty() || chunk_data->size() == 1)
+                return std::move(chunk_data);
+
+            std::unique_ptr<std::list<T>> result = std::make_unique<std::list<T>>();
+
+            // 取第一个值作为划分轴
+            result->splice(result->begin(), *chunk_data, chunk_data->begin());
+            const T& partition_val = *(result->begin());
+            typename std::list<T>::iterator pivot =
+                std::partition(chunk_data->begin(), chunk_data->end(),
+                    [&](const T& v) {return comp(v, partition_val); });
+
+            chunk_to_sort new_lower_chunk;
+            new_lower_chunk.data.splice(new_lower_chunk.data.end(), *chunk_data, chunk_data->begin(), pivot);
+
+            std::future<std::list<T>> new_lower = new_lower_chunk.promise.get_future();
+
+            push_chunk(std::move(new_lower_chunk));
+
+            // 当前线程对后半排序
+            std::list<T> new_higher(*do_sort(std::move(chunk_data)));
+            result->splice(result->end(), new_higher);
+
+            // 其它线程对前半排序，期间帮助排序其它块；没有可做的块时短暂阻塞在future上
+            int idle = 0;
+            while (new_lower.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                if (try_sort_chunk())
+                    idle = 0;
+                else if (++idle < spin_count)
+                    std::this_thread::yield();
+                else
+                    new_lower.wait_for(std::chrono::microseconds(100));
+            }
+
+            result->splice(result->begin(), new_lower.get());
+
+            return std::move(result);
+        }
+    };
+
+    namespace search_detail
+    {
+        // 每查找一段才检查一次能否提前结束，避免每个元素都读取共享的原子变量
+        inline constexpr ulong block_size = 4096;
+
+        /*
+         * 在first开始的data_length个位置中查找，find_block(begin, end)返回[begin, end)中的结果，未找到时返回end
+         * Leftmost为true时返回最靠前的结果：found记录已知结果的最小下标，某块的当前位置已在found之后时才停止，
+         * 之前的块继续查找；块只在其左侧存在结果时停止，因此最靠前的非空结果即为整体最靠前的结果
+         * Leftmost为false时任一块找到后其它块都停止，用于只需判断是否存在的any_of等
+         * 未找到时返回not_found
+         */
+        template<bool Leftmost, typename Iterator, typename FindBlock>
+        Iterator find_first(thread_pool& pool, Iterator first, Iterator last, ulong data_length, Iterator not_found, FindBlock find_block)
+        {
+            if (!data_length)
+                return not_found;
+
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+            std::vector<std::optional<Iterator>> results(thread_num);
+            std::atomic<ulong> found(data_length);
+            auto process = [&](ulong t)
+                {
+                    Iterator begin = bounds[t];
+                    ulong index = t * data_per_thread;
+                    ulong remaining = std::distance(begin, bounds[t + 1]);
+                    while (remaining)
+                    {
+                        const ulong known = found.load(std::memory_order_relaxed);
+                        if (Leftmost ? known < index : known != data_length)
+                            return;
+                        const ulong n = std::min(remaining, block_size);
+                        Iterator block_end = begin;
+                        std::advance(block_end, n);
+                        Iterator result = find_block(begin, block_end);
+                        if (result != block_end)
+                        {
+                            results[t] = result;
+                            const ulong i = index + static_cast<ulong>(std::distance(begin, result));
+                            ulong current = found.load();
+                            while (i < current && !found.compare_exchange_weak(current, i));
+                            return;
+                        }
+                        begin = block_end;
+                        index += n;
+                        remaining -= n;
+                    }
+                };
+            run_paral(pool, thread_num, process);
+
+            for (const auto& result : results)
+                if (result)
+                    return *result;
+            return not_found;
+        }
+    }
+
+    // 返回first至last中首个满足pred的元素，不存在时返回last
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator find_if_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return search_detail::find_first<true>(pool, first, last, std::distance(first, last), last,
+            [&pred](Iterator begin, Iterator end) { return bitstl::find_if(begin, end, pred); });
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator find_if_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return find_if_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    // 返回first至last中首个等于match的元素，不存在时返回last；每段以bitstl::find（连续内存上为向量内核）查找
+    template<typename Iterator, typename MatchType>
+    Iterator find_paral(thread_pool& pool, Iterator first, Iterator last, MatchType match)
+    {
+        return search_detail::find_first<true>(pool, first, last, std::distance(first, last), last,
+            [&match](Iterator begin, Iterator end) { return bitstl::find(begin, end, match); });
+    }
+
+    template<typename Iterator, typename MatchType>
+    Iterator find_paral(Iterator first, Iterator last, MatchType match)
+    {
+        return find_paral(thread_pool::default_pool(), first, last, match);
+    }
+
+    // 返回first至last中首个与s_first至s_last中任一元素满足pred的元素，不存在时返回last
+    template<typename Iterator, typename SearchIterator, typename BinaryPredicate>
+    Iterator find_first_of_paral(thread_pool& pool, Iterator first, Iterator last,
+        SearchIterator s_first, SearchIterator s_last, BinaryPredicate pred)
+    {
+        return find_if_paral(pool, first, last, [&](const auto& x)
+            {
+                for (SearchIterator it = s_first; it != s_last; ++it)
+                    if (pred(x, *it))
+                        return true;
+                return false;
+            });
+    }
+
+    template<typename Iterator, typename SearchIterator>
+    Iterator find_first_of_paral(thread_pool& pool, Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last)
+    {
+        return find_first_of_paral(pool, first, last, s_first, s_last, std::equal_to<>());
+    }
+
+    template<typename Iterator, typename SearchIterator, typename BinaryPredicate>
+    Iterator find_first_of_paral(Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last, BinaryPredicate pred)
+    {
+        return find_first_of_paral(thread_pool::default_pool(), first, last, s_first, s_last, pred);
+    }
+
+    template<typename Iterator, typename SearchIterator>
+    Iterator find_first_of_paral(Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last)
+    {
+        return find_first_of_paral(thread_pool::default_pool(), first, last, s_first, s_last);
+    }
+
+    // 是否存在满足pred的元素，任一线程找到后其它线程即停止
+    template<typename Iterator, typename UnaryPredicate>
+    bool any_of_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return search_detail::find_first<false>(pool, first, last, std::distance(first, last), last,
+            [&pred](Iterator begin, Iterator end) { return bitstl::find_if(begin, end, pred); }) != last;
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    bool any_of_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return any_of_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    bool none_of_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return !any_of_paral(pool, first, last, pred);
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    bool none_of_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return none_of_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    bool all_of_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return !any_of_paral(pool, first, last, [&pred](const auto& x) { return !pred(x); });
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    bool all_of_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return all_of_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    /*
+     * 返回first至last中首次出现s_first至s_last的位置，不存在时返回last，子序列为空时返回first
+     * 在可能的起点上划分，每段以bitstl::search在[段首, 段尾 + 子序列长度 - 1)中查找
+     */
+    template<typename Iterator, typename SearchIterator, typename BinaryPredicate>
+    Iterator search_paral(thread_pool& pool, Iterator first, Iterator last,
+        SearchIterator s_first, SearchIterator s_last, BinaryPredicate pred)
+    {
+        const ulong data_length = std::distance(first, last);
+        const ulong pattern_length = std::distance(s_first, s_last);
+        if (!pattern_length)
+            return first;
+        if (pattern_length > data_length)
+            return last;
+
+        const ulong start_num = data_length - pattern_length + 1;
+        Iterator starts_last = first;
+        std::advance(starts_last, start_num);
+        return search_detail::find_first<true>(pool, first, starts_last, start_num, last,
+            [&](Iterator begin, Iterator end)
+            {
+                Iterator window_end = end;
+                std::advance(window_end, pattern_length - 1);
+                Iterator result = bitstl::search(begin, window_end, s_first, s_last, pred);
+                return result == window_end ? end : result;
+            });
+    }
+
+    template<typename Iterator, typename SearchIterator>
+    Iterator search_paral(thread_pool& pool, Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last)
+    {
+        return search_paral(pool, first, last, s_first, s_last, std::equal_to<>());
+    }
+
+    template<typename Iterator, typename SearchIterator, typename BinaryPredicate>
+    Iterator search_paral(Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last, BinaryPredicate pred)
+    {
+        return search_paral(thread_pool::default_pool(), first, last, s_first, s_last, pred);
+    }
+
+    template<typename Iterator, typename SearchIterator>
+    Iterator search_paral(Iterator first, Iterator last, SearchIterator s_first, SearchIterator s_last)
+    {
+        return search_paral(thread_pool::default_pool(), first, last, s_first, s_last);
+    }
+
+    namespace scan_detail
+    {
+        /*
+         * 分块的两遍前缀和（reduce-then-scan）
+         * 第一遍各线程按顺序规约自己的分块（最后一块不需要），第二遍前由当前线程对各块的和求前缀和，
+         * 得到每块之前所有元素的规约结果offsets[t]，第二遍各线程以offsets[t]为初值扫描自己的分块并写入输出
+         * 每个元素读两次、写一次，总运算量约为串行的两倍，与线程数无关；op只需满足结合律
+         * scan_block(t, begin, end, d_begin, offset)扫描第t块，offset为空表示该块之前没有元素且没有初值
+         */
+        template<typename Iterator, typename OutputIterator, typename T, typename BinaryOperation, typename ScanBlock>
+        OutputIterator scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first,
+            std::optional<T> init, BinaryOperation op, ScanBlock scan_block)
+        {
+            const ulong data_length = std::distance(first, last);
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+            const std::vector<OutputIterator> d_bounds = get_matching_bounds(bounds, d_first);
+
+            std::vector<std::optional<T>> sums(thread_num);
+            auto reduce_block = [&](ulong t)
+                {
+                    if (t + 1 == thread_num)
+                        return;
+                    Iterator begin = bounds[t];
+                    T sum = *begin;
+                    sums[t].emplace(bitstl::accumulate(++begin, bounds[t + 1], bitstl::move(sum), op));
+                };
+            run_paral(pool, thread_num, reduce_block);
+
+            std::vector<std::optional<T>> offsets(thread_num);
+            offsets[0] = bitstl::move(init);
+            for (ulong t = 1; t < thread_num; ++t)
+            {
+                if (offsets[t - 1])
+                    offsets[t].emplace(op(*offsets[t - 1], bitstl::move(*sums[t - 1])));
+                else
+                    offsets[t] = bitstl::move(sums[t - 1]);
+            }
+
+            OutputIterator d_last = d_first;
+            auto scan_block_at = [&](ulong t)
+                {
+                    OutputIterator end = scan_block(bounds[t], bounds[t + 1], d_bounds[t], offsets[t]);
+                    if (t + 1 == thread_num)
+                        d_last = end;
+                };
+            run_paral(pool, thread_num, scan_block_at);
+            return d_last;
+        }
+
+        // 数据量较小时线程同步的开销超过收益
+        inline constexpr ulong min_length = 1ul << 15;
+    }
+
+    /*
+     * 并行inclusive_scan，d_first[i] = op(init, first[0], ..., first[i])
+     * 输出区间可以与输入区间相同；op须满足结合律，不要求交换律
+     */
+    template<typename Iterator, typename OutputIterator, typename BinaryOperation, typename T>
+    OutputIterator inclusive_scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first,
+        BinaryOperation op, T init)
+    {
+        if (static_cast<ulong>(std::distance(first, last)) < scan_detail::min_length)
+            return bitstl::inclusive_scan(first, last, d_first, op, bitstl::move(init));
+
+        return scan_detail::scan_paral(pool, first, last, d_first, std::optional<T>(bitstl::move(init)), op,
+            [&op](Iterator begin, Iterator end, OutputIterator d_begin, std::optional<T>& offset)
+            {
+                return bitstl::inclusive_scan(begin, end, d_begin, op, bitstl::move(*offset));
+            });
+    }
+
+    template<typename Iterator, typename OutputIterator, typename BinaryOperation>
+    OutputIterator inclusive_scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, BinaryOperation op)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+
+        if (static_cast<ulong>(std::distance(first, last)) < scan_detail::min_length)
+            return bitstl::inclusive_scan(first, last, d_first, op);
+
+        return scan_detail::scan_paral(pool, first, last, d_first, std::optional<value_type>(), op,
+            [&op](Iterator begin, Iterator end, OutputIterator d_begin, std::optional<value_type>& offset)
+            {
+                if (offset)
+                    return bitstl::inclusive_scan(begin, end, d_begin, op, bitstl::move(*offset));
+                return bitstl::inclusive_scan(begin, end, d_begin, op);
+            });
+    }
+
+    template<typename Iterator, typename OutputIterator>
+    OutputIterator inclusive_scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first)
+    {
+        return inclusive_scan_paral(pool, first, last, d_first, std::plus<>());
+    }
+
+    template<typename Iterator, typename OutputIterator, typename BinaryOperation, typename T>
+    OutputIterator inclusive_scan_paral(Iterator first, Iterator last, OutputIterator d_first, BinaryOperation op, T init)
+    {
+        return inclusive_scan_paral(thread_pool::default_pool(), first, last, d_first, op, bitstl::move(init));
+    }
+
+    template<typename Iterator, typename OutputIterator, typename BinaryOperation>
+    OutputIterator inclusive_scan_paral(Iterator first, Iterator last, OutputIterator d_first, BinaryOperation op)
+    {
+        return inclusive_scan_paral(thread_pool::default_pool(), first, last, d_first, op);
+    }
+
+    template<typename Iterator, typename OutputIterator>
+    OutputIterator inclusive_scan_paral(Iterator first, Iterator last, OutputIterator d_first)
+    {
+        return inclusive_scan_paral(thread_pool::default_pool(), first, last, d_first);
+    }
+
+    // 并行exclusive_scan，d_first[i] = op(init, first[0], ..., first[i - 1])
+    template<typename Iterator, typename OutputIterator, typename T, typename BinaryOperation>
+    OutputIterator exclusive_scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first,
+        T init, BinaryOperation op)
+    {
+        if (static_cast<ulong>(std::distance(first, last)) < scan_detail::min_length)
+            return bitstl::exclusive_scan(first, last, d_first, bitstl::move(init), op);
+
+        return scan_detail::scan_paral(pool, first, last, d_first, std::optional<T>(bitstl::move(init)), op,
+            [&op](Iterator begin, Iterator end, OutputIterator d_begin, std::optional<T>& offset)
+            {
+                return bitstl::exclusive_scan(begin, end, d_begin, bitstl::move(*offset), op);
+            });
+    }
+
+    template<typename Iterator, typename OutputIterator, typename T>
+    OutputIterator exclusive_scan_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, T init)
+    {
+        return exclusive_scan_paral(pool, first, last, d_first, bitstl::move(init), std::plus<>());
+    }
+
+    template<typename Iterator, typename OutputIterator, typename T, typename BinaryOperation>
+    OutputIterator exclusive_scan_paral(Iterator first, Iterator last, OutputIterator d_first, T init, BinaryOperation op)
+    {
+        return exclusive_scan_paral(thread_pool::default_pool(), first, last, d_first, bitstl::move(init), op);
+    }
+
+    template<typename Iterator, typename OutputIterator, typename T>
+    OutputIterator exclusive_scan_paral(Iterator first, Iterator last, OutputIterator d_first, T init)
+    {
+        return exclusive_scan_paral(thread_pool::default_pool(), first, last, d_first, bitstl::move(init));
+    }
+
+    // 原地计算前缀和
+    template<typename Iterator>
+    void partial_sum_paral(thread_pool& pool, Iterator first, Iterator last)
+    {
+        inclusive_scan_paral(pool, first, last, first, std::plus<>());
+    }
+
+    template<typename Iterator>
+    void partial_sum_paral(Iterator first, Iterator last)
+    {
+        partial_sum_paral(thread_pool::default_pool(), first, last);
+    }
+
+    /*
+     * 并行transform，结果写入以d_first开始的区间，返回输出区间的尾后位置
+     * 所有迭代器都支持随机访问时以partitioner划分（默认为auto_partitioner），否则按get_partition等分
+     */
+    template<typename Iterator, typename OutputIterator, typename UnaryOperation,
+        typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    OutputIterator transform_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op,
+        Partitioner&& partitioner)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return d_first;
+
+        if constexpr (partition_detail::is_random_access_v<Iterator> && partition_detail::is_random_access_v<OutputIterator>)
+        {
+            auto body = [&](std::size_t begin, std::size_t end)
+                {
+                    bitstl::transform(first + begin, first + end, d_first + begin, op);
+                };
+            partitioner.run(pool, data_length, body);
+            return d_first + data_length;
+        }
+        else
+        {
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+            const std::vector<OutputIterator> d_bounds = get_matching_bounds(bounds, d_first);
+
+            OutputIterator d_last = d_first;
+            auto process = [&](ulong t)
+                {
+                    OutputIterator end = bitstl::transform(bounds[t], bounds[t + 1], d_bounds[t], op);
+                    if (t + 1 == thread_num)
+                        d_last = end;
+                };
+            run_paral(pool, thread_num, process);
+            return d_last;
+        }
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename BinaryOperation,
+        typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    OutputIterator transform_paral(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2,
+        OutputIterator d_first, BinaryOperation op, Partitioner&& partitioner)
+    {
+        const ulong data_length = std::distance(first1, last1);
+        if (!data_length)
+            return d_first;
+
+        if constexpr (partition_detail::is_random_access_v<Iterator1> && partition_detail::is_random_access_v<Iterator2>
+            && partition_detail::is_random_access_v<OutputIterator>)
+        {
+            auto body = [&](std::size_t begin, std::size_t end)
+                {
+                    bitstl::transform(first1 + begin, first1 + end, first2 + begin, d_first + begin, op);
+                };
+            partitioner.run(pool, data_length, body);
+            return d_first + data_length;
+        }
+        else
+        {
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            const std::vector<Iterator1> bounds = get_bounds(first1, last1, thread_num, data_per_thread);
+            const std::vector<Iterator2> bounds2 = get_matching_bounds(bounds, first2);
+            const std::vector<OutputIterator> d_bounds = get_matching_bounds(bounds, d_first);
+
+            OutputIterator d_last = d_first;
+            auto process = [&](ulong t)
+                {
+                    OutputIterator end = bitstl::transform(bounds[t], bounds[t + 1], bounds2[t], d_bounds[t], op);
+                    if (t + 1 == thread_num)
+                        d_last = end;
+                };
+            run_paral(pool, thread_num, process);
+            return d_last;
+        }
+    }
+
+    template<typename Iterator, typename OutputIterator, typename UnaryOperation>
+    OutputIterator transform_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op)
+    {
+        return transform_paral(pool, first, last, d_first, op, auto_partitioner());
+    }
+
+    // 第五个参数为划分器时是带划分器的一元版本
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename BinaryOperation,
+        partition_detail::disable_if_partitioner_t<BinaryOperation> = 0>
+    OutputIterator transform_paral(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2,
+        OutputIterator d_first, BinaryOperation op)
+    {
+        return transform_paral(pool, first1, last1, first2, d_first, op, auto_partitioner());
+    }
+
+    template<typename Iterator, typename OutputIterator, typename UnaryOperation,
+        typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    OutputIterator transform_paral(Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op, Partitioner&& partitioner)
+    {
+        return transform_paral(thread_pool::default_pool(), first, last, d_first, op, partitioner);
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename BinaryOperation,
+        typename Partitioner, partition_detail::enable_if_partitioner_t<Partitioner> = 0>
+    OutputIterator transform_paral(Iterator1 first1, Iterator1 last1, Iterator2 first2, OutputIterator d_first, BinaryOperation op,
+        Partitioner&& partitioner)
+    {
+        return transform_paral(thread_pool::default_pool(), first1, last1, first2, d_first, op, partitioner);
+    }
+
+    template<typename Iterator, typename OutputIterator, typename UnaryOperation>
+    OutputIterator transform_paral(Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op)
+    {
+        return transform_paral(thread_pool::default_pool(), first, last, d_first, op);
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename BinaryOperation,
+        partition_detail::disable_if_partitioner_t<BinaryOperation> = 0>
+    OutputIterator transform_paral(Iterator1 first1, Iterator1 last1, Iterator2 first2, OutputIterator d_first, BinaryOperation op)
+    {
+        return transform_paral(thread_pool::default_pool(), first1, last1, first2, d_first, op);
+    }
+
+    /*
+     * 保持顺序的并行过滤
+     * 第一遍各线程以pred标记自己分块中的元素并计数，各块的计数求exclusive scan得到各块的输出位置，
+     * 第二遍各线程把自己分块中选中的元素写到对应位置，写入区间互不重叠，无需加锁；pred对每个元素只调用一次
+     * 原地的remove_if_paral、partition_paral先将元素移入暂存区的对应位置，再并行移回原区间
+     */
+    namespace filter_detail
+    {
+        // 数据量较小时只划分一块，在当前线程完成
+        inline constexpr ulong min_length = 1ul << 15;
+
+        inline void get_partition(thread_pool& pool, const ulong data_length, ulong& thread_num, ulong& data_per_thread)
+        {
+            if (data_length < min_length)
+            {
+                thread_num = 1;
+                data_per_thread = data_length;
+            }
+            else
+                bitstl::get_partition(pool, data_length, thread_num, data_per_thread);
+        }
+
+        // flags[i]记录第i个元素是否满足pred，返回各块中满足pred的元素数
+        template<typename Iterator, typename UnaryPredicate>
+        std::vector<ulong> mark(thread_pool& pool, const std::vector<Iterator>& bounds, ulong data_per_thread,
+            bool* flags, UnaryPredicate& pred)
+        {
+            const ulong thread_num = static_cast<ulong>(bounds.size() - 1);
+            std::vector<ulong> counts(thread_num);
+            auto process = [&](ulong t)
+                {
+                    bool* flag = flags + t * data_per_thread;
+                    ulong count = 0;
+                    for (Iterator it = bounds[t]; it != bounds[t + 1]; ++it, ++flag)
+                    {
+                        *flag = static_cast<bool>(pred(*it));
+                        count += *flag;
+                    }
+                    counts[t] = count;
+                };
+            run_paral(pool, thread_num, process);
+            return counts;
+        }
+
+        // counts的exclusive scan，offsets[t]为第t块的输出位置，末尾为总数
+        inline std::vector<ulong> get_offsets(const std::vector<ulong>& counts, ulong init = 0)
+        {
+            std::vector<ulong> offsets(counts.size() + 1);
+            offsets[0] = init;
+            bitstl::inclusive_scan(counts.begin(), counts.end(), offsets.begin() + 1, std::plus<>(), init);
+            return offsets;
+        }
+
+        // 暂存区，由若干互不重叠的段组成，各线程在自己的段中依次构造元素，析构时只销毁已构造的元素
+        template<typename T>
+        class segment_buffer
+        {
+        public:
+            segment_buffer(std::vector<ulong> segment_first, ulong size)
+                : segment_first_(bitstl::move(segment_first)), constructed_(segment_first_.size(), 0), size_(size)
+            {
+                data_ = alloc_.allocate(size_);
+            }
+
+            segment_buffer(const segment_buffer&) = delete;
+            segment_buffer& operator=(const segment_buffer&) = delete;
+
+            ~segment_buffer()
+            {
+                for (std::size_t s = 0; s < segment_first_.size(); ++s)
+                    for (ulong i = 0; i < constructed_[s]; ++i)
+                        (data_ + segment_first_[s] + i)->~T();
+                alloc_.deallocate(data_, size_);
+            }
+
+            // 将first至last中flags[i] == flag的元素依次移入第s段，只由一个线程调用
+            template<typename Iterator>
+            void move_in(std::size_t s, Iterator first, Iterator last, const bool* flags, bool flag)
+            {
+                T* dest = data_ + segment_first_[s];
+                ulong count = 0;
+                try
+                {
+                    for (; first != last; ++first, ++flags)
+                    {
+                        if (*flags == flag)
+                        {
+                            ::new (static_cast<void*>(dest + count)) T(bitstl::move(*first));
+                            ++count;
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    constructed_[s] = count;
+                    throw;
+                }
+                constructed_[s] = count;
+            }
+
+            T* data()
+                const noexcept
+            {
+                return data_;
+            }
+
+        private:
+            allocator<T> alloc_;
+            std::vector<ulong> segment_first_;
+            std::vector<ulong> constructed_;
+            T* data_ = nullptr;
+            ulong size_ = 0;
+        };
+
+        // 将暂存区的size个元素并行移回first开始的区间
+        template<typename T, typename Iterator>
+        void move_back(thread_pool& pool, T* data, ulong size, Iterator first)
+        {
+            if (!size)
+                return;
+            ulong thread_num = 0, data_per_thread = 0;
+            filter_detail::get_partition(pool, size, thread_num, data_per_thread);
+            const std::vector<T*> bounds = get_bounds(data, data + size, thread_num, data_per_thread);
+            const std::vector<Iterator> d_bounds = get_matching_bounds(bounds, first);
+            auto process = [&](ulong t)
+                {
+                    bitstl::move(bounds[t], bounds[t + 1], d_bounds[t]);
+                };
+            run_paral(pool, thread_num, process);
+        }
+    }
+
+    // 将满足pred的元素按原顺序复制到以d_first开始的区间，返回输出区间的尾后位置，输出迭代器须为前向迭代器
+    template<typename Iterator, typename OutputIterator, typename UnaryPredicate>
+    OutputIterator copy_if_paral(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, UnaryPredicate pred)
+    {
+        const ulong data_length = std::distance(first, last);
+        if (data_length < filter_detail::min_length)
+            return bitstl::copy_if(first, last, d_first, pred);
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+        const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+        std::unique_ptr<bool[]> flags(new bool[data_length]);
+        const std::vector<ulong> offsets = filter_detail::get_offsets(filter_detail::mark(pool, bounds, data_per_thread, flags.get(), pred));
+
+        std::vector<OutputIterator> d_bounds(thread_num + 1);
+        d_bounds[0] = d_first;
+        for (ulong t = 0; t < thread_num; ++t)
+        {
+            d_bounds[t + 1] = d_bounds[t];
+            std::advance(d_bounds[t + 1], offsets[t + 1] - offsets[t]);
+        }
+
+        auto process = [&](ulong t)
+            {
+                const bool* flag = flags.get() + t * data_per_thread;
+                OutputIterator out = d_bounds[t];
+                for (Iterator it = bounds[t]; it != bounds[t + 1]; ++it, ++flag)
+                {
+                    if (*flag)
+                    {
+                        *out = *it;
+                        ++out;
+                    }
+                }
+            };
+        run_paral(pool, thread_num, process);
+        return d_bounds[thread_num];
+    }
+
+    template<typename Iterator, typename OutputIterator, typename UnaryPredicate>
+    OutputIterator copy_if_paral(Iterator first, Iterator last, OutputIterator d_first, UnaryPredicate pred)
+    {
+        return copy_if_paral(thread_pool::default_pool(), first, last, d_first, pred);
+    }
+
+    // 移除满足pred的元素，其余元素保持原顺序移到区间前部，返回新的尾后位置
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator remove_if_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+
+        const ulong data_length = std::distance(first, last);
+        if (data_length < filter_detail::min_length)
+            return bitstl::remove_if(first, last, pred);
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+        const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+        std::unique_ptr<bool[]> flags(new bool[data_length]);
+        std::vector<ulong> counts = filter_detail::mark(pool, bounds, data_per_thread, flags.get(), pred);
+        for (ulong t = 0; t < thread_num; ++t)
+            counts[t] = static_cast<ulong>(std::distance(bounds[t], bounds[t + 1])) - counts[t];
+        std::vector<ulong> offsets = filter_detail::get_offsets(counts);
+        const ulong kept = offsets.back();
+        if (kept == data_length)
+            return last;
+        offsets.pop_back();
+
+        filter_detail::segment_buffer<value_type> buffer(bitstl::move(offsets), kept);
+        auto process = [&](ulong t)
+            {
+                buffer.move_in(t, bounds[t], bounds[t + 1], flags.get() + t * data_per_thread, false);
+            };
+        run_paral(pool, thread_num, process);
+        filter_detail::move_back(pool, buffer.data(), kept, first);
+
+        std::advance(first, kept);
+        return first;
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator remove_if_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return remove_if_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    // 稳定划分：满足pred的元素移到区间前部，两部分各自保持原顺序，返回第二部分的起点
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator partition_paral(thread_pool& pool, Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+
+        const ulong data_length = std::distance(first, last);
+        if (!data_length)
+            return first;
+
+        ulong thread_num = 0, data_per_thread = 0;
+        filter_detail::get_partition(pool, data_length, thread_num, data_per_thread);
+        const std::vector<Iterator> bounds = get_bounds(first, last, thread_num, data_per_thread);
+
+        std::unique_ptr<bool[]> flags(new bool[data_length]);
+        const std::vector<ulong> true_counts = filter_detail::mark(pool, bounds, data_per_thread, flags.get(), pred);
+        std::vector<ulong> false_counts(thread_num);
+        for (ulong t = 0; t < thread_num; ++t)
+            false_counts[t] = static_cast<ulong>(std::distance(bounds[t], bounds[t + 1])) - true_counts[t];
+        std::vector<ulong> true_offsets = filter_detail::get_offsets(true_counts);
+        const ulong true_num = true_offsets.back();
+        const std::vector<ulong> false_offsets = filter_detail::get_offsets(false_counts, true_num);
+
+        // 第t段为第t块中满足pred的元素，第thread_num + t段为第t块中不满足pred的元素
+        true_offsets.pop_back();
+        true_offsets.insert(true_offsets.end(), false_offsets.begin(), false_offsets.end() - 1);
+        filter_detail::segment_buffer<value_type> buffer(bitstl::move(true_offsets), data_length);
+        auto process = [&](ulong t)
+            {
+                const bool* flag = flags.get() + t * data_per_thread;
+                buffer.move_in(t, bounds[t], bounds[t + 1], flag, true);
+                buffer.move_in(thread_num + t, bounds[t], bounds[t + 1], flag, false);
+            };
+        run_paral(pool, thread_num, process);
+        filter_detail::move_back(pool, buffer.data(), data_length, first);
+
+        std::advance(first, true_num);
+        return first;
+    }
+
+    template<typename Iterator, typename UnaryPredicate>
+    Iterator partition_paral(Iterator first, Iterator last, UnaryPredicate pred)
+    {
+        return partition_paral(thread_pool::default_pool(), first, last, pred);
+    }
+
+    /*
+     * 并行LSD基数排序
+     * 按get_partition将区间划分给各线程，每一轮各线程统计自己分块中当前字节的直方图
+     * 按（数字，线程）的顺序求前缀和得到各线程写入每个数字的起始位置，再并行分发，保持稳定
+     * 键在所有元素中都相同的字节位整轮跳过
+     */
+    template<typename Iterator, typename KeyExtractor, typename Alloc>
+    void radix_sort_paral(thread_pool& pool, Iterator first, Iterator last, KeyExtractor key, const Alloc& alloc)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+        using key_type   = radix_detail::key_t<value_type, KeyExtractor>;
+        static_assert(is_contiguous_iterator<Iterator>, "radix_sort_paral requires contiguous iterators");
+        static_assert(radix_detail::is_radix_key_v<key_type>, "radix_sort_paral requires integral or floating-point keys");
+
+        constexpr ulong passes = sizeof(key_type);
+        constexpr ulong radix = radix_detail::radix;
+        // 数据量较小时线程的创建与同步开销超过收益
+        const ulong min_length = 1ul << 16;
+
+        const ulong data_length = static_cast<ulong>(last - first);
+        if (data_length < min_length)
+        {
+            bitstl::radix_sort(first, last, key, alloc);
+            return;
+        }
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+        auto chunk_first = [&](ulong t) { return t * data_per_thread; };
+        auto chunk_last  = [&](ulong t) { return t == thread_num - 1 ? data_length : (t + 1) * data_per_thread; };
+
+        value_type* data = bitstl::to_address(first);
+        radix_detail::scratch_buffer<value_type, Alloc> buffer(data, data_length, alloc);
+        value_type* src = buffer.holds_data ? buffer.data() : data;
+        value_type* dst = buffer.holds_data ? data : buffer.data();
+
+        // counts[(t * passes + pass) * radix + d]为线程t的分块中第pass个字节为d的元素个数
+        std::vector<ulong> counts(thread_num * passes * radix, 0);
+        auto count_of = [&](ulong t, ulong pass, ulong d) -> ulong& { return counts[(t * passes + pass) * radix + d]; };
+
+        // 首轮统计所有字节位，得到各字节位的全局分布
+        auto count_all = [&](ulong t)
+            {
+                for (ulong i = chunk_first(t); i < chunk_last(t); ++i)
+                {
+                    const auto k = radix_detail::unsigned_key_of(src[i], key);
+                    for (ulong pass = 0; pass < passes; ++pass)
+                        ++count_of(t, pass, (k >> (pass * 8)) & 0xFF);
+                }
+            };
+        run_paral(pool, thread_num, count_all);
+
+        bool counted = true; // counts是否对应当前src的分块
+        for (ulong pass = 0; pass < passes; ++pass)
+        {
+            ulong totals[radix] = {};
+            for (ulong t = 0; t < thread_num; ++t)
+                for (ulong d = 0; d < radix; ++d)
+                    totals[d] += count_of(t, pass, d);
+
+            bool uniform = false;
+            for (ulong d = 0; d < radix; ++d)
+            {
+                if (totals[d])
+                {
+                    uniform = totals[d] == data_length;
+                    break;
+                }
+            }
+            if (uniform)
+                continue;
+
+            const ulong shift = pass * 8;
+            if (!counted)
+            {
+                auto count_pass = [&](ulong t)
+                    {
+                        for (ulong d = 0; d < radix; ++d)
+                            count_of(t, pass, d) = 0;
+                        for (ulong i = chunk_first(t); i < chunk_last(t); ++i)
+                            ++count_of(t, pass, (radix_detail::unsigned_key_of(src[i], key) >> shift) & 0xFF);
+                    };
+                run_paral(pool, thread_num, count_pass);
+            }
+
+            // offsets[t * radix + d]为线程t写入数字d的起始位置
+            std::vector<ulong> offsets(thread_num * radix);
+            ulong sum = 0;
+            for (ulong d = 0; d < radix; ++d)
+            {
+                for (ulong t = 0; t < thread_num; ++t)
+                {
+                    offsets[t * radix + d] = sum;
+                    sum += count_of(t, pass, d);
+                }
+            }
+
+            auto scatter = [&](ulong t)
+                {
+                    ulong* offset = offsets.data() + t * radix;
+                    for (ulong i = chunk_first(t); i < chunk_last(t); ++i)
+                    {
+                        const ulong d = (radix_detail::unsigned_key_of(src[i], key) >> shift) & 0xFF;
+                        dst[offset[d]++] = bitstl::move(src[i]);
+                    }
+                };
+            run_paral(pool, thread_num, scatter);
+
+            std::swap(src, dst);
+            counted = false;
+        }
+
+        if (src != data)
+        {
+            auto move_back = [&](ulong t)
+                {
+                    bitstl::move(src + chunk_first(t), src + chunk_last(t), data + chunk_first(t));
+                };
+            run_paral(pool, thread_num, move_back);
+        }
+    }
+
+    template<typename Iterator, typename KeyExtractor>
+    void radix_sort_paral(thread_pool& pool, Iterator first, Iterator last, KeyExtractor key)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+        radix_sort_paral(pool, first, last, key, allocator<value_type>());
+    }
+
+    template<typename Iterator>
+    void radix_sort_paral(thread_pool& pool, Iterator first, Iterator last)
+    {
+        radix_sort_paral(pool, first, last, radix_detail::identity());
+    }
+
+    template<typename Iterator, typename KeyExtractor, typename Alloc>
+    void radix_sort_paral(Iterator first, Iterator last, KeyExtractor key, const Alloc& alloc)
+    {
+        radix_sort_paral(thread_pool::default_pool(), first, last, key, alloc);
+    }
+
+    template<typename Iterator, typename KeyExtractor>
+    void radix_sort_paral(Iterator first, Iterator last, KeyExtractor key)
+    {
+        radix_sort_paral(thread_pool::default_pool(), first, last, key);
+    }
+
+    template<typename Iterator>
+    void radix_sort_paral(Iterator first, Iterator last)
+    {
+        radix_sort_paral(thread_pool::default_pool(), first, last);
+    }
+
+    /*
+     * 原地并行排序
+     * 各线程从共享的栈中取出区间进行三路划分（轴为九数取中），较短的一侧压栈供其它线程取走，继续处理较长的一侧
+     * 区间短于cutoff或划分次数达到2log2(n)时以bitstl::sort串行排序（其中的深度限制保证最坏O(nlogn)）
+     * 所有元素都已处于最终位置时各线程退出
+     */
+    template<typename Iterator, typename Compare>
+    void sort_paral(thread_pool& pool, Iterator first, Iterator last, Compare comp)
+    {
+        using difference_type = typename iterator_traits<Iterator>::difference_type;
+
+        const ulong data_length = static_cast<ulong>(last - first);
+        // 数据量较小时线程的创建与同步开销超过收益
+        const ulong min_length = 1ul << 15;
+        if (data_length < min_length)
+        {
+            bitstl::sort(first, last, comp);
+            return;
+        }
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+        if (thread_num == 1)
+        {
+            bitstl::sort(first, last, comp);
+            return;
+        }
+
+        // 每个线程平均分到8个以上的区间，以平衡负载
+        const difference_type cutoff = static_cast<difference_type>(std::max(data_length / (thread_num * 8), 4096ul));
+
+        struct chunk_to_sort
+        {
+            Iterator first;
+            Iterator last;
+            int depth_limit;
+        };
+        stack_ts<chunk_to_sort> chunks;
+        std::atomic<ulong> sorted(0);  // 已处于最终位置的元素个数
+        std::atomic<bool> failed(false);
+
+        auto process = [&](Iterator lo, Iterator hi, int depth)
+            {
+                while (hi - lo > cutoff && depth > 0)
+                {
+                    --depth;
+                    const difference_type len = hi - lo;
+                    const difference_type step = len / 8;
+                    const Iterator mid = lo + len / 2;
+                    const Iterator pivot = sort_detail::median_of_three(
+                        sort_detail::median_of_three(lo, lo + step, lo + 2 * step, comp),
+                        sort_detail::median_of_three(mid - step, mid, mid + step, comp),
+                        sort_detail::median_of_three(hi - 1 - 2 * step, hi - 1 - step, hi - 1, comp), comp);
+                    sort_detail::iter_swap(lo, pivot);
+
+                    const auto equal_range = sort_detail::partition_three_way(lo, hi, comp);
+                    sorted.fetch_add(static_cast<ulong>(equal_range.second - equal_range.first));
+                    if (equal_range.first - lo < hi - equal_range.second)
+                    {
+                        chunks.push(chunk_to_sort{ lo, equal_range.first, depth });
+                        lo = equal_range.second;
+                    }
+                    else
+                    {
+                        chunks.push(chunk_to_sort{ equal_range.second, hi, depth });
+                        hi = equal_range.first;
+                    }
+                }
+                bitstl::sort(lo, hi, comp);
+                sorted.fetch_add(static_cast<ulong>(hi - lo));
+            };
+
+        auto work = [&](ulong)
+            {
+                try
+                {
+                    while (sorted.load() != data_length && !failed.load())
+                    {
+                        if (std::shared_ptr<chunk_to_sort> chunk = chunks.pop())
+                            process(chunk->first, chunk->last, chunk->depth_limit);
+                        else
+                            std::this_thread::yield();
+                    }
+                }
+                catch (...)
+                {
+                    failed.store(true);
+                    throw;
+                }
+            };
+
+        chunks.push(chunk_to_sort{ first, last, sort_detail::depth_limit(data_length) });
+        run_paral(pool, thread_num, work);
+    }
+
+    template<typename Iterator>
+    void sort_paral(thread_pool& pool, Iterator first, Iterator last)
+    {
+        sort_paral(pool, first, last, std::less<>());
+    }
+
+    template<typename Iterator, typename Compare>
+    void sort_paral(Iterator first, Iterator last, Compare comp)
+    {
+        sort_paral(thread_pool::default_pool(), first, last, comp);
+    }
+
+    template<typename Iterator>
+    void sort_paral(Iterator first, Iterator last)
+    {
+        sort_paral(thread_pool::default_pool(), first, last);
+    }
+
+    namespace merge_detail
+    {
+        /*
+         * 两路归并的co-rank（merge path）：输出的前d个元素中来自第一个区间的个数i
+         * 满足first1[i - 1]不大于first2[d - i]且first2[d - i - 1]小于first1[i]，相等时取第一个区间的元素
+         */
+        template<typename Iterator1, typename Iterator2, typename Compare>
+        ulong co_rank(Iterator1 first1, ulong n1, Iterator2 first2, ulong n2, ulong d, Compare& comp)
+        {
+            ulong lo = d > n2 ? d - n2 : 0;
+            ulong hi = std::min(d, n1);
+            while (lo < hi)
+            {
+                const ulong mid = lo + (hi - lo) / 2;
+                if (!comp(first2[d - mid - 1], first1[mid]))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo;
+        }
+
+        /*
+         * 多路归并的co-rank：按（值，所在区间的序号）排序时，输出的前d个元素中来自各区间的个数写入splits
+         * 区间r中的元素x之前的元素个数为：序号小于r的区间中不大于x的个数 + 序号大于r的区间中小于x的个数 + 区间r中x之前的个数
+         * 该值在区间r内严格递增，二分查找首个不小于d的位置即为区间r的分割点
+         */
+        template<typename Iterator, typename Compare>
+        void multiway_co_rank(const std::vector<std::pair<Iterator, Iterator>>& runs, ulong d,
+            std::vector<ulong>& splits, Compare& comp)
+        {
+            const ulong k = static_cast<ulong>(runs.size());
+            auto rank_of = [&](ulong r, ulong i)
+                {
+                    const auto& x = runs[r].first[i];
+                    ulong rank = i;
+                    for (ulong q = 0; q < k; ++q)
+                    {
+                        if (q < r)
+                            rank += static_cast<ulong>(bitstl::upper_bound(runs[q].first, runs[q].second, x, comp) - runs[q].first);
+                        else if (q > r)
+                            rank += static_cast<ulong>(bitstl::lower_bound(runs[q].first, runs[q].second, x, comp) - runs[q].first);
+                    }
+                    return rank;
+                };
+
+            splits.assign(k, 0);
+            for (ulong r = 0; r < k; ++r)
+            {
+                ulong lo = 0, hi = static_cast<ulong>(runs[r].second - runs[r].first);
+                // 区间r中前d个元素之外的元素不会在分割点之前
+                hi = std::min(hi, d);
+                while (lo < hi)
+                {
+                    const ulong mid = lo + (hi - lo) / 2;
+                    if (rank_of(r, mid) < d)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                splits[r] = lo;
+            }
+        }
+
+        /*
+         * 以败者树串行归并k个有序区间，稳定
+         * 叶节点补齐为2的幂，补齐的叶节点视为空区间；内部节点保存比赛的败者，每输出一个元素只需沿叶节点到根重赛一次
+         */
+        template<typename Iterator, typename OutputIterator, typename Compare>
+        OutputIterator multiway_merge(const std::vector<std::pair<Iterator, Iterator>>& runs,
+            OutputIterator d_first, Compare& comp)
+        {
+            const ulong k = static_cast<ulong>(runs.size());
+            if (k == 0)
+                return d_first;
+            if (k == 1)
+                return bitstl::copy(runs[0].first, runs[0].second, d_first);
+            if (k == 2)
+                return bitstl::merge(runs[0].first, runs[0].second, runs[1].first, runs[1].second, d_first, comp);
+
+            ulong leaves = 1;
+            while (leaves < k)
+                leaves *= 2;
+            std::vector<Iterator> current(leaves), last(leaves);
+            ulong remaining = 0;
+            for (ulong r = 0; r < k; ++r)
+            {
+                current[r] = runs[r].first;
+                last[r] = runs[r].second;
+                remaining += static_cast<ulong>(last[r] - current[r]);
+            }
+
+            // a是否应排在b之前，空区间排在最后，相等时序号小的在前
+            auto before = [&](ulong a, ulong b)
+                {
+                    if (current[a] == last[a])
+                        return false;
+                    if (current[b] == last[b])
+                        return true;
+                    if (comp(*current[b], *current[a]))
+                        return false;
+                    return a < b || comp(*current[a], *current[b]);
+                };
+
+            // tree[0]为胜者，tree[1..leaves)为各内部节点的败者
+            std::vector<ulong> tree(leaves), winners(2 * leaves);
+            for (ulong i = 0; i < leaves; ++i)
+                winners[leaves + i] = i;
+            for (ulong node = leaves - 1; node > 0; --node)
+            {
+                const ulong a = winners[2 * node], b = winners[2 * node + 1];
+                const bool a_wins = before(a, b);
+                winners[node] = a_wins ? a : b;
+                tree[node] = a_wins ? b : a;
+            }
+            tree[0] = winners[1];
+
+            for (; remaining > 0; --remaining, ++d_first)
+            {
+                ulong winner = tree[0];
+                *d_first = *current[winner];
+                ++current[winner];
+                for (ulong node = (leaves + winner) / 2; node > 0; node /= 2)
+                {
+                    if (before(tree[node], winner))
+                        std::swap(tree[node], winner);
+                }
+                tree[0] = winner;
+            }
+            return d_first;
+        }
+
+        /*
+         * 按输出的位置将多路归并平均分给各线程，runs的总长度为data_length
+         * 先求出所有分割点再开始归并：输入为move_iterator时，已归并的元素不能再用于其它线程的二分查找
+         */
+        template<typename Iterator, typename OutputIterator, typename Compare>
+        void multiway_merge_paral(thread_pool& pool, const std::vector<std::pair<Iterator, Iterator>>& runs,
+            ulong data_length, OutputIterator d_first, Compare& comp)
+        {
+            ulong thread_num = 0, data_per_thread = 0;
+            get_partition(pool, data_length, thread_num, data_per_thread);
+            auto part_first = [&](ulong t) { return t == thread_num ? data_length : t * data_per_thread; };
+
+            // splits[t]为线程t的部分在各区间中的起点，splits[thread_num]为各区间的终点
+            std::vector<std::vector<ulong>> splits(thread_num + 1);
+            auto find_splits = [&](ulong t)
+                {
+                    merge_detail::multiway_co_rank(runs, part_first(t + 1), splits[t + 1], comp);
+                };
+            splits[0].assign(runs.size(), 0);
+            run_paral(pool, thread_num, find_splits);
+
+            auto merge_part = [&](ulong t)
+                {
+                    std::vector<std::pair<Iterator, Iterator>> parts(runs.size());
+                    for (size_t r = 0; r < runs.size(); ++r)
+                        parts[r] = { runs[r].first + splits[t][r], runs[r].first + splits[t + 1][r] };
+                    merge_detail::multiway_merge(parts, d_first + part_first(t), comp);
+                };
+            run_paral(pool, thread_num, merge_part);
+        }
+    }
+
+    /*
+     * 并行归并两个有序区间，稳定，迭代器均须为随机访问迭代器
+     * 按merge path将输出平均分给各线程：线程t负责输出的第t * n / p至(t + 1) * n / p个元素，
+     * 以二分查找求出对应的两个输入区间的分割点后独立归并
+     */
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename Compare>
+    OutputIterator merge_paral(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+        OutputIterator d_first, Compare comp)
+    {
+        const ulong n1 = static_cast<ulong>(last1 - first1);
+        const ulong n2 = static_cast<ulong>(last2 - first2);
+        const ulong data_length = n1 + n2;
+        // 数据量较小时线程的创建与同步开销超过收益
+        const ulong min_length = 1ul << 15;
+        if (data_length < min_length)
+            return bitstl::merge(first1, last1, first2, last2, d_first, comp);
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+
+        // 先求出所有分割点再开始归并，输入为move_iterator时也不会读到已移走的元素
+        std::vector<ulong> splits(thread_num + 1);
+        for (ulong t = 0; t < thread_num; ++t)
+            splits[t] = merge_detail::co_rank(first1, n1, first2, n2, t * data_per_thread, comp);
+        splits[thread_num] = n1;
+
+        auto merge_part = [&](ulong t)
+            {
+                const ulong d_begin = t * data_per_thread;
+                const ulong d_end = t == thread_num - 1 ? data_length : (t + 1) * data_per_thread;
+                bitstl::merge(first1 + splits[t], first1 + splits[t + 1],
+                    first2 + (d_begin - splits[t]), first2 + (d_end - splits[t + 1]), d_first + d_begin, comp);
+            };
+        run_paral(pool, thread_num, merge_part);
+        return d_first + data_length;
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator>
+    OutputIterator merge_paral(thread_pool& pool, Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+        OutputIterator d_first)
+    {
+        return merge_paral(pool, first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator, typename Compare>
+    OutputIterator merge_paral(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2,
+        OutputIterator d_first, Compare comp)
+    {
+        return merge_paral(thread_pool::default_pool(), first1, last1, first2, last2, d_first, comp);
+    }
+
+    template<typename Iterator1, typename Iterator2, typename OutputIterator>
+    OutputIterator merge_paral(Iterator1 first1, Iterator1 last1, Iterator2 first2, Iterator2 last2, OutputIterator d_first)
+    {
+        return merge_paral(thread_pool::default_pool(), first1, last1, first2, last2, d_first);
+    }
+
+    /*
+     * 并行多路归并，runs为各有序区间的[first, last)，稳定：相等的元素按所在区间的顺序输出
+     * 分割方式同merge_paral，分割点由多路的co-rank求出，各线程以败者树归并自己的部分
+     */
+    template<typename Iterator, typename OutputIterator, typename Compare>
+    OutputIterator multiway_merge_paral(thread_pool& pool, const std::vector<std::pair<Iterator, Iterator>>& runs,
+        OutputIterator d_first, Compare comp)
+    {
+        ulong data_length = 0;
+        for (const auto& run : runs)
+            data_length += static_cast<ulong>(run.second - run.first);
+        const ulong min_length = 1ul << 15;
+        if (data_length < min_length)
+            return merge_detail::multiway_merge(runs, d_first, comp);
+
+        merge_detail::multiway_merge_paral(pool, runs, data_length, d_first, comp);
+        return d_first + data_length;
+    }
+
+    template<typename Iterator, typename OutputIterator>
+    OutputIterator multiway_merge_paral(thread_pool& pool, const std::vector<std::pair<Iterator, Iterator>>& runs,
+        OutputIterator d_first)
+    {
+        return multiway_merge_paral(pool, runs, d_first, std::less<>());
+    }
+
+    template<typename Iterator, typename OutputIterator, typename Compare>
+    OutputIterator multiway_merge_paral(const std::vector<std::pair<Iterator, Iterator>>& runs,
+        OutputIterator d_first, Compare comp)
+    {
+        return multiway_merge_paral(thread_pool::default_pool(), runs, d_first, comp);
+    }
+
+    template<typename Iterator, typename OutputIterator>
+    OutputIterator multiway_merge_paral(const std::vector<std::pair<Iterator, Iterator>>& runs, OutputIterator d_first)
+    {
+        return multiway_merge_paral(thread_pool::default_pool(), runs, d_first);
+    }
+
+    /*
+     * 并行稳定排序，迭代器须为连续迭代器
+     * 各线程以stable_sort排序自己的分块并移入暂存区，再由multiway_merge_paral将各分块归并回原区间
+     */
+    template<typename Iterator, typename Compare>
+    void stable_sort_paral(thread_pool& pool, Iterator first, Iterator last, Compare comp)
+    {
+        using value_type = typename iterator_traits<Iterator>::value_type;
+        static_assert(is_contiguous_iterator<Iterator>, "stable_sort_paral requires contiguous iterators");
+
+        const ulong data_length = static_cast<ulong>(last - first);
+        const ulong min_length = 1ul << 15;
+        if (data_length < min_length)
+        {
+            bitstl::stable_sort(first, last, comp);
+            return;
+        }
+
+        ulong thread_num = 0, data_per_thread = 0;
+        get_partition(pool, data_length, thread_num, data_per_thread);
+        if (thread_num == 1)
+        {
+            bitstl::stable_sort(first, last, comp);
+            return;
+        }
+        auto chunk_first = [&](ulong t) { return t * data_per_thread; };
+        auto chunk_last  = [&](ulong t) { return t == thread_num - 1 ? data_length : (t + 1) * data_per_thread; };
+
+        // 元素不可平凡复制时数据已移入暂存区，在暂存区中排序；否则在原区间排序后复制到暂存区
+        value_type* data = bitstl::to_address(first);
+        using buffer_type = radix_detail::scratch_buffer<value_type, allocator<value_type>>;
+        buffer_type buffer(data, data_length, allocator<value_type>());
+        value_type* runs_data = buffer.data();
+
+        auto sort_chunk = [&](ulong t)
+            {
+                if constexpr (buffer_type::holds_data)
+                    bitstl::stable_sort(runs_data + chunk_first(t), runs_data + chunk_last(t), comp);
+                else
+                {
+                    bitstl::stable_sort(data + chunk_first(t), data + chunk_last(t), comp);
+                    bitstl::copy(data + chunk_first(t), data + chunk_last(t), runs_data + chunk_first(t));
+                }
+            };
+        run_paral(pool, thread_num, sort_chunk);
+
+        using run_iterator = std::move_iterator<value_type*>;
+        std::vector<std::pair<run_iterator, run_iterator>> runs(thread_num);
+        for (ulong t = 0; t < thread_num; ++t)
+            runs[t] = { run_iterator(runs_data + chunk_first(t)), run_iterator(runs_data + chunk_last(t)) };
+        merge_detail::multiway_merge_paral(pool, runs, data_length, data, comp);
+    }
+
+    template<typename Iterator>
+    void stable_sort_paral(thread_pool& pool, Iterator first, Iterator last)
+    {
+        stable_sort_paral(pool, first, last, std::less<>());
+    }
+
+    template<typename Iterator, typename Compare>
+    void stable_sort_paral(Iterator first, Iterator last, Compare comp)
+    {
+        stable_sort_paral(thread_pool::default_pool(), first, last, comp);
+    }
+
+    template<typename Iterator>
+    void stable_sort_paral(Iterator first, Iterator last)
+    {
+        stable_sort_paral(thread_pool::default_pool(), first, last);
+    }
+}
+
+#endif // !ALGO_PARAL_H
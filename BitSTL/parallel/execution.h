@@ -0,0 +1,616 @@
+/*
+ * 执行策略
+ * seq顺序执行；unseq在当前线程执行并允许向量化；par在线程池上分块并行；par_unseq分块并行且块内允许向量化
+ * 并行策略在元素数少于阈值（默认1 << 15）或迭代器不支持随机访问时退回串行版本
+ * 与std不同，元素访问函数抛出的异常不会调用std::terminate，而是在所有分块结束后重新抛出
+ */
+#ifndef EXECUTION_H
+#define EXECUTION_H
+
+#include <atomic>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "config.h"
+#include "type_traits.h"
+#include "iterator.h"
+#include "algorithm.h"
+#include "numeric.h"
+#include "algo_paral.h"
+#include "thread_pool.h"
+
+namespace bitstl
+{
+    namespace execution
+    {
+        // 顺序执行
+        struct sequenced_policy {};
+
+        // 在当前线程执行，允许向量化
+        struct unsequenced_policy {};
+
+        // 分块并行，Unsequenced为true时块内允许向量化
+        template<bool Unsequenced>
+        class basic_parallel_policy
+        {
+        public:
+            static constexpr size_t default_threshold = 1ull << 15;
+
+            constexpr basic_parallel_policy() noexcept = default;
+
+            // 返回元素数达到threshold时才并行执行的策略
+            constexpr basic_parallel_policy with_threshold(size_t threshold)
+                const noexcept
+            {
+                basic_parallel_policy policy(*this);
+                policy.threshold_ = threshold;
+                return policy;
+            }
+
+            // 返回在pool上执行的策略，pool须比使用该策略的调用存活得更久
+            constexpr basic_parallel_policy on(thread_pool& pool)
+                const noexcept
+            {
+                basic_parallel_policy policy(*this);
+                policy.pool_ = &pool;
+                return policy;
+            }
+
+            constexpr size_t threshold()
+                const noexcept
+            {
+                return threshold_;
+            }
+
+            thread_pool& pool()
+                const
+            {
+                return pool_ ? *pool_ : thread_pool::default_pool();
+            }
+
+        private:
+            size_t threshold_ = default_threshold;
+            thread_pool* pool_ = nullptr;
+        };
+
+        using parallel_policy = basic_parallel_policy<false>;
+        using parallel_unsequenced_policy = basic_parallel_policy<true>;
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr unsequenced_policy unseq{};
+        inline constexpr parallel_policy par{};
+        inline constexpr parallel_unsequenced_policy par_unseq{};
+
+        template<typename T>
+        struct is_execution_policy : false_type {};
+
+        template<>
+        struct is_execution_policy<sequenced_policy> : true_type {};
+
+        template<>
+        struct is_execution_policy<unsequenced_policy> : true_type {};
+
+        template<bool Unsequenced>
+        struct is_execution_policy<basic_parallel_policy<Unsequenced>> : true_type {};
+
+        template<typename T>
+        inline constexpr bool is_execution_policy_v = is_execution_policy<T>::value;
+    }
+
+    namespace execution_detail
+    {
+        template<typename ExecutionPolicy>
+        using policy_t = remove_cv_t<remove_reference_t<ExecutionPolicy>>;
+
+        // 第一个参数为执行策略时才参与重载决议，避免与串行版本冲突
+        template<typename ExecutionPolicy, typename T>
+        using enable_if_policy_t = std::enable_if_t<execution::is_execution_policy_v<policy_t<ExecutionPolicy>>, T>;
+
+        template<typename ExecutionPolicy>
+        inline constexpr bool is_parallel_v = false;
+
+        template<bool Unsequenced>
+        inline constexpr bool is_parallel_v<execution::basic_parallel_policy<Unsequenced>> = true;
+
+        template<typename ExecutionPolicy>
+        inline constexpr bool is_unsequenced_v = is_same_v<ExecutionPolicy, execution::unsequenced_policy>
+            || is_same_v<ExecutionPolicy, execution::parallel_unsequenced_policy>;
+
+        // 标准库容器的迭代器使用std的标签
+        template<typename Iterator>
+        inline constexpr bool is_random_access_v = is_random_access_iterator<Iterator> || std::random_access_iterator<Iterator>;
+
+        // 并行策略且所有迭代器都支持随机访问时才分块
+        template<typename ExecutionPolicy, typename... Iterators>
+        inline constexpr bool is_chunkable_v = is_parallel_v<ExecutionPolicy> && (is_random_access_v<Iterators> && ...);
+
+        // 返回[0, n)划分的块数，为1时应串行执行
+        template<typename ExecutionPolicy>
+        ulong chunk_count(const ExecutionPolicy& policy, size_t n)
+        {
+            if (n == 0 || n < policy.threshold())
+                return 1;
+            ulong chunk_num = 0, data_per_chunk = 0;
+            get_partition(policy.pool(), static_cast<ulong>(n), chunk_num, data_per_chunk);
+            return chunk_num;
+        }
+
+        // 将[0, n)等分为chunk_num块，在线程池上执行f(t, begin, end)，每块非空
+        template<typename ExecutionPolicy, typename Func>
+        void run_chunks(const ExecutionPolicy& policy, size_t n, ulong chunk_num, Func f)
+        {
+            const size_t data_per_chunk = n / chunk_num;
+            auto process = [&](ulong t)
+                {
+                    const size_t begin = t * data_per_chunk;
+                    const size_t end = t + 1 == chunk_num ? n : begin + data_per_chunk;
+                    f(t, begin, end);
+                };
+            run_paral(policy.pool(), chunk_num, process);
+        }
+
+        // 块数大于1时并行执行f(begin, end)，否则在当前线程执行f(0, n)
+        template<typename ExecutionPolicy, typename Func>
+        void for_each_chunk(const ExecutionPolicy& policy, size_t n, Func f)
+        {
+            const ulong chunk_num = chunk_count(policy, n);
+            if (chunk_num > 1)
+                run_chunks(policy, n, chunk_num, [&f](ulong, size_t begin, size_t end) { f(begin, end); });
+            else if (n)
+                f(0, n);
+        }
+
+        // 分块规约：每块的部分结果按块的顺序合并，结果与划分方式无关（op满足结合律时）
+        template<typename ExecutionPolicy, typename T, typename BinaryOperation, typename ChunkReduce>
+        T reduce_chunks(const ExecutionPolicy& policy, size_t n, ulong chunk_num, T init, BinaryOperation& op, ChunkReduce chunk_reduce)
+        {
+            std::vector<std::optional<T>> partials(chunk_num);
+            run_chunks(policy, n, chunk_num, [&](ulong t, size_t begin, size_t end)
+                {
+                    partials[t].emplace(chunk_reduce(begin, end));
+                });
+            for (auto& partial : partials)
+                init = op(bitstl::move(init), bitstl::move(*partial));
+            return init;
+        }
+
+        // 允许向量化的逐元素循环
+        template<typename RandomIterator, typename UnaryFunction>
+        void for_each_unseq(RandomIterator first, size_t n, UnaryFunction& f)
+        {
+            using difference_type = typename iterator_traits<RandomIterator>::difference_type;
+            const difference_type count = static_cast<difference_type>(n);
+            BITSTL_IVDEP
+            for (difference_type i = 0; i < count; ++i)
+                f(first[i]);
+        }
+
+        template<typename RandomIterator, typename OutputIterator, typename UnaryOperation>
+        void transform_unseq(RandomIterator first, size_t n, OutputIterator dest_first, UnaryOperation& op)
+        {
+            using difference_type = typename iterator_traits<RandomIterator>::difference_type;
+            const difference_type count = static_cast<difference_type>(n);
+            BITSTL_IVDEP
+            for (difference_type i = 0; i < count; ++i)
+                dest_first[i] = op(first[i]);
+        }
+
+        template<typename RandomIterator1, typename RandomIterator2, typename OutputIterator, typename BinaryOperation>
+        void transform_unseq(RandomIterator1 first1, size_t n, RandomIterator2 first2, OutputIterator dest_first, BinaryOperation& op)
+        {
+            using difference_type = typename iterator_traits<RandomIterator1>::difference_type;
+            const difference_type count = static_cast<difference_type>(n);
+            BITSTL_IVDEP
+            for (difference_type i = 0; i < count; ++i)
+                dest_first[i] = op(first1[i], first2[i]);
+        }
+
+        /*
+         * 返回[0, n)中首个满足pred(i)的下标，不存在时返回n
+         * 各块每次以find_block查找一段，found记录目前已知的最小下标，块内当前位置已在found之后时停止
+         * 因此更靠前的匹配不会被跳过，结果与串行查找一致
+         */
+        template<typename ExecutionPolicy, typename FindBlock>
+        size_t find_chunks(const ExecutionPolicy& policy, size_t n, ulong chunk_num, FindBlock find_block)
+        {
+            std::atomic<size_t> found(n);
+            run_chunks(policy, n, chunk_num, [&](ulong, size_t begin, size_t end)
+                {
+                    const size_t block_size = 4096;
+                    while (begin < end && begin < found.load(std::memory_order_relaxed))
+                    {
+                        const size_t block_end = std::min(end, begin + block_size);
+                        const size_t i = find_block(begin, block_end);
+                        if (i != block_end)
+                        {
+                            size_t current = found.load();
+                            while (i < current && !found.compare_exchange_weak(current, i));
+                            return;
+                        }
+                        begin = block_end;
+                    }
+                });
+            return found.load();
+        }
+    }
+
+    /*
+     * 遍历与变换
+     */
+    template<typename ExecutionPolicy, typename ForwardIterator, typename UnaryFunction>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        for_each(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryFunction f)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_random_access_v<ForwardIterator>
+            && (execution_detail::is_parallel_v<policy_type> || execution_detail::is_unsequenced_v<policy_type>))
+        {
+            auto process = [&](size_t begin, size_t end)
+                {
+                    if constexpr (execution_detail::is_unsequenced_v<policy_type>)
+                        execution_detail::for_each_unseq(first + begin, end - begin, f);
+                    else
+                        bitstl::for_each(first + begin, first + end, f);
+                };
+            const size_t n = static_cast<size_t>(last - first);
+            if constexpr (execution_detail::is_parallel_v<policy_type>)
+                execution_detail::for_each_chunk(policy, n, process);
+            else if (n)
+                process(0, n);
+        }
+        else
+            bitstl::for_each(first, last, f);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename Size, typename UnaryFunction>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+        for_each_n(ExecutionPolicy&& policy, ForwardIterator first, Size count, UnaryFunction f)
+    {
+        if constexpr (execution_detail::is_random_access_v<ForwardIterator>)
+        {
+            if (count <= 0)
+                return first;
+            ForwardIterator last = first + count;
+            bitstl::for_each(policy, first, last, f);
+            return last;
+        }
+        else
+            return bitstl::for_each_n(first, count, f);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator1, typename ForwardIterator2>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+        copy(ExecutionPolicy&& policy, ForwardIterator1 first, ForwardIterator1 last, ForwardIterator2 dest_first)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator1, ForwardIterator2>)
+        {
+            // 每块仍由bitstl::copy复制，可平凡复制的元素使用memmove
+            const size_t n = static_cast<size_t>(last - first);
+            execution_detail::for_each_chunk(policy, n, [&](size_t begin, size_t end)
+                {
+                    bitstl::copy(first + begin, first + end, dest_first + begin);
+                });
+            return dest_first + n;
+        }
+        else
+            return bitstl::copy(first, last, dest_first);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        fill(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            execution_detail::for_each_chunk(policy, static_cast<size_t>(last - first), [&](size_t begin, size_t end)
+                {
+                    bitstl::fill(first + begin, first + end, value);
+                });
+        }
+        else
+            bitstl::fill(first, last, value);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename Size, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+        fill_n(ExecutionPolicy&& policy, ForwardIterator first, Size count, const T& value)
+    {
+        if constexpr (execution_detail::is_random_access_v<ForwardIterator>)
+        {
+            if (count <= 0)
+                return first;
+            ForwardIterator last = first + count;
+            bitstl::fill(policy, first, last, value);
+            return last;
+        }
+        else
+            return bitstl::fill_n(first, count, value);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator1, typename ForwardIterator2, typename UnaryOperation>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+        transform(ExecutionPolicy&& policy, ForwardIterator1 first, ForwardIterator1 last, ForwardIterator2 dest_first, UnaryOperation op)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_random_access_v<ForwardIterator1> && execution_detail::is_random_access_v<ForwardIterator2>
+            && (execution_detail::is_parallel_v<policy_type> || execution_detail::is_unsequenced_v<policy_type>))
+        {
+            auto process = [&](size_t begin, size_t end)
+                {
+                    if constexpr (execution_detail::is_unsequenced_v<policy_type>)
+                        execution_detail::transform_unseq(first + begin, end - begin, dest_first + begin, op);
+                    else
+                        bitstl::transform(first + begin, first + end, dest_first + begin, op);
+                };
+            const size_t n = static_cast<size_t>(last - first);
+            if constexpr (execution_detail::is_parallel_v<policy_type>)
+                execution_detail::for_each_chunk(policy, n, process);
+            else if (n)
+                process(0, n);
+            return dest_first + n;
+        }
+        else
+            return bitstl::transform(first, last, dest_first, op);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator1, typename ForwardIterator2, typename ForwardIterator3, typename BinaryOperation>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator3>
+        transform(ExecutionPolicy&& policy, ForwardIterator1 first1, ForwardIterator1 last1, ForwardIterator2 first2,
+            ForwardIterator3 dest_first, BinaryOperation op)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_random_access_v<ForwardIterator1> && execution_detail::is_random_access_v<ForwardIterator2>
+            && execution_detail::is_random_access_v<ForwardIterator3>
+            && (execution_detail::is_parallel_v<policy_type> || execution_detail::is_unsequenced_v<policy_type>))
+        {
+            auto process = [&](size_t begin, size_t end)
+                {
+                    if constexpr (execution_detail::is_unsequenced_v<policy_type>)
+                        execution_detail::transform_unseq(first1 + begin, end - begin, first2 + begin, dest_first + begin, op);
+                    else
+                        bitstl::transform(first1 + begin, first1 + end, first2 + begin, dest_first + begin, op);
+                };
+            const size_t n = static_cast<size_t>(last1 - first1);
+            if constexpr (execution_detail::is_parallel_v<policy_type>)
+                execution_detail::for_each_chunk(policy, n, process);
+            else if (n)
+                process(0, n);
+            return dest_first + n;
+        }
+        else
+            return bitstl::transform(first1, last1, first2, dest_first, op);
+    }
+
+    /*
+     * 规约
+     * 每块的部分结果以块内首个元素（转换为T）为初值，不要求T可默认构造
+     */
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T, typename BinaryOperation>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, T>
+        reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, T init, BinaryOperation op)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                return execution_detail::reduce_chunks(policy, n, chunk_num, bitstl::move(init), op, [&](size_t begin, size_t end)
+                    {
+                        return bitstl::reduce(first + begin + 1, first + end, T(first[begin]), op);
+                    });
+            }
+        }
+        return bitstl::reduce(first, last, bitstl::move(init), op);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, T>
+        reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, T init)
+    {
+        return bitstl::reduce(policy, first, last, bitstl::move(init), std::plus<>());
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, typename iterator_traits<ForwardIterator>::value_type>
+        reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last)
+    {
+        return bitstl::reduce(policy, first, last, typename iterator_traits<ForwardIterator>::value_type());
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T, typename BinaryReductionOp, typename UnaryTransformOp>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, T>
+        transform_reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, T init,
+            BinaryReductionOp reduce, UnaryTransformOp transform)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                return execution_detail::reduce_chunks(policy, n, chunk_num, bitstl::move(init), reduce, [&](size_t begin, size_t end)
+                    {
+                        return bitstl::transform_reduce(first + begin + 1, first + end, T(transform(first[begin])), reduce, transform);
+                    });
+            }
+        }
+        return bitstl::transform_reduce(first, last, bitstl::move(init), reduce, transform);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator1, typename ForwardIterator2, typename T,
+        typename BinaryReductionOp, typename BinaryTransformOp>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, T>
+        transform_reduce(ExecutionPolicy&& policy, ForwardIterator1 first1, ForwardIterator1 last1, ForwardIterator2 first2, T init,
+            BinaryReductionOp reduce, BinaryTransformOp transform)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator1, ForwardIterator2>)
+        {
+            const size_t n = static_cast<size_t>(last1 - first1);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                return execution_detail::reduce_chunks(policy, n, chunk_num, bitstl::move(init), reduce, [&](size_t begin, size_t end)
+                    {
+                        return bitstl::transform_reduce(first1 + begin + 1, first1 + end, first2 + begin + 1,
+                            T(transform(first1[begin], first2[begin])), reduce, transform);
+                    });
+            }
+        }
+        return bitstl::transform_reduce(first1, last1, first2, bitstl::move(init), reduce, transform);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator1, typename ForwardIterator2, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, T>
+        transform_reduce(ExecutionPolicy&& policy, ForwardIterator1 first1, ForwardIterator1 last1, ForwardIterator2 first2, T init)
+    {
+        return bitstl::transform_reduce(policy, first1, last1, first2, bitstl::move(init), std::plus<>(), std::multiplies<>());
+    }
+
+    /*
+     * 查找与计数
+     * find、find_if返回最靠前的匹配，与串行版本一致；每段仍由bitstl::find查找，可使用向量内核
+     */
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+        find(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                return first + execution_detail::find_chunks(policy, n, chunk_num, [&](size_t begin, size_t end)
+                    {
+                        return begin + static_cast<size_t>(bitstl::find(first + begin, first + end, value) - (first + begin));
+                    });
+            }
+        }
+        return bitstl::find(first, last, value);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename UnaryPredicate>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+        find_if(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate pred)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                return first + execution_detail::find_chunks(policy, n, chunk_num, [&](size_t begin, size_t end)
+                    {
+                        return begin + static_cast<size_t>(bitstl::find_if(first + begin, first + end, pred) - (first + begin));
+                    });
+            }
+        }
+        return bitstl::find_if(first, last, pred);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename T>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, typename iterator_traits<ForwardIterator>::difference_type>
+        count(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, const T& value)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        using difference_type = typename iterator_traits<ForwardIterator>::difference_type;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                std::plus<> op;
+                return execution_detail::reduce_chunks(policy, n, chunk_num, difference_type(0), op, [&](size_t begin, size_t end)
+                    {
+                        return static_cast<difference_type>(bitstl::count(first + begin, first + end, value));
+                    });
+            }
+        }
+        return bitstl::count(first, last, value);
+    }
+
+    template<typename ExecutionPolicy, typename ForwardIterator, typename UnaryPredicate>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, typename iterator_traits<ForwardIterator>::difference_type>
+        count_if(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last, UnaryPredicate pred)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        using difference_type = typename iterator_traits<ForwardIterator>::difference_type;
+        if constexpr (execution_detail::is_chunkable_v<policy_type, ForwardIterator>)
+        {
+            const size_t n = static_cast<size_t>(last - first);
+            const ulong chunk_num = execution_detail::chunk_count(policy, n);
+            if (chunk_num > 1)
+            {
+                std::plus<> op;
+                return execution_detail::reduce_chunks(policy, n, chunk_num, difference_type(0), op, [&](size_t begin, size_t end)
+                    {
+                        return static_cast<difference_type>(bitstl::count_if(first + begin, first + end, pred));
+                    });
+            }
+        }
+        return bitstl::count_if(first, last, pred);
+    }
+
+    /*
+     * 排序
+     * sort分派到sort_paral，stable_sort在连续迭代器上分派到stable_sort_paral
+     */
+    template<typename ExecutionPolicy, typename RandomIterator, typename Compare>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        sort(ExecutionPolicy&& policy, RandomIterator first, RandomIterator last, Compare comp)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_parallel_v<policy_type>)
+        {
+            if (static_cast<size_t>(last - first) >= policy.threshold())
+            {
+                sort_paral(policy.pool(), first, last, comp);
+                return;
+            }
+        }
+        bitstl::sort(first, last, comp);
+    }
+
+    template<typename ExecutionPolicy, typename RandomIterator>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        sort(ExecutionPolicy&& policy, RandomIterator first, RandomIterator last)
+    {
+        bitstl::sort(policy, first, last, std::less<>());
+    }
+
+    template<typename ExecutionPolicy, typename RandomIterator, typename Compare>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        stable_sort(ExecutionPolicy&& policy, RandomIterator first, RandomIterator last, Compare comp)
+    {
+        using policy_type = execution_detail::policy_t<ExecutionPolicy>;
+        if constexpr (execution_detail::is_parallel_v<policy_type> && is_contiguous_iterator<RandomIterator>)
+        {
+            if (static_cast<size_t>(last - first) >= policy.threshold())
+            {
+                stable_sort_paral(policy.pool(), first, last, comp);
+                return;
+            }
+        }
+        bitstl::stable_sort(first, last, comp);
+    }
+
+    template<typename ExecutionPolicy, typename RandomIterator>
+    execution_detail::enable_if_policy_t<ExecutionPolicy, void>
+        stable_sort(ExecutionPolicy&& policy, RandomIterator first, RandomIterator last)
+    {
+        bitstl::stable_sort(policy, first, last, std::less<>());
+    }
+}
+
+#endif // !EXECUTION_H
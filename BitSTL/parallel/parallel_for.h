@@ -0,0 +1,286 @@
+/*
+ * 多维下标空间上的并行循环
+ * blocked_range、blocked_range2d、blocked_range3d描述下标区间及各维的粒度，parallel_for将区间沿相对粒度最长的一维
+ * 递归二分，直到各维都不超过粒度，得到的块（tile）按递归的顺序排列，相邻的块在空间上也相邻，再以划分器分给线程
+ * 对矩阵与网格，块的大小取能同时放入缓存的输入与输出，按块访问时每个缓存行在被换出之前即被充分使用
+ */
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.h"
+#include "partitioner.h"
+
+namespace bitstl
+{
+    // 一维下标区间[begin, end)，长度超过grain时可分割
+    template<typename Value>
+    class blocked_range
+    {
+    public:
+        using value_type = Value;
+
+        blocked_range(Value _begin, Value _end, std::size_t _grain = 1)
+            : begin_(_begin), end_(_end), grain_(_grain ? _grain : 1)
+        {
+            assert(!(_end < _begin));
+        }
+
+        Value begin()
+            const noexcept
+        {
+            return begin_;
+        }
+
+        Value end()
+            const noexcept
+        {
+            return end_;
+        }
+
+        std::size_t size()
+            const noexcept
+        {
+            return static_cast<std::size_t>(end_ - begin_);
+        }
+
+        std::size_t grain()
+            const noexcept
+        {
+            return grain_;
+        }
+
+        bool empty()
+            const noexcept
+        {
+            return !(begin_ < end_);
+        }
+
+        bool is_divisible()
+            const noexcept
+        {
+            return size() > grain_;
+        }
+
+        // 自身保留前一半，返回后一半
+        blocked_range split()
+        {
+            const Value middle = begin_ + static_cast<Value>(size() / 2);
+            blocked_range second(middle, end_, grain_);
+            end_ = middle;
+            return second;
+        }
+
+    private:
+        Value begin_;
+        Value end_;
+        std::size_t grain_;
+    };
+
+    namespace parallel_for_detail
+    {
+        // a相对粒度不短于b且可分割，或b不可分割时，分割a
+        template<typename RangeA, typename RangeB>
+        bool split_first(const RangeA& a, const RangeB& b)
+            noexcept
+        {
+            if (!b.is_divisible())
+                return true;
+            if (!a.is_divisible())
+                return false;
+            return a.size() * b.grain() >= b.size() * a.grain();
+        }
+    }
+
+    /*
+     * 二维下标区间，rows()为行，cols()为列
+     * 默认粒度为64 × 64，8字节的元素每块32KB，转置等同时访问两个数组的操作共64KB，可放入L2缓存
+     */
+    template<typename RowValue, typename ColValue = RowValue>
+    class blocked_range2d
+    {
+    public:
+        static constexpr std::size_t default_grain = 64;
+
+        using row_range_type = blocked_range<RowValue>;
+        using col_range_type = blocked_range<ColValue>;
+
+        blocked_range2d(RowValue row_begin, RowValue row_end, std::size_t row_grain,
+            ColValue col_begin, ColValue col_end, std::size_t col_grain)
+            : rows_(row_begin, row_end, row_grain), cols_(col_begin, col_end, col_grain) {}
+
+        blocked_range2d(RowValue row_begin, RowValue row_end, ColValue col_begin, ColValue col_end)
+            : blocked_range2d(row_begin, row_end, default_grain, col_begin, col_end, default_grain) {}
+
+        const row_range_type& rows()
+            const noexcept
+        {
+            return rows_;
+        }
+
+        const col_range_type& cols()
+            const noexcept
+        {
+            return cols_;
+        }
+
+        bool empty()
+            const noexcept
+        {
+            return rows_.empty() || cols_.empty();
+        }
+
+        bool is_divisible()
+            const noexcept
+        {
+            return rows_.is_divisible() || cols_.is_divisible();
+        }
+
+        // 分割相对粒度更长的一维，块趋近于粒度的形状
+        blocked_range2d split()
+        {
+            blocked_range2d second(*this);
+            if (parallel_for_detail::split_first(rows_, cols_))
+                second.rows_ = rows_.split();
+            else
+                second.cols_ = cols_.split();
+            return second;
+        }
+
+    private:
+        row_range_type rows_;
+        col_range_type cols_;
+    };
+
+    /*
+     * 三维下标区间，pages()为最外层一维，默认粒度为16 × 16 × 16，8字节的元素每块32KB
+     * 模板计算等沿最内层连续访问的操作宜将cols的粒度取为整行，只分割外两维，最内层循环足够长才能向量化与预取
+     */
+    template<typename PageValue, typename RowValue = PageValue, typename ColValue = RowValue>
+    class blocked_range3d
+    {
+    public:
+        static constexpr std::size_t default_grain = 16;
+
+        using page_range_type = blocked_range<PageValue>;
+        using row_range_type = blocked_range<RowValue>;
+        using col_range_type = blocked_range<ColValue>;
+
+        blocked_range3d(PageValue page_begin, PageValue page_end, std::size_t page_grain,
+            RowValue row_begin, RowValue row_end, std::size_t row_grain,
+            ColValue col_begin, ColValue col_end, std::size_t col_grain)
+            : pages_(page_begin, page_end, page_grain), rows_(row_begin, row_end, row_grain), cols_(col_begin, col_end, col_grain) {}
+
+        blocked_range3d(PageValue page_begin, PageValue page_end, RowValue row_begin, RowValue row_end,
+            ColValue col_begin, ColValue col_end)
+            : blocked_range3d(page_begin, page_end, default_grain, row_begin, row_end, default_grain,
+                col_begin, col_end, default_grain) {}
+
+        const page_range_type& pages()
+            const noexcept
+        {
+            return pages_;
+        }
+
+        const row_range_type& rows()
+            const noexcept
+        {
+            return rows_;
+        }
+
+        const col_range_type& cols()
+            const noexcept
+        {
+            return cols_;
+        }
+
+        bool empty()
+            const noexcept
+        {
+            return pages_.empty() || rows_.empty() || cols_.empty();
+        }
+
+        bool is_divisible()
+            const noexcept
+        {
+            return pages_.is_divisible() || rows_.is_divisible() || cols_.is_divisible();
+        }
+
+        blocked_range3d split()
+        {
+            blocked_range3d second(*this);
+            if (parallel_for_detail::split_first(pages_, rows_) && parallel_for_detail::split_first(pages_, cols_))
+                second.pages_ = pages_.split();
+            else if (parallel_for_detail::split_first(rows_, cols_))
+                second.rows_ = rows_.split();
+            else
+                second.cols_ = cols_.split();
+            return second;
+        }
+
+    private:
+        page_range_type pages_;
+        row_range_type rows_;
+        col_range_type cols_;
+    };
+
+    namespace parallel_for_detail
+    {
+        // 递归二分直到不可分割，块按深度优先的顺序存入tiles
+        template<typename Range>
+        void split_tiles(Range range, std::vector<Range>& tiles)
+        {
+            while (range.is_divisible())
+            {
+                Range second = range.split();
+                split_tiles(range, tiles);
+                range = second;
+            }
+            tiles.push_back(range);
+        }
+    }
+
+    /*
+     * 对range的每一块调用body(tile)，tile与range类型相同
+     * 块按递归二分的顺序编号，partitioner（默认为auto_partitioner）划分的是块的编号，每个线程领取的是空间上相邻的若干块
+     */
+    template<typename Range, typename Body, typename Partitioner, std::enable_if_t<is_partitioner_v<Partitioner>, int> = 0>
+    void parallel_for(thread_pool& pool, const Range& range, Body body, Partitioner&& partitioner)
+    {
+        if (range.empty())
+            return;
+
+        std::vector<Range> tiles;
+        parallel_for_detail::split_tiles(range, tiles);
+        auto process = [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                    body(static_cast<const Range&>(tiles[i]));
+            };
+        partitioner.run(pool, tiles.size(), process);
+    }
+
+    template<typename Range, typename Body>
+    void parallel_for(thread_pool& pool, const Range& range, Body body)
+    {
+        parallel_for(pool, range, body, auto_partitioner());
+    }
+
+    template<typename Range, typename Body, typename Partitioner, std::enable_if_t<is_partitioner_v<Partitioner>, int> = 0>
+    void parallel_for(const Range& range, Body body, Partitioner&& partitioner)
+    {
+        parallel_for(thread_pool::default_pool(), range, body, partitioner);
+    }
+
+    template<typename Range, typename Body>
+    void parallel_for(const Range& range, Body body)
+    {
+        parallel_for(thread_pool::default_pool(), range, body);
+    }
+}
+
+#endif // !PARALLEL_FOR_H
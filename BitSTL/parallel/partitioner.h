@@ -0,0 +1,242 @@
+/*
+ * 划分器
+ * 决定如何把下标区间[0, n)切分为块并分配给线程池中的线程，body(begin, end)处理一块
+ * static_partitioner按并发数等分为连续块；dynamic_partitioner以固定粒度动态领取；
+ * guided_partitioner领取剩余量的一部分，块逐渐变小；auto_partitioner先测量每个元素的耗时再选择粒度
+ */
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+
+#include "thread_pool.h"
+
+namespace bitstl
+{
+    // 按并发数等分为连续块，每块至少min_grain个元素；调度开销最小，适用于各元素耗时相同的情形
+    class static_partitioner
+    {
+    public:
+        explicit static_partitioner(std::size_t min_grain = 1)
+            noexcept : min_grain_(min_grain ? min_grain : 1) {}
+
+        std::size_t min_grain()
+            const noexcept
+        {
+            return min_grain_;
+        }
+
+        template<typename Body>
+        void run(thread_pool& pool, std::size_t n, Body& body)
+            const
+        {
+            if (!n)
+                return;
+            const std::size_t chunk_num = std::min(pool.concurrency(), (n - 1) / min_grain_ + 1);
+            const std::size_t q = n / chunk_num, r = n % chunk_num;
+            auto process = [&](std::size_t t)
+                {
+                    body(t * q + std::min(t, r), (t + 1) * q + std::min(t + 1, r));
+                };
+            pool.run(chunk_num, process);
+        }
+
+    private:
+        std::size_t min_grain_;
+    };
+
+    // 线程以原子计数器依次领取grain个元素，耗时不均时空闲的线程继续领取剩余的块
+    class dynamic_partitioner
+    {
+    public:
+        explicit dynamic_partitioner(std::size_t grain = 1024)
+            noexcept : grain_(grain ? grain : 1) {}
+
+        std::size_t grain()
+            const noexcept
+        {
+            return grain_;
+        }
+
+        template<typename Body>
+        void run(thread_pool& pool, std::size_t n, Body& body)
+            const
+        {
+            if (!n)
+                return;
+            const std::size_t worker_num = std::min(pool.concurrency(), (n - 1) / grain_ + 1);
+            std::atomic<std::size_t> next(0);
+            auto process = [&](std::size_t)
+                {
+                    for (;;)
+                    {
+                        const std::size_t begin = next.fetch_add(grain_, std::memory_order_relaxed);
+                        if (begin >= n)
+                            return;
+                        body(begin, std::min(n, begin + grain_));
+                    }
+                };
+            pool.run(worker_num, process);
+        }
+
+    private:
+        std::size_t grain_;
+    };
+
+    /*
+     * 每次领取剩余元素数的1 / 2p（p为线程数），但不少于min_grain个
+     * 开始时块大、领取次数少，接近结束时块小，最后完成的线程不会拖后太久
+     */
+    class guided_partitioner
+    {
+    public:
+        explicit guided_partitioner(std::size_t min_grain = 1)
+            noexcept : min_grain_(min_grain ? min_grain : 1) {}
+
+        std::size_t min_grain()
+            const noexcept
+        {
+            return min_grain_;
+        }
+
+        template<typename Body>
+        void run(thread_pool& pool, std::size_t n, Body& body)
+            const
+        {
+            if (!n)
+                return;
+            const std::size_t worker_num = std::min(pool.concurrency(), (n - 1) / min_grain_ + 1);
+            std::atomic<std::size_t> next(0);
+            auto process = [&](std::size_t)
+                {
+                    std::size_t begin = next.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        if (begin >= n)
+                            return;
+                        const std::size_t size = std::max(min_grain_, (n - begin) / (2 * worker_num));
+                        const std::size_t end = std::min(n, begin + size);
+                        if (next.compare_exchange_weak(begin, end, std::memory_order_relaxed))
+                        {
+                            body(begin, end);
+                            begin = next.load(std::memory_order_relaxed);
+                        }
+                    }
+                };
+            pool.run(worker_num, process);
+        }
+
+    private:
+        std::size_t min_grain_;
+    };
+
+    /*
+     * 在当前线程依次处理1、2、4……个元素，直到耗时达到sample_time，得到每个元素的平均耗时
+     * 剩余元素的预计耗时不足一块时在当前线程完成，否则取粒度使每块耗时约为chunk_time，
+     * 且每个线程至少分到4块，再以dynamic_partitioner处理剩余元素
+     * 元素很少或很廉价时不会唤醒其它线程，元素很昂贵时块小到足以均衡负载
+     * run会记录选择的粒度，同一个auto_partitioner对象不能同时用于多个调用
+     */
+    class auto_partitioner
+    {
+    public:
+        using duration = std::chrono::nanoseconds;
+
+        explicit auto_partitioner(duration chunk_time = std::chrono::microseconds(100),
+            duration sample_time = std::chrono::microseconds(10))
+            noexcept : chunk_time_(chunk_time), sample_time_(sample_time) {}
+
+        duration chunk_time()
+            const noexcept
+        {
+            return chunk_time_;
+        }
+
+        duration sample_time()
+            const noexcept
+        {
+            return sample_time_;
+        }
+
+        // 上一次run选择的粒度，在当前线程完成时为0
+        std::size_t last_grain()
+            const noexcept
+        {
+            return last_grain_;
+        }
+
+        template<typename Body>
+        void run(thread_pool& pool, std::size_t n, Body& body)
+        {
+            last_grain_ = 0;
+            if (!n)
+                return;
+            if (pool.concurrency() == 1)
+            {
+                body(0, n);
+                return;
+            }
+
+            using clock = std::chrono::steady_clock;
+            const clock::time_point start = clock::now();
+            std::size_t done = 0;
+            duration elapsed(0);
+            for (std::size_t size = 1; done < n; size *= 2)
+            {
+                const std::size_t end = std::min(n, done + size);
+                body(done, end);
+                done = end;
+                elapsed = std::chrono::duration_cast<duration>(clock::now() - start);
+                if (elapsed >= sample_time_)
+                    break;
+            }
+            const std::size_t remaining = n - done;
+            if (!remaining)
+                return;
+
+            const double per_element = std::max(1.0, static_cast<double>(elapsed.count())) / done;
+            if (per_element * remaining <= chunk_time_.count())
+            {
+                body(done, n);
+                return;
+            }
+
+            const std::size_t max_grain = (remaining - 1) / (4 * pool.concurrency()) + 1;
+            const double grain = std::clamp(chunk_time_.count() / per_element, 1.0, static_cast<double>(max_grain));
+            last_grain_ = static_cast<std::size_t>(grain);
+            auto offset_body = [&body, done](std::size_t begin, std::size_t end)
+                {
+                    body(done + begin, done + end);
+                };
+            dynamic_partitioner(last_grain_).run(pool, remaining, offset_body);
+        }
+
+    private:
+        duration chunk_time_;
+        duration sample_time_;
+        std::size_t last_grain_ = 0;
+    };
+
+    template<typename T>
+    struct is_partitioner : std::false_type {};
+
+    template<>
+    struct is_partitioner<static_partitioner> : std::true_type {};
+
+    template<>
+    struct is_partitioner<dynamic_partitioner> : std::true_type {};
+
+    template<>
+    struct is_partitioner<guided_partitioner> : std::true_type {};
+
+    template<>
+    struct is_partitioner<auto_partitioner> : std::true_type {};
+
+    template<typename T>
+    inline constexpr bool is_partitioner_v = is_partitioner<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+}
+
+#endif // !PARTITIONER_H
@@ -0,0 +1,509 @@
+/*
+ * 多阶段流水线
+ * 源函数依次产生元素并编号，各阶段之间以bounded_queue_ts相连：下游处理不过来时上游阻塞在已满的队列上（反压）
+ * 源函数产生元素前须取得一个令牌，元素流过最后一个阶段后归还，在途的元素数（含按序阶段暂存的元素）不超过令牌数
+ * 阶段分为三种：serial_in_order按编号顺序逐个处理，serial_out_of_order按到达顺序逐个处理，parallel由多个线程同时处理
+ * 阶段在专用线程上运行而非thread_pool：阶段会阻塞在队列上，占用池中的线程可能使其它任务无法执行
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "threadsafe/bounded_queue_ts.h"
+
+namespace bitstl
+{
+    enum class stage_mode
+    {
+        serial_in_order,
+        serial_out_of_order,
+        parallel
+    };
+
+    // 一个阶段的运行统计，源函数也作为一个阶段统计（没有输入队列）
+    struct pipeline_stage_stats
+    {
+        std::string name;
+        stage_mode mode = stage_mode::serial_in_order;
+        std::size_t threads = 0;
+        std::size_t tokens = 0;      // 输入队列的容量
+        std::size_t items = 0;
+        double seconds = 0;          // 从流水线开始运行到该阶段的最后一个线程结束
+        double busy_seconds = 0;     // 各线程执行阶段函数的时间之和
+        queue_occupancy queue;       // 输入队列的占用情况
+
+        // 每秒处理的元素数
+        double throughput()
+            const noexcept
+        {
+            return seconds > 0 ? items / seconds : 0;
+        }
+
+        // 线程执行阶段函数的时间占比，接近1的阶段为瓶颈
+        double utilization()
+            const noexcept
+        {
+            return seconds > 0 && threads ? busy_seconds / (seconds * threads) : 0;
+        }
+    };
+
+    class pipeline;
+
+    template<typename T>
+    class pipeline_builder;
+
+    namespace pipeline_detail
+    {
+        using clock = std::chrono::steady_clock;
+
+        inline constexpr std::size_t default_tokens = 16;
+
+        // 队列中的元素，seq为源函数产生的顺序
+        template<typename T>
+        struct token
+        {
+            std::size_t seq = 0;
+            std::optional<T> value;
+        };
+
+        template<typename T>
+        using queue_type = bounded_queue_ts<token<T>>;
+
+        // 所有阶段共享的运行状态
+        struct context
+        {
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> aborted{ false };
+            clock::time_point start;
+            std::mutex mtx;
+            std::exception_ptr error;
+            std::vector<std::function<void()>> closers;  // 关闭各阶段的输入队列
+
+            // 令牌，由mtx保护
+            std::condition_variable token_cond;
+            std::size_t max_in_flight = 0;
+            std::size_t in_flight = 0;
+
+            // 在途的元素数达到上限时阻塞，中止时返回false
+            bool acquire_token()
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                token_cond.wait(lk, [this] { return in_flight < max_in_flight || aborted; });
+                if (aborted)
+                    return false;
+                ++in_flight;
+                return true;
+            }
+
+            void release_token()
+            {
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    --in_flight;
+                }
+                token_cond.notify_one();
+            }
+
+            // 记录首个异常并关闭所有队列，阻塞在队列上或等待令牌的线程随即返回，剩余的元素被丢弃
+            void fail(std::exception_ptr e)
+            {
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    if (!error)
+                        error = e;
+                    aborted = true;
+                }
+                token_cond.notify_all();
+                for (auto& close : closers)
+                    close();
+            }
+        };
+
+        class stage_base
+        {
+        public:
+            stage_base(std::string _name, stage_mode _mode, std::size_t _threads)
+                : name_(std::move(_name)), mode_(_mode), threads_(_threads) {}
+
+            virtual ~stage_base() = default;
+
+            virtual void start(context& ctx, std::vector<std::thread>& threads) = 0;
+
+            // 该阶段最多持有的元素数：输入队列的容量与线程数之和
+            virtual std::size_t capacity()
+                const
+            {
+                return threads_;
+            }
+
+            virtual pipeline_stage_stats stats()
+                const
+            {
+                pipeline_stage_stats result;
+                result.name = name_;
+                result.mode = mode_;
+                result.threads = threads_;
+                result.items = items_.load();
+                result.seconds = seconds_;
+                result.busy_seconds = busy_ns_.load() / 1e9;
+                return result;
+            }
+
+        protected:
+            void record(clock::time_point begin)
+            {
+                busy_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - begin).count();
+                ++items_;
+            }
+
+            // 该阶段的最后一个线程结束时返回true
+            bool finish(context& ctx)
+            {
+                if (active_.fetch_sub(1) != 1)
+                    return false;
+                seconds_ = std::chrono::duration<double>(clock::now() - ctx.start).count();
+                return true;
+            }
+
+            std::string name_;
+            stage_mode mode_;
+            std::size_t threads_;
+            std::atomic<std::size_t> active_{ 0 };
+            std::atomic<std::size_t> items_{ 0 };
+            std::atomic<long long> busy_ns_{ 0 };
+            double seconds_ = 0;
+        };
+
+        // 源：依次调用source()直到返回空的optional，或流水线被取消
+        template<typename T, typename Source>
+        class source_stage final : public stage_base
+        {
+        public:
+            source_stage(std::string _name, Source _source)
+                : stage_base(std::move(_name), stage_mode::serial_in_order, 1), source_(std::move(_source)) {}
+
+            queue_type<T>*& output()
+            {
+                return out_;
+            }
+
+            void start(context& ctx, std::vector<std::thread>& threads) override
+            {
+                active_ = 1;
+                threads.emplace_back([this, &ctx] { run(ctx); });
+            }
+
+        private:
+            void run(context& ctx)
+            {
+                try
+                {
+                    for (std::size_t seq = 0; !ctx.cancelled && !ctx.aborted; ++seq)
+                    {
+                        if (!ctx.acquire_token() || ctx.cancelled)
+                            break;
+                        const clock::time_point begin = clock::now();
+                        std::optional<T> value = source_();
+                        if (!value)
+                            break;
+                        record(begin);
+                        if (!out_->push(token<T>{ seq, std::move(value) }))
+                            break;
+                    }
+                }
+                catch (...)
+                {
+                    ctx.fail(std::current_exception());
+                }
+                finish(ctx);
+                out_->close();
+            }
+
+            Source source_;
+            queue_type<T>* out_ = nullptr;
+        };
+
+        // 以f将In变换为Out的阶段，Out为void时为最后一个阶段
+        template<typename In, typename Out, typename Func>
+        class stage final : public stage_base
+        {
+        public:
+            stage(std::string _name, stage_mode _mode, Func _f, std::size_t tokens)
+                : stage_base(std::move(_name), _mode, _mode == stage_mode::parallel ? worker_count(tokens) : 1),
+                f_(std::move(_f)), in_(tokens) {}
+
+            queue_type<In>* input()
+            {
+                return &in_;
+            }
+
+            queue_type<Out>*& output()
+                requires (!std::is_void_v<Out>)
+            {
+                return out_;
+            }
+
+            void start(context& ctx, std::vector<std::thread>& threads) override
+            {
+                active_ = threads_;
+                for (std::size_t i = 0; i < threads_; ++i)
+                    threads.emplace_back([this, &ctx] { run(ctx); });
+            }
+
+            std::size_t capacity()
+                const override
+            {
+                return in_.capacity() + threads_;
+            }
+
+            pipeline_stage_stats stats()
+                const override
+            {
+                pipeline_stage_stats result = stage_base::stats();
+                result.tokens = in_.capacity();
+                result.queue = in_.stats();
+                return result;
+            }
+
+        private:
+            // parallel阶段的线程数为tokens，但不超过硬件线程数
+            static std::size_t worker_count(std::size_t tokens)
+            {
+                const std::size_t hardware_threads = std::thread::hardware_concurrency();
+                return std::max<std::size_t>(1, std::min(tokens, hardware_threads ? hardware_threads : 1));
+            }
+
+            void run(context& ctx)
+            {
+                try
+                {
+                    token<In> t;
+                    if (mode_ == stage_mode::serial_in_order)
+                    {
+                        // 先到的元素暂存，直到编号更小的元素都已处理；暂存的元素已取得令牌，其数目不超过令牌数
+                        // 不能在暂存满时停止读取队列：持有编号next的线程可能正阻塞在已被后续元素填满的队列上
+                        std::map<std::size_t, std::optional<In>> pending;
+                        std::size_t next = 0;
+                        while (!ctx.aborted && in_.wait_and_pop(t))
+                        {
+                            pending.emplace(t.seq, std::move(t.value));
+                            for (auto it = pending.begin(); it != pending.end() && it->first == next; it = pending.begin())
+                            {
+                                std::optional<In> value = std::move(it->second);
+                                pending.erase(it);
+                                if (!process(next++, std::move(*value), ctx))
+                                    break;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        while (!ctx.aborted && in_.wait_and_pop(t))
+                            if (!process(t.seq, std::move(*t.value), ctx))
+                                break;
+                    }
+                }
+                catch (...)
+                {
+                    ctx.fail(std::current_exception());
+                }
+                if (finish(ctx))
+                {
+                    if constexpr (!std::is_void_v<Out>)
+                        out_->close();
+                }
+            }
+
+            // 下游队列已关闭（流水线中止）时返回false
+            bool process(std::size_t seq, In&& value, context& ctx)
+            {
+                const clock::time_point begin = clock::now();
+                if constexpr (std::is_void_v<Out>)
+                {
+                    f_(std::move(value));
+                    record(begin);
+                    ctx.release_token();
+                    return true;
+                }
+                else
+                {
+                    token<Out> result{ seq, std::optional<Out>(f_(std::move(value))) };
+                    record(begin);
+                    return out_->push(std::move(result));
+                }
+            }
+
+            Func f_;
+            queue_type<In> in_;
+            std::conditional_t<std::is_void_v<Out>, std::nullptr_t, queue_type<Out>*> out_ = nullptr;
+        };
+    }
+
+    /*
+     * 由make_pipeline(...).then(...)...sink(...)构造
+     * run阻塞直到源函数结束且所有元素都流过最后一个阶段；阶段函数抛出的首个异常在所有线程结束后重新抛出
+     */
+    class pipeline
+    {
+    public:
+        pipeline(pipeline&&) noexcept = default;
+        pipeline& operator=(pipeline&&) noexcept = default;
+
+        // 只能运行一次
+        void run()
+        {
+            assert(!ran_);
+            ran_ = true;
+            ctx_->max_in_flight = max_in_flight();
+            ctx_->start = pipeline_detail::clock::now();
+            std::vector<std::thread> threads;
+            try
+            {
+                for (auto& s : stages_)
+                    s->start(*ctx_, threads);
+            }
+            catch (...)
+            {
+                ctx_->fail(std::current_exception());
+            }
+            for (auto& t : threads)
+                t.join();
+            if (ctx_->error)
+                std::rethrow_exception(ctx_->error);
+        }
+
+        // 源函数不再产生新元素，已产生的元素仍流过所有阶段后run才返回；可在阶段函数或其它线程中调用
+        void cancel()
+            noexcept
+        {
+            ctx_->cancelled = true;
+        }
+
+        // 设置在途元素数的上限，0表示使用默认值（各阶段的队列容量与线程数之和），须在run之前调用
+        pipeline& max_in_flight(std::size_t n)
+            noexcept
+        {
+            max_in_flight_ = n;
+            return *this;
+        }
+
+        std::size_t max_in_flight()
+            const
+        {
+            if (max_in_flight_)
+                return max_in_flight_;
+            std::size_t result = 0;
+            for (auto& s : stages_)
+                result += s->capacity();
+            return result;
+        }
+
+        // 按阶段的顺序，第一个为源函数
+        std::vector<pipeline_stage_stats> stats()
+            const
+        {
+            std::vector<pipeline_stage_stats> result;
+            for (auto& s : stages_)
+                result.push_back(s->stats());
+            return result;
+        }
+
+    private:
+        template<typename T>
+        friend class pipeline_builder;
+
+        template<typename Source>
+        friend auto make_pipeline(std::string name, Source source);
+
+        pipeline() : ctx_(std::make_unique<pipeline_detail::context>()) {}
+
+        std::unique_ptr<pipeline_detail::context> ctx_;
+        std::vector<std::unique_ptr<pipeline_detail::stage_base>> stages_;
+        std::size_t max_in_flight_ = 0;
+        bool ran_ = false;
+    };
+
+    // T为上一阶段输出的类型
+    template<typename T>
+    class pipeline_builder
+    {
+    public:
+        // 添加阶段，f(T)的结果传给下一阶段；tokens为输入队列的容量，parallel阶段同时也是线程数（不超过硬件线程数）
+        template<typename Func>
+        auto then(std::string name, stage_mode mode, Func f, std::size_t tokens = pipeline_detail::default_tokens)
+            -> pipeline_builder<std::decay_t<std::invoke_result_t<Func&, T>>>
+        {
+            using Out = std::decay_t<std::invoke_result_t<Func&, T>>;
+            static_assert(!std::is_void_v<Out>, "use sink for the last stage");
+            auto s = std::make_unique<pipeline_detail::stage<T, Out, Func>>(std::move(name), mode, std::move(f), tokens);
+            queue_type<Out>*& next_tail = s->output();
+            connect(s);
+            return pipeline_builder<Out>(std::move(p_), next_tail);
+        }
+
+        // 添加最后一个阶段，f(T)的结果被忽略
+        template<typename Func>
+        pipeline sink(std::string name, stage_mode mode, Func f, std::size_t tokens = pipeline_detail::default_tokens)
+        {
+            auto s = std::make_unique<pipeline_detail::stage<T, void, Func>>(std::move(name), mode, std::move(f), tokens);
+            connect(s);
+            return std::move(p_);
+        }
+
+    private:
+        template<typename U>
+        friend class pipeline_builder;
+
+        template<typename Source>
+        friend auto make_pipeline(std::string name, Source source);
+
+        template<typename U>
+        using queue_type = pipeline_detail::queue_type<U>;
+
+        pipeline_builder(pipeline&& p, queue_type<T>*& tail) : p_(std::move(p)), tail_(&tail) {}
+
+        // 上一阶段输出到s的输入队列
+        template<typename Stage>
+        void connect(std::unique_ptr<Stage>& s)
+        {
+            queue_type<T>* q = s->input();
+            *tail_ = q;
+            p_.ctx_->closers.push_back([q] { q->close(); });
+            p_.stages_.push_back(std::move(s));
+        }
+
+        pipeline p_;
+        queue_type<T>** tail_;
+    };
+
+    // source()返回std::optional<T>，返回空的optional时结束
+    template<typename Source>
+    auto make_pipeline(std::string name, Source source)
+    {
+        using T = typename std::invoke_result_t<Source&>::value_type;
+        auto s = std::make_unique<pipeline_detail::source_stage<T, Source>>(std::move(name), std::move(source));
+        pipeline p;
+        pipeline_detail::queue_type<T>*& tail = s->output();
+        p.stages_.push_back(std::move(s));
+        return pipeline_builder<T>(std::move(p), tail);
+    }
+}
+
+#endif // !PIPELINE_H
@@ -0,0 +1,317 @@
+/*
+ * 线程同步原语：latch、barrier、phaser
+ * 等待时先自旋spin_count次，再以std::atomic::wait阻塞（Linux上为futex，Windows上为WaitOnAddress），到达时才唤醒
+ * 到达时修改的计数与等待时读取的阶段号分处不同的缓存行，等待者自旋时不会与到达者争抢同一缓存行
+ */
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace bitstl
+{
+    namespace sync_detail
+    {
+        inline constexpr int spin_count = 16;  // 阻塞前的自旋次数，线程数超过核数时自旋过久反而拖慢持有核的线程
+
+        // 自旋时提示处理器，减少流水线的空转与同核超线程的争用
+        inline void cpu_pause()
+            noexcept
+        {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        // 等待a的值不再为old：前一半自旋只读取，后一半让出时间片，之后阻塞
+        template<typename T>
+        void wait_while_equal(const std::atomic<T>& a, T old)
+            noexcept
+        {
+            for (int i = 0; i < spin_count; ++i)
+            {
+                if (a.load(std::memory_order_acquire) != old)
+                    return;
+                if (i < spin_count / 2)
+                    cpu_pause();
+                else
+                    std::this_thread::yield();
+            }
+            while (a.load(std::memory_order_acquire) == old)
+                a.wait(old, std::memory_order_acquire);
+        }
+
+        struct empty_completion
+        {
+            void operator()()
+                noexcept {}
+        };
+    }
+
+    // 一次性的倒计数，计数减为0时唤醒所有等待者
+    class latch
+    {
+    public:
+        explicit latch(std::ptrdiff_t expected)
+            : counter_(expected)
+        {
+            assert(expected >= 0);
+        }
+
+        latch(const latch&) = delete;
+        latch& operator=(const latch&) = delete;
+
+        void count_down(std::ptrdiff_t n = 1)
+        {
+            const std::ptrdiff_t old = counter_.fetch_sub(n, std::memory_order_acq_rel);
+            assert(old >= n);
+            if (old == n)
+                counter_.notify_all();
+        }
+
+        bool try_wait()
+            const noexcept
+        {
+            return counter_.load(std::memory_order_acquire) == 0;
+        }
+
+        void wait()
+            const noexcept
+        {
+            for (;;)
+            {
+                const std::ptrdiff_t current = counter_.load(std::memory_order_acquire);
+                if (current == 0)
+                    return;
+                sync_detail::wait_while_equal(counter_, current);
+            }
+        }
+
+        void arrive_and_wait(std::ptrdiff_t n = 1)
+        {
+            count_down(n);
+            wait();
+        }
+
+    private:
+        alignas(64) std::atomic<std::ptrdiff_t> counter_;
+    };
+
+    /*
+     * 可重复使用的线程栅栏，每个阶段expected个线程到达后由最后到达的线程调用completion，再进入下一阶段
+     * arrive_and_drop到达并退出此后的所有阶段
+     */
+    template<typename CompletionFunction = sync_detail::empty_completion>
+    class barrier
+    {
+    public:
+        // arrive返回的凭证，记录到达时的阶段
+        class arrival_token
+        {
+            friend class barrier;
+            std::uint32_t phase;
+            explicit arrival_token(std::uint32_t _phase) : phase(_phase) {}
+        };
+
+        explicit barrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction())
+            : expected_(expected), completion_(std::move(completion)), remaining_(expected), phase_(0)
+        {
+            assert(expected > 0);
+        }
+
+        barrier(const barrier&) = delete;
+        barrier& operator=(const barrier&) = delete;
+
+        [[nodiscard]] arrival_token arrive(std::ptrdiff_t n = 1)
+        {
+            const std::uint32_t phase = phase_.load(std::memory_order_relaxed);
+            const std::ptrdiff_t old = remaining_.fetch_sub(n, std::memory_order_acq_rel);
+            assert(old >= n);
+            if (old == n)
+            {
+                // 最后到达的线程：其它线程都在等待阶段号改变，此时可以安全地重置计数
+                completion_();
+                remaining_.store(expected_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                phase_.store(phase + 1, std::memory_order_release);
+                phase_.notify_all();
+            }
+            return arrival_token(phase);
+        }
+
+        void wait(arrival_token&& token)
+            const noexcept
+        {
+            sync_detail::wait_while_equal(phase_, token.phase);
+        }
+
+        void arrive_and_wait()
+        {
+            wait(arrive());
+        }
+
+        void arrive_and_drop()
+        {
+            expected_.fetch_sub(1, std::memory_order_relaxed);
+            (void)arrive();
+        }
+
+    private:
+        std::atomic<std::ptrdiff_t> expected_;  // 每个阶段需要到达的线程数，arrive_and_drop时减少
+        CompletionFunction completion_;
+        alignas(64) std::atomic<std::ptrdiff_t> remaining_;  // 当前阶段尚未到达的线程数
+        alignas(64) std::atomic<std::uint32_t> phase_;
+    };
+
+    /*
+     * 参与者可动态注册与注销的栅栏（参考Java的Phaser）
+     * 状态打包在一个64位原子变量中，注册、到达、注销都只需一次CAS：
+     * 0至15位为本阶段尚未到达的参与者数，16至31位为参与者数，32位表示正在推进阶段，33至63位为阶段号
+     * 最后到达的线程置推进标志，调用completion后写入下一阶段的状态，再唤醒等待者；推进期间注册的线程等待推进结束
+     */
+    template<typename CompletionFunction = sync_detail::empty_completion>
+    class phaser
+    {
+    public:
+        static constexpr std::uint32_t max_parties = 0xffff;
+
+        explicit phaser(std::uint32_t parties = 0, CompletionFunction completion = CompletionFunction())
+            : completion_(std::move(completion)), state_(make_state(0, parties, parties)), released_(0)
+        {
+            assert(parties <= max_parties);
+        }
+
+        phaser(const phaser&) = delete;
+        phaser& operator=(const phaser&) = delete;
+
+        // 注册一个参与者，返回其首次到达的阶段号
+        std::uint32_t register_party()
+        {
+            std::uint64_t s = state_.load(std::memory_order_acquire);
+            for (;;)
+            {
+                if (advancing(s))
+                {
+                    sync_detail::wait_while_equal(released_, phase_of(s));
+                    s = state_.load(std::memory_order_acquire);
+                    continue;
+                }
+                assert(parties_of(s) < max_parties);
+                if (state_.compare_exchange_weak(s, s + party_unit + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                    return phase_of(s);
+            }
+        }
+
+        // 到达而不等待，返回到达时的阶段号
+        std::uint32_t arrive()
+        {
+            return do_arrive(false);
+        }
+
+        // 到达并注销，此后的阶段不再等待该参与者
+        std::uint32_t arrive_and_deregister()
+        {
+            return do_arrive(true);
+        }
+
+        // 等待phase阶段结束，返回下一阶段的阶段号
+        std::uint32_t await_advance(std::uint32_t phase)
+            const noexcept
+        {
+            sync_detail::wait_while_equal(released_, phase);
+            return released_.load(std::memory_order_acquire);
+        }
+
+        std::uint32_t arrive_and_await_advance()
+        {
+            return await_advance(arrive());
+        }
+
+        std::uint32_t phase()
+            const noexcept
+        {
+            return released_.load(std::memory_order_acquire);
+        }
+
+        std::uint32_t registered_parties()
+            const noexcept
+        {
+            return parties_of(state_.load(std::memory_order_acquire));
+        }
+
+        std::uint32_t unarrived_parties()
+            const noexcept
+        {
+            return unarrived_of(state_.load(std::memory_order_acquire));
+        }
+
+    private:
+        static constexpr std::uint64_t party_unit = 1ull << 16;
+        static constexpr std::uint64_t advancing_bit = 1ull << 32;
+        static constexpr int phase_shift = 33;
+        static constexpr std::uint32_t phase_mask = 0x7fffffff;
+
+        static constexpr std::uint64_t make_state(std::uint32_t phase, std::uint32_t parties, std::uint32_t unarrived)
+        {
+            return (static_cast<std::uint64_t>(phase & phase_mask) << phase_shift)
+                | (static_cast<std::uint64_t>(parties) << 16) | unarrived;
+        }
+
+        static constexpr std::uint32_t unarrived_of(std::uint64_t s) { return static_cast<std::uint32_t>(s & 0xffff); }
+        static constexpr std::uint32_t parties_of(std::uint64_t s) { return static_cast<std::uint32_t>((s >> 16) & 0xffff); }
+        static constexpr bool advancing(std::uint64_t s) { return s & advancing_bit; }
+        static constexpr std::uint32_t phase_of(std::uint64_t s) { return static_cast<std::uint32_t>(s >> phase_shift); }
+
+        std::uint32_t do_arrive(bool deregister)
+        {
+            std::uint64_t s = state_.load(std::memory_order_acquire);
+            for (;;)
+            {
+                // 上一阶段正在推进时，本次到达属于下一阶段
+                if (advancing(s))
+                {
+                    sync_detail::wait_while_equal(released_, phase_of(s));
+                    s = state_.load(std::memory_order_acquire);
+                    continue;
+                }
+                assert(unarrived_of(s) > 0);
+                std::uint64_t next = s - 1 - (deregister ? party_unit : 0);
+                const bool last = unarrived_of(s) == 1;
+                if (last)
+                    next |= advancing_bit;
+                if (!state_.compare_exchange_weak(s, next, std::memory_order_acq_rel, std::memory_order_acquire))
+                    continue;
+
+                const std::uint32_t phase = phase_of(s);
+                if (last)
+                {
+                    completion_();
+                    const std::uint32_t parties = parties_of(next);
+                    const std::uint32_t next_phase = (phase + 1) & phase_mask;
+                    state_.store(make_state(next_phase, parties, parties), std::memory_order_release);
+                    released_.store(next_phase, std::memory_order_release);
+                    released_.notify_all();
+                }
+                return phase;
+            }
+        }
+
+        CompletionFunction completion_;
+        alignas(64) std::atomic<std::uint64_t> state_;
+        alignas(64) std::atomic<std::uint32_t> released_;  // 已结束的阶段数，即当前阶段号，等待者在其上阻塞
+    };
+}
+
+#endif // !SYNC_H
@@ -0,0 +1,347 @@
+/*
+ * 任务图（有向无环图）
+ * 节点为void()的函数，边表示先后关系。每个节点记录前驱数，运行时以原子计数器倒数，减为0时进入就绪队列，
+ * 不需要任何线程阻塞在future上等待前驱
+ * 就绪队列按优先级排序，每有一个节点就绪就向thread_pool提交一个任务，该任务取出当时优先级最高的节点执行
+ * 图的结构在多次run之间保留，每次run只重置计数器，同一个图可以反复运行
+ */
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace bitstl
+{
+    namespace task_graph_detail
+    {
+        struct node
+        {
+            std::function<void()> f;
+            int priority;
+            std::size_t order;  // 创建顺序，优先级相同时先创建的先执行
+            std::vector<node*> successors;
+            std::size_t dependencies = 0;  // 前驱数
+            std::atomic<std::size_t> pending{ 0 };  // 本次运行中尚未完成的前驱数
+
+            node(std::function<void()>&& _f, int _priority, std::size_t _order)
+                : f(std::move(_f)), priority(_priority), order(_order) {}
+        };
+
+        // 用于大顶堆：优先级高者在堆顶，相同时创建早者在堆顶
+        struct node_less
+        {
+            bool operator()(const node* a, const node* b)
+                const noexcept
+            {
+                return a->priority != b->priority ? a->priority < b->priority : a->order > b->order;
+            }
+        };
+    }
+
+    class task_graph
+    {
+        using node = task_graph_detail::node;
+
+    public:
+        // 图中节点的句柄，由emplace、then、when_all返回，图销毁或clear后失效
+        class task
+        {
+        public:
+            task() = default;
+
+            bool empty()
+                const noexcept
+            {
+                return node_ == nullptr;
+            }
+
+            int priority()
+                const noexcept
+            {
+                return node_->priority;
+            }
+
+            // 修改优先级，不能在run期间调用
+            task& priority(int p)
+                noexcept
+            {
+                node_->priority = p;
+                return *this;
+            }
+
+            std::size_t num_dependencies()
+                const noexcept
+            {
+                return node_->dependencies;
+            }
+
+            std::size_t num_successors()
+                const noexcept
+            {
+                return node_->successors.size();
+            }
+
+            // 本任务完成后others才能开始；任务为空或不属于同一个图时抛出std::invalid_argument
+            template<typename... Tasks>
+            task& precede(const Tasks&... others)
+            {
+                check_owner();
+                (graph_->check_member(others), ...);
+                (graph_->add_edge(*this, others), ...);
+                return *this;
+            }
+
+            // others都完成后本任务才能开始
+            template<typename... Tasks>
+            task& succeed(const Tasks&... others)
+            {
+                check_owner();
+                (graph_->check_member(others), ...);
+                (graph_->add_edge(others, *this), ...);
+                return *this;
+            }
+
+            // 创建在本任务完成后执行f的新任务
+            template<typename Func>
+            task then(Func&& f, int _priority = 0)
+            {
+                check_owner();
+                task next = graph_->emplace(std::forward<Func>(f), _priority);
+                precede(next);
+                return next;
+            }
+
+            friend bool operator==(const task& a, const task& b)
+                noexcept
+            {
+                return a.node_ == b.node_;
+            }
+
+        private:
+            friend class task_graph;
+
+            task(task_graph* graph, node* n)
+                noexcept : graph_(graph), node_(n) {}
+
+            void check_owner()
+                const
+            {
+                if (!graph_)
+                    throw std::invalid_argument("task_graph: empty task");
+            }
+
+            task_graph* graph_ = nullptr;
+            node* node_ = nullptr;
+        };
+
+        task_graph() = default;
+
+        task_graph(const task_graph&) = delete;
+        task_graph& operator=(const task_graph&) = delete;
+
+        // 添加执行f的任务，priority越大越先执行（只在同时就绪的任务之间比较）
+        template<typename Func>
+        task emplace(Func&& f, int priority = 0)
+        {
+            nodes_.push_back(std::make_unique<node>(std::function<void()>(std::forward<Func>(f)), priority, nodes_.size()));
+            changed_ = true;
+            return task(this, nodes_.back().get());
+        }
+
+        // 添加在[first, last)中的任务都完成后执行f的任务；其中有空任务或其它图的任务时抛出std::invalid_argument，不添加任务
+        template<typename InputIterator, typename Func>
+        task when_all(InputIterator first, InputIterator last, Func&& f, int priority = 0)
+        {
+            std::vector<task> dependencies(first, last);
+            for (const task& t : dependencies)
+                check_member(t);
+            task joined = emplace(std::forward<Func>(f), priority);
+            for (const task& t : dependencies)
+                add_edge(t, joined);
+            return joined;
+        }
+
+        template<typename Func>
+        task when_all(std::initializer_list<task> tasks, Func&& f, int priority = 0)
+        {
+            return when_all(tasks.begin(), tasks.end(), std::forward<Func>(f), priority);
+        }
+
+        std::size_t size()
+            const noexcept
+        {
+            return nodes_.size();
+        }
+
+        bool empty()
+            const noexcept
+        {
+            return nodes_.empty();
+        }
+
+        // 删除所有任务，已有的句柄失效
+        void clear()
+        {
+            assert(!running_);
+            nodes_.clear();
+            roots_.clear();
+            changed_ = false;
+        }
+
+        /*
+         * 执行所有任务，返回时全部完成；调用者在等待期间也执行池中的任务，因此可以在池中的任务里调用
+         * 任务抛出异常后尚未开始的任务不再执行，首个异常在run返回前重新抛出，图仍可再次运行
+         * 图中有环时抛出std::logic_error，不执行任何任务；同一个图不能同时运行
+         */
+        void run(thread_pool& pool)
+        {
+            assert(!running_);
+            if (nodes_.empty())
+                return;
+            if (changed_)
+                prepare();
+
+            running_ = true;
+            pool_ = &pool;
+            error_ = nullptr;
+            failed_.store(false, std::memory_order_relaxed);
+            remaining_.store(nodes_.size());
+            for (const auto& n : nodes_)
+                n->pending.store(n->dependencies, std::memory_order_relaxed);
+            for (node* root : roots_)
+                schedule(root);
+
+            pool.wait_until([this]() { return remaining_.load() == 0; });
+            running_ = false;
+            if (error_)
+                std::rethrow_exception(error_);
+        }
+
+        void run()
+        {
+            run(thread_pool::default_pool());
+        }
+
+    private:
+        void check_member(const task& t)
+            const
+        {
+            if (t.graph_ != this)
+                throw std::invalid_argument(t.graph_ ? "task_graph: task belongs to another graph" : "task_graph: empty task");
+        }
+
+        void add_edge(const task& from, const task& to)
+        {
+            assert(!running_);
+            check_member(from);
+            check_member(to);
+            from.node_->successors.push_back(to.node_);
+            ++to.node_->dependencies;
+            changed_ = true;
+        }
+
+        // 结构改变后的首次运行：找出没有前驱的节点，检查是否有环，为就绪队列预留空间使运行中不再分配内存
+        void prepare()
+        {
+            roots_.clear();
+            for (const auto& n : nodes_)
+                if (n->dependencies == 0)
+                    roots_.push_back(n.get());
+
+            std::vector<std::size_t> indegree(nodes_.size());
+            for (std::size_t i = 0; i < nodes_.size(); ++i)
+                indegree[i] = nodes_[i]->dependencies;
+            std::vector<node*> order(roots_);
+            for (std::size_t i = 0; i < order.size(); ++i)
+                for (node* s : order[i]->successors)
+                    if (--indegree[s->order] == 0)
+                        order.push_back(s);
+            if (order.size() != nodes_.size())
+                throw std::logic_error("task_graph: the graph contains a cycle");
+
+            ready_.clear();
+            ready_.reserve(nodes_.size());
+            changed_ = false;
+        }
+
+        // n的前驱都已完成：放入就绪队列，并为其提交一个池任务
+        void schedule(node* n)
+        {
+            {
+                std::lock_guard<std::mutex> lk(ready_mtx_);
+                ready_.push_back(n);
+                std::push_heap(ready_.begin(), ready_.end(), task_graph_detail::node_less());
+            }
+            try
+            {
+                pool_->post([this]() { execute_one(); });
+            }
+            catch (...)
+            {
+                // 提交失败时在当前线程执行，就绪的节点数与池任务数仍然相等
+                execute_one();
+            }
+        }
+
+        // 取出优先级最高的就绪节点执行，再对后继的计数器减1，减为0的后继就绪
+        void execute_one()
+            noexcept
+        {
+            node* n;
+            {
+                std::lock_guard<std::mutex> lk(ready_mtx_);
+                std::pop_heap(ready_.begin(), ready_.end(), task_graph_detail::node_less());
+                n = ready_.back();
+                ready_.pop_back();
+            }
+            if (!failed_.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    n->f();
+                }
+                catch (...)
+                {
+                    if (!failed_.exchange(true))
+                        error_ = std::current_exception();
+                }
+            }
+            for (node* s : n->successors)
+                if (s->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    schedule(s);
+
+            // 最后一个节点完成后run可能立即返回，此后不能再访问this
+            thread_pool* pool = pool_;
+            if (remaining_.fetch_sub(1) == 1)
+                pool->notify();
+        }
+
+        std::vector<std::unique_ptr<node>> nodes_;
+        std::vector<node*> roots_;  // 没有前驱的节点，prepare时求出
+        bool changed_ = false;  // 结构在上次prepare之后是否改变
+        bool running_ = false;
+
+        // 一次运行的状态
+        thread_pool* pool_ = nullptr;
+        std::mutex ready_mtx_;
+        std::vector<node*> ready_;  // 就绪节点的大顶堆，由ready_mtx_保护
+        std::atomic<std::size_t> remaining_{ 0 };  // 尚未完成的节点数
+        std::atomic<bool> failed_{ false };
+        std::exception_ptr error_;
+    };
+}
+
+#endif // !TASK_GRAPH_H
@@ -0,0 +1,392 @@
+/*
+ * 工作窃取线程池
+ * 每个工作线程持有一个work_stealing_deque，自己的任务后进先出，空闲时随机选择其它线程窃取
+ * 池外线程提交的任务进入共享的注入队列；没有任务时工作线程先自旋再阻塞，有新任务时才唤醒
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "threadsafe/work_stealing_deque.h"
+
+namespace bitstl
+{
+    class thread_pool
+    {
+    public:
+        // thread_count个工作线程，默认为hardware_concurrency - 1（调用者线程在等待时也会执行任务）
+        explicit thread_pool(std::size_t thread_count = default_thread_count())
+        {
+            if (thread_count == 0)
+                thread_count = 1;
+            workers_.reserve(thread_count);
+            for (std::size_t i = 0; i < thread_count; ++i)
+                workers_.push_back(std::make_unique<worker>());
+            try
+            {
+                for (std::size_t i = 0; i < thread_count; ++i)
+                    workers_[i]->thread = std::thread(&thread_pool::worker_loop, this, i);
+            }
+            catch (...)
+            {
+                shutdown();
+                throw;
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        // 执行完已提交的任务后退出
+        ~thread_pool()
+        {
+            shutdown();
+        }
+
+        // 进程内共享的线程池，parallel/中的算法默认使用
+        static thread_pool& default_pool()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        static std::size_t default_thread_count()
+            noexcept
+        {
+            const std::size_t hardware_threads = std::thread::hardware_concurrency();
+            return hardware_threads > 1 ? hardware_threads - 1 : 1;
+        }
+
+        std::size_t thread_count()
+            const noexcept
+        {
+            return workers_.size();
+        }
+
+        // 同时执行任务的线程数：工作线程加上等待结果的调用者
+        std::size_t concurrency()
+            const noexcept
+        {
+            return workers_.size() + 1;
+        }
+
+        // 提交任务，返回结果的future
+        template<typename Func>
+        auto submit(Func&& f) -> std::future<std::invoke_result_t<std::decay_t<Func>&>>
+        {
+            using result_type = std::invoke_result_t<std::decay_t<Func>&>;
+            std::packaged_task<result_type()> task(std::forward<Func>(f));
+            std::future<result_type> result = task.get_future();
+            push(make_task(std::move(task)));
+            return result;
+        }
+
+        // 提交不需要结果的任务，f抛出的异常不会被捕获
+        template<typename Func>
+        void post(Func&& f)
+        {
+            push(make_task(std::forward<Func>(f)));
+        }
+
+        /*
+         * 等待done()成立，期间执行池中的任务
+         * 使done()成立的线程随后须调用notify，唤醒已阻塞的等待者
+         */
+        template<typename Predicate>
+        void wait_until(Predicate done)
+        {
+            int idle = 0;
+            while (!done())
+            {
+                if (task_base* t = find_task())
+                {
+                    execute(t);
+                    idle = 0;
+                }
+                else if (++idle < spin_count)
+                    std::this_thread::yield();
+                else
+                {
+                    park(done);
+                    idle = 0;
+                }
+            }
+        }
+
+        void notify()
+        {
+            notify_waiters();
+        }
+
+        /*
+         * fork-join：执行f(0)至f(task_num - 1)，返回时全部完成
+         * f(task_num - 1)由调用者执行，之后调用者在等待期间执行池中的其它任务，因此可以在任务中嵌套调用
+         * 任务抛出的首个异常在所有任务结束后重新抛出
+         */
+        template<typename Func>
+        void run(std::size_t task_num, Func& f)
+        {
+            if (task_num == 0)
+                return;
+
+            task_group group(task_num);
+            std::size_t pushed = 0;
+            try
+            {
+                for (; pushed + 1 < task_num; ++pushed)
+                {
+                    push(make_task([this, &f, &group, i = pushed]()
+                        {
+                            if (group.invoke(f, i))
+                                notify_waiters();
+                        }));
+                }
+            }
+            catch (...)
+            {
+                // 未提交的任务与调用者自己的任务不再执行
+                group.remaining.fetch_sub(task_num - pushed);
+                wait(group);
+                throw;
+            }
+            group.invoke(f, task_num - 1);
+
+            wait(group);
+            if (group.error)
+                std::rethrow_exception(group.error);
+        }
+
+    private:
+        struct task_base
+        {
+            virtual ~task_base() = default;
+            virtual void execute() = 0;
+        };
+
+        template<typename Func>
+        struct task final : task_base
+        {
+            Func f;
+
+            explicit task(Func&& _f) : f(std::move(_f)) {}
+
+            void execute() override
+            {
+                f();
+            }
+        };
+
+        // run的一次调用，记录未完成的任务数与首个异常
+        struct task_group
+        {
+            std::atomic<std::size_t> remaining;
+            std::exception_ptr error;
+            std::atomic<bool> failed{ false };
+
+            explicit task_group(std::size_t n) : remaining(n) {}
+
+            // 返回是否为最后一个完成的任务，此后不能再访问group
+            template<typename Func>
+            bool invoke(Func& f, std::size_t i)
+                noexcept
+            {
+                try
+                {
+                    f(i);
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+                return remaining.fetch_sub(1) == 1;
+            }
+        };
+
+        struct worker
+        {
+            work_stealing_deque<task_base*> tasks;
+            std::thread thread;
+        };
+
+        static constexpr int spin_count = 64;  // 阻塞前的自旋次数
+
+        std::vector<std::unique_ptr<worker>> workers_;
+
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        std::deque<task_base*> injected_;  // 池外线程提交的任务，由mtx_保护
+        std::atomic<std::size_t> pending_{ 0 };  // 已提交而未被取走的任务数
+        std::atomic<std::size_t> sleeping_{ 0 }; // 阻塞中的线程数
+        std::atomic<bool> stop_{ false };
+
+        // 当前线程所属的线程池及其在池中的序号
+        inline static thread_local thread_pool* current_pool_ = nullptr;
+        inline static thread_local std::size_t current_index_ = 0;
+
+        template<typename Func>
+        static task_base* make_task(Func&& f)
+        {
+            return new task<std::decay_t<Func>>(std::forward<Func>(f));
+        }
+
+        static void execute(task_base* t)
+        {
+            std::unique_ptr<task_base> owner(t);
+            owner->execute();
+        }
+
+        // 池内线程压入自己的队列，池外线程压入注入队列
+        void push(task_base* t)
+        {
+            // 先计数再入队，被取走时pending_不会小于0
+            std::unique_ptr<task_base> owner(t);
+            pending_.fetch_add(1);
+            try
+            {
+                if (current_pool_ == this)
+                    workers_[current_index_]->tasks.push(t);
+                else
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    injected_.push_back(t);
+                }
+            }
+            catch (...)
+            {
+                pending_.fetch_sub(1);
+                throw;
+            }
+            owner.release();
+            // 与阻塞前的检查构成Dekker式同步：要么此处看到sleeping_，要么对方看到pending_
+            if (sleeping_.load())
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                cond_.notify_one();
+            }
+        }
+
+        // 唤醒在wait中阻塞的线程
+        void notify_waiters()
+        {
+            if (sleeping_.load())
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                cond_.notify_all();
+            }
+        }
+
+        task_base* find_task()
+        {
+            if (pending_.load() == 0)
+                return nullptr;
+            task_base* t = nullptr;
+            if (current_pool_ == this)
+                t = workers_[current_index_]->tasks.pop();
+            if (!t)
+                t = steal();
+            if (!t)
+                t = take_injected();
+            if (t)
+                pending_.fetch_sub(1);
+            return t;
+        }
+
+        // 从随机位置开始依次尝试窃取各工作线程
+        task_base* steal()
+        {
+            thread_local unsigned int seed = static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+            // xorshift
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+
+            const std::size_t n = workers_.size();
+            const std::size_t start = seed % n;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::size_t victim = (start + i) % n;
+                if (current_pool_ == this && victim == current_index_)
+                    continue;
+                if (task_base* t = workers_[victim]->tasks.steal())
+                    return t;
+            }
+            return nullptr;
+        }
+
+        task_base* take_injected()
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (injected_.empty())
+                return nullptr;
+            task_base* t = injected_.front();
+            injected_.pop_front();
+            return t;
+        }
+
+        // 阻塞直到有新任务或ready()成立
+        template<typename Predicate>
+        void park(Predicate ready)
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            sleeping_.fetch_add(1);
+            cond_.wait(lock, [&]() { return pending_.load() > 0 || ready(); });
+            sleeping_.fetch_sub(1);
+        }
+
+        void worker_loop(std::size_t index)
+        {
+            current_pool_ = this;
+            current_index_ = index;
+            int idle = 0;
+            while (true)
+            {
+                if (task_base* t = find_task())
+                {
+                    execute(t);
+                    idle = 0;
+                }
+                else if (stop_.load())
+                    return;
+                else if (++idle < spin_count)
+                    std::this_thread::yield();
+                else
+                {
+                    park([this]() { return stop_.load(); });
+                    idle = 0;
+                }
+            }
+        }
+
+        // 等待group完成，期间执行池中的任务
+        void wait(task_group& group)
+        {
+            wait_until([&group]() { return group.remaining.load() == 0; });
+        }
+
+        void shutdown()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop_.store(true);
+            }
+            cond_.notify_all();
+            for (auto& w : workers_)
+                if (w->thread.joinable())
+                    w->thread.join();
+        }
+    };
+}
+
+#endif // !THREAD_POOL_H
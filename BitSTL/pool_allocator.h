@@ -0,0 +1,417 @@
+/*
+ * 内存池分配器
+ * 参考《STL源码解析》的两级分配器
+ */
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <mutex>
+
+#include "config.h"
+#include "type_traits.h"
+#include "allocator.h"
+#include "allocator_traits.h"
+
+namespace bitstl
+{
+    /*
+     * 一级分配器
+     * 直接封装malloc、free、realloc，处理超过128bytes的内存
+     */
+    class malloc_alloc
+    {
+    public:
+        using oom_handler = void(*)();
+
+        static void* allocate(size_t n)
+        {
+            void* result = std::malloc(n);
+            if (!result)
+                result = oom_malloc(n);
+            return result;
+        }
+
+        static void deallocate(void* p, size_t)
+        {
+            std::free(p);
+        }
+
+        static void* reallocate(void* p, size_t, size_t new_size)
+        {
+            void* result = std::realloc(p, new_size);
+            if (!result)
+                result = oom_realloc(p, new_size);
+            return result;
+        }
+
+        // 仿照std::set_new_handler，返回旧的处理函数
+        static oom_handler set_malloc_handler(oom_handler f)
+        {
+            oom_handler old = handler_;
+            handler_ = f;
+            return old;
+        }
+
+    private:
+        inline static oom_handler handler_ = nullptr;
+
+        // 内存不足时不断调用处理函数并重试，未设置处理函数时抛出异常
+        static void* oom_malloc(size_t n)
+        {
+            for (;;)
+            {
+                if (!handler_)
+                    throw std::bad_alloc();
+                handler_();
+                if (void* result = std::malloc(n))
+                    return result;
+            }
+        }
+
+        static void* oom_realloc(void* p, size_t n)
+        {
+            for (;;)
+            {
+                if (!handler_)
+                    throw std::bad_alloc();
+                handler_();
+                if (void* result = std::realloc(p, n))
+                    return result;
+            }
+        }
+    };
+
+    /*
+     * 二级分配器
+     * 以链表形式的内存池管理不超过128bytes的内存，并将其上调为8的倍数
+     * 16个自由链表各自管理大小为8~128bytes的小额区块
+     * 《STL源码解析》中所有线程共用一组自由链表并加锁，这里改为每个线程独占一组，分配与释放无需加锁
+     * 线程退出时将其自由链表归还至全局，供其它线程取用
+     * 内存池中的内存直至程序结束才归还系统
+     */
+    class pool_alloc
+    {
+    public:
+        static constexpr size_t align         = 8;
+        static constexpr size_t max_bytes     = 128;
+        static constexpr size_t free_list_num = max_bytes / align;
+
+        // 上调至8的倍数
+        static constexpr size_t round_up(size_t bytes)
+            noexcept
+        {
+            return (bytes + align - 1) & ~(align - 1);
+        }
+
+        static void* allocate(size_t n)
+        {
+            if (n > max_bytes)
+                return malloc_alloc::allocate(n);
+            if (n == 0)
+                n = 1;
+
+            local_pool& pool = local_;
+            if (!pool.registered)
+                register_local();
+
+            obj*& head = pool.free_list[free_list_index(n)];
+            obj* result = head;
+            if (!result)
+                return refill(round_up(n));
+            head = result->next;
+            return result;
+        }
+
+        // p不允许为空指针，n需与allocate时一致
+        // 区块可以由其它线程释放，此时归入释放线程的自由链表
+        static void deallocate(void* p, size_t n)
+        {
+            if (n > max_bytes)
+            {
+                malloc_alloc::deallocate(p, n);
+                return;
+            }
+            if (n == 0)
+                n = 1;
+
+            local_pool& pool = local_;
+            if (!pool.registered)
+                register_local();
+
+            obj* q = static_cast<obj*>(p);
+            obj*& head = pool.free_list[free_list_index(n)];
+            q->next = head;
+            head = q;
+        }
+
+        static void* reallocate(void* p, size_t old_size, size_t new_size)
+        {
+            if (old_size > max_bytes && new_size > max_bytes)
+                return malloc_alloc::reallocate(p, old_size, new_size);
+            if (round_up(old_size) == round_up(new_size))
+                return p;
+
+            void* result = allocate(new_size);
+            std::memcpy(result, p, new_size > old_size ? old_size : new_size);
+            deallocate(p, old_size);
+            return result;
+        }
+
+    private:
+        // 区块空闲时存放下一区块的指针，分配后整体作为用户数据，不额外占用内存
+        union obj
+        {
+            obj* next;
+            char data[1];
+        };
+
+        // 线程独占的自由链表与内存池
+        // 必须平凡析构，保证线程退出时（包括主线程的静态对象析构期间）仍可访问
+        struct local_pool
+        {
+            obj*   free_list[free_list_num];
+            char*  start_free; // 内存池起始位置
+            char*  end_free;   // 内存池结束位置
+            size_t heap_size;  // 已向系统申请的内存总量
+            bool   registered; // 是否已注册线程退出时的归还
+        };
+
+        // 析构时将所在线程的自由链表和内存池剩余空间归还至全局
+        struct local_pool_guard
+        {
+            ~local_pool_guard()
+            {
+                give_back();
+            }
+        };
+
+        inline static thread_local local_pool local_ = {};
+
+        inline static obj* global_free_list_[free_list_num] = {};
+        inline static std::mutex global_mtx_;
+
+        static constexpr size_t free_list_index(size_t bytes)
+            noexcept
+        {
+            return (bytes + align - 1) / align - 1;
+        }
+
+        static void register_local()
+        {
+            local_.registered = true;
+            static thread_local local_pool_guard guard;
+            (void)guard;
+        }
+
+        static void push_global(obj* first, obj* last, size_t index)
+        {
+            last->next = global_free_list_[index];
+            global_free_list_[index] = first;
+        }
+
+        static void give_back()
+        {
+            local_pool& pool = local_;
+            std::lock_guard<std::mutex> lock(global_mtx_);
+            for (size_t i = 0; i < free_list_num; ++i)
+            {
+                obj* first = pool.free_list[i];
+                if (!first)
+                    continue;
+                obj* last = first;
+                while (last->next)
+                    last = last->next;
+                push_global(first, last, i);
+                pool.free_list[i] = nullptr;
+            }
+
+            // 内存池剩余空间切分为区块（剩余空间必然是8的倍数）
+            while (pool.start_free != pool.end_free)
+            {
+                size_t bytes = pool.end_free - pool.start_free;
+                if (bytes > max_bytes)
+                    bytes = max_bytes;
+                obj* block = reinterpret_cast<obj*>(pool.start_free);
+                push_global(block, block, free_list_index(bytes));
+                pool.start_free += bytes;
+            }
+            pool.start_free = pool.end_free = nullptr;
+        }
+
+        // 自由链表为空时，优先整条取走全局的自由链表
+        // 否则从内存池取得（默认20个）新区块，返回一个并将其余的挂入自由链表
+        // n已上调至8的倍数
+        static void* refill(size_t n)
+        {
+            const size_t index = free_list_index(n);
+            {
+                std::lock_guard<std::mutex> lock(global_mtx_);
+                if (obj* result = global_free_list_[index])
+                {
+                    local_.free_list[index] = result->next;
+                    global_free_list_[index] = nullptr;
+                    return result;
+                }
+            }
+
+            size_t nobjs = 20;
+            char* chunk = chunk_alloc(n, nobjs);
+            if (nobjs == 1)
+                return chunk;
+
+            obj* result = reinterpret_cast<obj*>(chunk);
+            obj* cur = reinterpret_cast<obj*>(chunk + n);
+            local_.free_list[index] = cur;
+            for (size_t i = 2; i < nobjs; ++i)
+            {
+                obj* next = reinterpret_cast<obj*>(reinterpret_cast<char*>(cur) + n);
+                cur->next = next;
+                cur = next;
+            }
+            cur->next = nullptr;
+            return result;
+        }
+
+        // 从内存池中取出nobjs个大小为size的区块，内存池不足时nobjs会被减少
+        static char* chunk_alloc(size_t size, size_t& nobjs)
+        {
+            local_pool& pool = local_;
+            size_t total_bytes = size * nobjs;
+            size_t bytes_left  = pool.end_free - pool.start_free;
+
+            // 内存池剩余空间完全满足需求
+            if (bytes_left >= total_bytes)
+            {
+                char* result = pool.start_free;
+                pool.start_free += total_bytes;
+                return result;
+            }
+
+            // 内存池剩余空间足够供应一个及以上的区块
+            if (bytes_left >= size)
+            {
+                nobjs = bytes_left / size;
+                char* result = pool.start_free;
+                pool.start_free += size * nobjs;
+                return result;
+            }
+
+            // 内存池剩余空间连一个区块都无法提供
+            // 将残余零头挂入对应的自由链表（残余零头必然是8的倍数）
+            if (bytes_left > 0)
+            {
+                obj*& head = pool.free_list[free_list_index(bytes_left)];
+                reinterpret_cast<obj*>(pool.start_free)->next = head;
+                head = reinterpret_cast<obj*>(pool.start_free);
+            }
+
+            // 申请需求量的两倍，再加上随申请次数逐渐增大的附加量
+            size_t bytes_to_get = 2 * total_bytes + round_up(pool.heap_size >> 4);
+            pool.start_free = static_cast<char*>(std::malloc(bytes_to_get));
+            if (!pool.start_free)
+            {
+                // 系统内存不足，尝试从更大区块的自由链表中借用一个区块
+                for (size_t i = size; i <= max_bytes; i += align)
+                {
+                    obj*& head = pool.free_list[free_list_index(i)];
+                    if (obj* p = head)
+                    {
+                        head = p->next;
+                        pool.start_free = reinterpret_cast<char*>(p);
+                        pool.end_free = pool.start_free + i;
+                        return chunk_alloc(size, nobjs);
+                    }
+                }
+                // 无处可借，交由一级分配器的内存不足处理机制
+                pool.end_free = nullptr;
+                pool.start_free = static_cast<char*>(malloc_alloc::allocate(bytes_to_get));
+            }
+            pool.heap_size += bytes_to_get;
+            pool.end_free = pool.start_free + bytes_to_get;
+            return chunk_alloc(size, nobjs);
+        }
+    };
+
+    /*
+     * 使用两级分配器的内存分配器
+     * 接口与allocator一致，可作为容器的Alloc模板参数
+     * 对齐要求超过8bytes的类型退回allocator
+     */
+    template<typename T>
+    class pool_allocator
+    {
+    public:
+        using value_type      = T;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+
+        using propagate_on_container_move_assignment = true_type;
+        using is_always_equal                        = true_type;
+
+        constexpr pool_allocator() noexcept {}
+
+        constexpr pool_allocator(const pool_allocator&) noexcept {}
+
+        template<typename U>
+        constexpr pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        constexpr ~pool_allocator() noexcept {}
+
+        [[nodiscard]]
+        T* allocate(size_type n)
+        {
+            static_assert(sizeof(T) != 0, "cannot allocate incomplete types");
+
+            if (n > (size_t(-1) / sizeof(T)))
+                throw std::bad_array_new_length();
+
+            if constexpr (alignof(T) > pool_alloc::align)
+                return allocator<T>().allocate(n);
+            else
+                return static_cast<T*>(pool_alloc::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_type n)
+        {
+            if constexpr (alignof(T) > pool_alloc::align)
+                allocator<T>().deallocate(p, n);
+            else
+                pool_alloc::deallocate(p, n * sizeof(T));
+        }
+
+        // 小额区块上调至8的倍数，多出的空间也可使用
+        [[nodiscard]]
+        allocation_result<T*, size_type> allocate_at_least(size_type n)
+        {
+            T* p = allocate(n);
+            if constexpr (alignof(T) > pool_alloc::align)
+                return { p, n };
+            else
+            {
+                const size_t bytes = n * sizeof(T);
+                if (bytes > pool_alloc::max_bytes)
+                    return { p, n };
+                return { p, pool_alloc::round_up(bytes) / sizeof(T) };
+            }
+        }
+
+        template<typename U>
+        friend constexpr bool operator==(const pool_allocator&, const pool_allocator<U>&)
+            noexcept
+        {
+            return true;
+        }
+
+        template<typename U>
+        friend constexpr bool operator!=(const pool_allocator&, const pool_allocator<U>&)
+            noexcept
+        {
+            return false;
+        }
+    };
+}
+
+#endif // !POOL_ALLOCATOR_H
@@ -0,0 +1,270 @@
+/*
+ * 基数排序
+ * 对整数、浮点数键（或由键提取函数从记录中取得的键）进行LSD基数排序，每轮处理一个字节
+ */
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+
+#include "config.h"
+#include "type_traits.h"
+#include "iterator.h"
+#include "allocator.h"
+#include "allocator_traits.h"
+#include "algorithm.h"
+#include "vector.h"
+
+namespace bitstl
+{
+    namespace radix_detail
+    {
+        constexpr size_t radix        = 256;
+        constexpr size_t small_length = 64; // 更短的区间使用二分插入排序
+
+        // 判断能否作为基数排序的键：大小为1、2、4、8bytes的整数类型与float、double
+        template<typename Key>
+        inline constexpr bool is_radix_key_v =
+            (std::is_integral_v<Key> && (sizeof(Key) == 1 || sizeof(Key) == 2 || sizeof(Key) == 4 || sizeof(Key) == 8))
+            || is_same_v<Key, float> || is_same_v<Key, double>;
+
+        template<size_t Size>
+        struct unsigned_of;
+
+        template<> struct unsigned_of<1> { using type = std::uint8_t; };
+        template<> struct unsigned_of<2> { using type = std::uint16_t; };
+        template<> struct unsigned_of<4> { using type = std::uint32_t; };
+        template<> struct unsigned_of<8> { using type = std::uint64_t; };
+
+        template<typename Key>
+        using unsigned_key_t = typename unsigned_of<sizeof(Key)>::type;
+
+        /*
+         * 将键映射为无符号整数，映射后的大小顺序与原键一致
+         * 有符号整数：翻转符号位
+         * 浮点数：负数翻转所有位，非负数翻转符号位；-0.0排在+0.0之前，NaN按符号位排在两端
+         */
+        template<typename Key>
+        constexpr unsigned_key_t<Key> to_unsigned_key(Key key)
+            noexcept
+        {
+            using U = unsigned_key_t<Key>;
+            constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+            if constexpr (std::is_floating_point_v<Key>)
+            {
+                const U bits = std::bit_cast<U>(key);
+                return (bits & sign) ? U(~bits) : U(bits | sign);
+            }
+            else if constexpr (std::is_signed_v<Key>)
+                return U(static_cast<U>(key) ^ sign);
+            else
+                return static_cast<U>(key);
+        }
+
+        // 默认的键提取函数，元素自身即为键
+        struct identity
+        {
+            template<typename T>
+            constexpr T&& operator()(T&& x) const noexcept
+            {
+                return bitstl::forward<T>(x);
+            }
+        };
+
+        template<typename T, typename KeyExtractor>
+        using key_t = remove_cv_t<remove_reference_t<std::invoke_result_t<KeyExtractor&, const T&>>>;
+
+        // 取得元素映射后的键
+        template<typename T, typename KeyExtractor>
+        auto unsigned_key_of(const T& x, KeyExtractor& key)
+        {
+            return radix_detail::to_unsigned_key<key_t<T, KeyExtractor>>(std::invoke(key, x));
+        }
+
+        /*
+         * 与区间等长的暂存区，内存由Alloc分配
+         * 元素不可平凡复制时先将区间的元素移动构造到暂存区（此后数据位于暂存区），各轮之间只进行赋值，析构时统一析构
+         */
+        template<typename T, typename Alloc>
+        class scratch_buffer
+        {
+        public:
+            using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<T>;
+            using traits         = allocator_traits<allocator_type>;
+
+            scratch_buffer(T* first, size_t n, const Alloc& alloc)
+                : alloc_(alloc), size_(n)
+            {
+                data_ = bitstl::to_address(traits::allocate(alloc_, n));
+                if constexpr (!std::is_trivially_copyable_v<T>)
+                {
+                    try
+                    {
+                        for (; constructed_ < n; ++constructed_)
+                            traits::construct(alloc_, data_ + constructed_, bitstl::move(first[constructed_]));
+                    }
+                    catch (...)
+                    {
+                        release();
+                        throw;
+                    }
+                }
+            }
+
+            scratch_buffer(const scratch_buffer&) = delete;
+            scratch_buffer& operator=(const scratch_buffer&) = delete;
+
+            ~scratch_buffer()
+            {
+                release();
+            }
+
+            T* data()
+                const noexcept
+            {
+                return data_;
+            }
+
+            // 数据是否已移入暂存区
+            static constexpr bool holds_data = !std::is_trivially_copyable_v<T>;
+
+        private:
+            allocator_type alloc_;
+            T*     data_        = nullptr;
+            size_t size_        = 0;
+            size_t constructed_ = 0;
+
+            void release()
+                noexcept
+            {
+                for (size_t i = 0; i < constructed_; ++i)
+                    traits::destroy(alloc_, data_ + i);
+                traits::deallocate(alloc_, data_, size_);
+            }
+        };
+
+        // 统计所有字节位上各数字的出现次数，只需遍历一次
+        template<typename T, typename KeyExtractor, size_t Passes>
+        void histogram(const T* first, const T* last, KeyExtractor& key, size_t (&counts)[Passes][radix])
+        {
+            for (; first != last; ++first)
+            {
+                const auto k = radix_detail::unsigned_key_of(*first, key);
+                for (size_t pass = 0; pass < Passes; ++pass)
+                    ++counts[pass][(k >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        // 某一字节位上所有元素的数字相同时，这一轮不改变顺序，可以跳过
+        template<size_t Passes>
+        bool is_uniform(const size_t (&counts)[Passes][radix], size_t pass, size_t n)
+        {
+            for (size_t d = 0; d < radix; ++d)
+                if (counts[pass][d])
+                    return counts[pass][d] == n;
+            return true;
+        }
+
+        // 数据位于first（in_buffer为false）或buffer，结果写回first
+        template<typename T, typename KeyExtractor>
+        void lsd_sort(T* first, size_t n, KeyExtractor& key, T* buffer, bool in_buffer)
+        {
+            using U = unsigned_key_t<key_t<T, KeyExtractor>>;
+            constexpr size_t passes = sizeof(U);
+
+            T* src = in_buffer ? buffer : first;
+            T* dst = in_buffer ? first : buffer;
+
+            size_t counts[passes][radix] = {};
+            radix_detail::histogram(src, src + n, key, counts);
+
+            for (size_t pass = 0; pass < passes; ++pass)
+            {
+                if (radix_detail::is_uniform(counts, pass, n))
+                    continue;
+
+                size_t offsets[radix];
+                size_t sum = 0;
+                for (size_t d = 0; d < radix; ++d)
+                {
+                    offsets[d] = sum;
+                    sum += counts[pass][d];
+                }
+
+                const size_t shift = pass * 8;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const size_t d = (radix_detail::unsigned_key_of(src[i], key) >> shift) & 0xFF;
+                    dst[offsets[d]++] = bitstl::move(src[i]);
+                }
+                T* tmp = src;
+                src = dst;
+                dst = tmp;
+            }
+
+            if (src != first)
+                bitstl::move(src, src + n, first);
+        }
+    }
+
+    /*
+     * 稳定的LSD基数排序，O(n * sizeof(key))
+     * 键为整数或浮点数，key为返回键的可调用对象（可以是成员指针），暂存区由alloc分配
+     * 迭代器须为连续迭代器
+     */
+    template<typename RandomIterator, typename KeyExtractor, typename Alloc>
+    void radix_sort(RandomIterator first, RandomIterator last, KeyExtractor key, const Alloc& alloc)
+    {
+        using value_type = typename iterator_traits<RandomIterator>::value_type;
+        static_assert(is_contiguous_iterator<RandomIterator>, "radix_sort requires contiguous iterators");
+        static_assert(radix_detail::is_radix_key_v<radix_detail::key_t<value_type, KeyExtractor>>,
+            "radix_sort requires integral or floating-point keys");
+
+        const size_t n = static_cast<size_t>(last - first);
+        if (n < 2)
+            return;
+        if (n < radix_detail::small_length)
+        {
+            auto comp = [&key](const value_type& a, const value_type& b)
+                {
+                    return radix_detail::unsigned_key_of(a, key) < radix_detail::unsigned_key_of(b, key);
+                };
+            sort_detail::binary_insertion_sort(first, first + 1, last, comp);
+            return;
+        }
+
+        value_type* data = bitstl::to_address(first);
+        radix_detail::scratch_buffer<value_type, Alloc> buffer(data, n, alloc);
+        radix_detail::lsd_sort(data, n, key, buffer.data(), buffer.holds_data);
+    }
+
+    template<typename RandomIterator, typename KeyExtractor>
+    void radix_sort(RandomIterator first, RandomIterator last, KeyExtractor key)
+    {
+        using value_type = typename iterator_traits<RandomIterator>::value_type;
+        bitstl::radix_sort(first, last, key, allocator<value_type>());
+    }
+
+    template<typename RandomIterator>
+    void radix_sort(RandomIterator first, RandomIterator last)
+    {
+        bitstl::radix_sort(first, last, radix_detail::identity());
+    }
+
+    // 暂存区使用容器的分配器
+    template<typename T, typename Alloc, typename KeyExtractor>
+    void radix_sort(vector<T, Alloc>& v, KeyExtractor key)
+    {
+        bitstl::radix_sort(v.begin(), v.end(), key, v.get_allocator());
+    }
+
+    template<typename T, typename Alloc>
+    void radix_sort(vector<T, Alloc>& v)
+    {
+        bitstl::radix_sort(v.begin(), v.end(), radix_detail::identity(), v.get_allocator());
+    }
+}
+
+#endif // !RADIX_SORT_H
@@ -0,0 +1,427 @@
+/*
+ * 向量化的查找与比较内核
+ * 在x86上根据运行时检测到的CPU特性选用AVX2或SSE4.2实现，其余平台及不支持的CPU使用标量实现
+ * 供algorithm.h中的find、count、mismatch等算法在连续内存的算术类型上调用
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#include "config.h"
+#include "type_traits.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BITSTL_SIMD_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#else
+#define BITSTL_SIMD_X86 0
+#endif
+
+// MSVC无需编译选项即可使用所有指令集的intrinsic，GCC、Clang需对函数单独开启目标指令集
+#if BITSTL_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define BITSTL_TARGET_AVX2  __attribute__((target("avx2")))
+#define BITSTL_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define BITSTL_TARGET_AVX2
+#define BITSTL_TARGET_SSE42
+#endif
+
+namespace bitstl
+{
+    namespace simd
+    {
+        enum class level : int
+        {
+            scalar = 0,
+            sse42  = 1,
+            avx2   = 2,
+        };
+
+        // 判断能否使用向量内核：大小为1、2、4、8bytes的整数类型（含bool、字符类型）与float、double
+        template<typename T>
+        inline constexpr bool is_vectorizable_v =
+            (std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8))
+            || is_same_v<T, float> || is_same_v<T, double>;
+
+        // 检测CPU与操作系统支持的最高指令集
+        // AVX2还需操作系统在上下文切换时保存YMM寄存器（OSXSAVE且XCR0的第1、2位均置位）
+        inline level detect_level()
+            noexcept
+        {
+#if BITSTL_SIMD_X86
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+            __cpuid(info, 1);
+            const bool sse42   = (info[2] >> 20) & 1;
+            const bool osxsave = (info[2] >> 27) & 1;
+            const bool avx     = (info[2] >> 28) & 1;
+            bool avx2 = false;
+            if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] >> 5) & 1;
+            }
+            return avx2 ? level::avx2 : sse42 ? level::sse42 : level::scalar;
+#else
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return level::avx2;
+            if (__builtin_cpu_supports("sse4.2"))
+                return level::sse42;
+            return level::scalar;
+#endif
+#else
+            return level::scalar;
+#endif
+        }
+
+        inline level detected_level()
+            noexcept
+        {
+            static const level detected = detect_level();
+            return detected;
+        }
+
+        inline std::atomic<int> active_level_{ -1 };
+
+        // 当前使用的指令集，首次调用时取检测结果
+        inline level active_level()
+            noexcept
+        {
+            int cur = active_level_.load(std::memory_order_relaxed);
+            if (cur < 0)
+            {
+                cur = static_cast<int>(detected_level());
+                active_level_.store(cur, std::memory_order_relaxed);
+            }
+            return static_cast<level>(cur);
+        }
+
+        // 限制使用的指令集（如测试、对比标量实现），不会超过CPU支持的范围，返回实际生效的指令集
+        inline level set_active_level(level l)
+            noexcept
+        {
+            const level detected = detected_level();
+            if (static_cast<int>(l) > static_cast<int>(detected))
+                l = detected;
+            active_level_.store(static_cast<int>(l), std::memory_order_relaxed);
+            return l;
+        }
+
+        /*
+         * 标量实现
+         */
+        template<typename T>
+        size_t find_scalar(const T* first, size_t n, T value)
+        {
+            size_t i = 0;
+            for (; i < n; ++i)
+                if (first[i] == value)
+                    break;
+            return i;
+        }
+
+        template<typename T>
+        size_t count_scalar(const T* first, size_t n, T value)
+        {
+            size_t result = 0;
+            for (size_t i = 0; i < n; ++i)
+                result += first[i] == value;
+            return result;
+        }
+
+        template<typename T>
+        size_t mismatch_scalar(const T* first1, const T* first2, size_t n)
+        {
+            size_t i = 0;
+            for (; i < n; ++i)
+                if (!(first1[i] == first2[i]))
+                    break;
+            return i;
+        }
+
+#if BITSTL_SIMD_X86
+        /*
+         * 向量实现
+         * 比较结果统一以movemask_epi8转为逐字节的位掩码，每个元素占sizeof(T)位
+         * 因此首个匹配元素的下标为countr_zero(mask) / sizeof(T)，匹配个数为popcount(mask) / sizeof(T)
+         * 浮点数使用有序相等比较，与标量的==一致（+0.0等于-0.0，NaN不等于任何数）
+         */
+        template<typename T>
+        BITSTL_TARGET_AVX2 inline __m256i broadcast_avx2(T value)
+        {
+            if constexpr (is_same_v<T, float>)
+                return _mm256_castps_si256(_mm256_set1_ps(value));
+            else if constexpr (is_same_v<T, double>)
+                return _mm256_castpd_si256(_mm256_set1_pd(value));
+            else if constexpr (sizeof(T) == 1)
+                return _mm256_set1_epi8(static_cast<char>(value));
+            else if constexpr (sizeof(T) == 2)
+                return _mm256_set1_epi16(static_cast<short>(value));
+            else if constexpr (sizeof(T) == 4)
+                return _mm256_set1_epi32(static_cast<int>(value));
+            else
+                return _mm256_set1_epi64x(static_cast<long long>(value));
+        }
+
+        template<typename T>
+        BITSTL_TARGET_AVX2 inline unsigned equal_mask_avx2(__m256i a, __m256i b)
+        {
+            __m256i eq;
+            if constexpr (is_same_v<T, float>)
+                eq = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+            else if constexpr (is_same_v<T, double>)
+                eq = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+            else if constexpr (sizeof(T) == 1)
+                eq = _mm256_cmpeq_epi8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                eq = _mm256_cmpeq_epi16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                eq = _mm256_cmpeq_epi32(a, b);
+            else
+                eq = _mm256_cmpeq_epi64(a, b);
+            return static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        }
+
+        template<typename T>
+        BITSTL_TARGET_AVX2 inline __m256i load_avx2(const T* p)
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 inline __m128i broadcast_sse42(T value)
+        {
+            if constexpr (is_same_v<T, float>)
+                return _mm_castps_si128(_mm_set1_ps(value));
+            else if constexpr (is_same_v<T, double>)
+                return _mm_castpd_si128(_mm_set1_pd(value));
+            else if constexpr (sizeof(T) == 1)
+                return _mm_set1_epi8(static_cast<char>(value));
+            else if constexpr (sizeof(T) == 2)
+                return _mm_set1_epi16(static_cast<short>(value));
+            else if constexpr (sizeof(T) == 4)
+                return _mm_set1_epi32(static_cast<int>(value));
+            else
+                return _mm_set1_epi64x(static_cast<long long>(value));
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 inline unsigned equal_mask_sse42(__m128i a, __m128i b)
+        {
+            __m128i eq;
+            if constexpr (is_same_v<T, float>)
+                eq = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+            else if constexpr (is_same_v<T, double>)
+                eq = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+            else if constexpr (sizeof(T) == 1)
+                eq = _mm_cmpeq_epi8(a, b);
+            else if constexpr (sizeof(T) == 2)
+                eq = _mm_cmpeq_epi16(a, b);
+            else if constexpr (sizeof(T) == 4)
+                eq = _mm_cmpeq_epi32(a, b);
+            else
+                eq = _mm_cmpeq_epi64(a, b);
+            return static_cast<unsigned>(_mm_movemask_epi8(eq));
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 inline __m128i load_sse42(const T* p)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        }
+
+        // 每次处理4个向量（128bytes），合并掩码后只需一次分支判断
+        template<typename T>
+        BITSTL_TARGET_AVX2 size_t find_avx2(const T* first, size_t n, T value)
+        {
+            constexpr size_t step = 32 / sizeof(T);
+            const __m256i v = broadcast_avx2(value);
+            size_t i = 0;
+            for (; i + 4 * step <= n; i += 4 * step)
+            {
+                const unsigned m0 = equal_mask_avx2<T>(load_avx2(first + i), v);
+                const unsigned m1 = equal_mask_avx2<T>(load_avx2(first + i + step), v);
+                const unsigned m2 = equal_mask_avx2<T>(load_avx2(first + i + 2 * step), v);
+                const unsigned m3 = equal_mask_avx2<T>(load_avx2(first + i + 3 * step), v);
+                if (m0 | m1 | m2 | m3)
+                {
+                    if (m0) return i + std::countr_zero(m0) / sizeof(T);
+                    if (m1) return i + step + std::countr_zero(m1) / sizeof(T);
+                    if (m2) return i + 2 * step + std::countr_zero(m2) / sizeof(T);
+                    return i + 3 * step + std::countr_zero(m3) / sizeof(T);
+                }
+            }
+            for (; i + step <= n; i += step)
+                if (const unsigned m = equal_mask_avx2<T>(load_avx2(first + i), v))
+                    return i + std::countr_zero(m) / sizeof(T);
+            return i + find_scalar(first + i, n - i, value);
+        }
+
+        template<typename T>
+        BITSTL_TARGET_AVX2 size_t count_avx2(const T* first, size_t n, T value)
+        {
+            constexpr size_t step = 32 / sizeof(T);
+            const __m256i v = broadcast_avx2(value);
+            size_t bits = 0;
+            size_t i = 0;
+            for (; i + 4 * step <= n; i += 4 * step)
+            {
+                bits += std::popcount(equal_mask_avx2<T>(load_avx2(first + i), v));
+                bits += std::popcount(equal_mask_avx2<T>(load_avx2(first + i + step), v));
+                bits += std::popcount(equal_mask_avx2<T>(load_avx2(first + i + 2 * step), v));
+                bits += std::popcount(equal_mask_avx2<T>(load_avx2(first + i + 3 * step), v));
+            }
+            for (; i + step <= n; i += step)
+                bits += std::popcount(equal_mask_avx2<T>(load_avx2(first + i), v));
+            return bits / sizeof(T) + count_scalar(first + i, n - i, value);
+        }
+
+        template<typename T>
+        BITSTL_TARGET_AVX2 size_t mismatch_avx2(const T* first1, const T* first2, size_t n)
+        {
+            constexpr size_t step = 32 / sizeof(T);
+            size_t i = 0;
+            for (; i + 4 * step <= n; i += 4 * step)
+            {
+                const unsigned m0 = equal_mask_avx2<T>(load_avx2(first1 + i), load_avx2(first2 + i));
+                const unsigned m1 = equal_mask_avx2<T>(load_avx2(first1 + i + step), load_avx2(first2 + i + step));
+                const unsigned m2 = equal_mask_avx2<T>(load_avx2(first1 + i + 2 * step), load_avx2(first2 + i + 2 * step));
+                const unsigned m3 = equal_mask_avx2<T>(load_avx2(first1 + i + 3 * step), load_avx2(first2 + i + 3 * step));
+                if ((m0 & m1 & m2 & m3) != 0xFFFFFFFFu)
+                    break;
+            }
+            for (; i + step <= n; i += step)
+            {
+                const unsigned m = ~equal_mask_avx2<T>(load_avx2(first1 + i), load_avx2(first2 + i));
+                if (m)
+                    return i + std::countr_zero(m) / sizeof(T);
+            }
+            return i + mismatch_scalar(first1 + i, first2 + i, n - i);
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 size_t find_sse42(const T* first, size_t n, T value)
+        {
+            constexpr size_t step = 16 / sizeof(T);
+            const __m128i v = broadcast_sse42(value);
+            size_t i = 0;
+            for (; i + 2 * step <= n; i += 2 * step)
+            {
+                const unsigned m0 = equal_mask_sse42<T>(load_sse42(first + i), v);
+                const unsigned m1 = equal_mask_sse42<T>(load_sse42(first + i + step), v);
+                if (m0 | m1)
+                {
+                    if (m0) return i + std::countr_zero(m0) / sizeof(T);
+                    return i + step + std::countr_zero(m1) / sizeof(T);
+                }
+            }
+            for (; i + step <= n; i += step)
+                if (const unsigned m = equal_mask_sse42<T>(load_sse42(first + i), v))
+                    return i + std::countr_zero(m) / sizeof(T);
+            return i + find_scalar(first + i, n - i, value);
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 size_t count_sse42(const T* first, size_t n, T value)
+        {
+            constexpr size_t step = 16 / sizeof(T);
+            const __m128i v = broadcast_sse42(value);
+            size_t bits = 0;
+            size_t i = 0;
+            for (; i + step <= n; i += step)
+                bits += std::popcount(equal_mask_sse42<T>(load_sse42(first + i), v));
+            return bits / sizeof(T) + count_scalar(first + i, n - i, value);
+        }
+
+        template<typename T>
+        BITSTL_TARGET_SSE42 size_t mismatch_sse42(const T* first1, const T* first2, size_t n)
+        {
+            constexpr size_t step = 16 / sizeof(T);
+            size_t i = 0;
+            for (; i + step <= n; i += step)
+            {
+                const unsigned m = ~equal_mask_sse42<T>(load_sse42(first1 + i), load_sse42(first2 + i)) & 0xFFFFu;
+                if (m)
+                    return i + std::countr_zero(m) / sizeof(T);
+            }
+            return i + mismatch_scalar(first1 + i, first2 + i, n - i);
+        }
+#endif
+
+        /*
+         * 按当前指令集分派
+         * bool的对象表示只能是0或1，按同样大小的无符号整数比较即可
+         */
+        template<typename T>
+        using kernel_type_t = conditional_t<is_same_v<T, bool>, unsigned char, T>;
+
+        // 返回[first, first + n)中首个等于value的元素下标，不存在时返回n
+        template<typename T>
+        size_t find(const T* first, size_t n, T value)
+        {
+            static_assert(is_vectorizable_v<T>);
+            using K = kernel_type_t<T>;
+            const K* p = reinterpret_cast<const K*>(first);
+            const K v = static_cast<K>(value);
+#if BITSTL_SIMD_X86
+            switch (active_level())
+            {
+            case level::avx2:  return find_avx2(p, n, v);
+            case level::sse42: return find_sse42(p, n, v);
+            default: break;
+            }
+#endif
+            return find_scalar(p, n, v);
+        }
+
+        // 返回[first, first + n)中等于value的元素个数
+        template<typename T>
+        size_t count(const T* first, size_t n, T value)
+        {
+            static_assert(is_vectorizable_v<T>);
+            using K = kernel_type_t<T>;
+            const K* p = reinterpret_cast<const K*>(first);
+            const K v = static_cast<K>(value);
+#if BITSTL_SIMD_X86
+            switch (active_level())
+            {
+            case level::avx2:  return count_avx2(p, n, v);
+            case level::sse42: return count_sse42(p, n, v);
+            default: break;
+            }
+#endif
+            return count_scalar(p, n, v);
+        }
+
+        // 返回首个first1[i] != first2[i]的下标，不存在时返回n
+        template<typename T>
+        size_t mismatch(const T* first1, const T* first2, size_t n)
+        {
+            static_assert(is_vectorizable_v<T>);
+            using K = kernel_type_t<T>;
+            const K* p1 = reinterpret_cast<const K*>(first1);
+            const K* p2 = reinterpret_cast<const K*>(first2);
+#if BITSTL_SIMD_X86
+            switch (active_level())
+            {
+            case level::avx2:  return mismatch_avx2(p1, p2, n);
+            case level::sse42: return mismatch_sse42(p1, p2, n);
+            default: break;
+            }
+#endif
+            return mismatch_scalar(p1, p2, n);
+        }
+    }
+}
+
+#endif // !SIMD_H
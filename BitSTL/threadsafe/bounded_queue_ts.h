@@ -0,0 +1,177 @@
+/*
+ * 线程安全的有界队列
+ * 一把锁，满时push阻塞（反压），空时pop阻塞；close后push失败，pop取完剩余元素后失败，用于生产者通知消费者结束
+ */
+#ifndef BOUNDED_QUEUE_TS_H
+#define BOUNDED_QUEUE_TS_H
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace bitstl
+{
+    // 队列占用情况的统计，average_size为每次push后队列长度的平均值
+    struct queue_occupancy
+    {
+        std::size_t pushes = 0;
+        std::size_t full_waits = 0;  // push因队列已满而阻塞的次数
+        std::size_t max_size = 0;
+        double average_size = 0;
+    };
+
+    template<typename T>
+    class bounded_queue_ts
+    {
+    public:
+        explicit bounded_queue_ts(std::size_t capacity)
+            : capacity_(capacity)
+        {
+            assert(capacity > 0);
+        }
+
+        bounded_queue_ts(const bounded_queue_ts&) = delete;
+        bounded_queue_ts& operator=(const bounded_queue_ts&) = delete;
+
+        // 队列满时阻塞，已关闭时返回false且不移动new_value
+        bool push(T&& new_value)
+        {
+            {
+                std::unique_lock<std::mutex> lk(mtx_);
+                if (items_.size() >= capacity_ && !closed_)
+                {
+                    ++full_waits_;
+                    not_full_.wait(lk, [&] { return items_.size() < capacity_ || closed_; });
+                }
+                if (closed_)
+                    return false;
+                items_.push_back(std::move(new_value));
+                record_push();
+            }
+            not_empty_.notify_one();
+            return true;
+        }
+
+        bool push(const T& new_value)
+        {
+            T copy(new_value);
+            return push(std::move(copy));
+        }
+
+        bool try_push(T&& new_value)
+        {
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                if (closed_ || items_.size() >= capacity_)
+                    return false;
+                items_.push_back(std::move(new_value));
+                record_push();
+            }
+            not_empty_.notify_one();
+            return true;
+        }
+
+        // 队列空时阻塞，已关闭且取完时返回false
+        bool wait_and_pop(T& value)
+        {
+            {
+                std::unique_lock<std::mutex> lk(mtx_);
+                not_empty_.wait(lk, [&] { return !items_.empty() || closed_; });
+                if (items_.empty())
+                    return false;
+                value = std::move(items_.front());
+                items_.pop_front();
+            }
+            not_full_.notify_one();
+            return true;
+        }
+
+        bool try_pop(T& value)
+        {
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                if (items_.empty())
+                    return false;
+                value = std::move(items_.front());
+                items_.pop_front();
+            }
+            not_full_.notify_one();
+            return true;
+        }
+
+        // 唤醒所有等待的线程，此后push失败，已有的元素仍可取出
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lk(mtx_);
+                closed_ = true;
+            }
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+        bool closed()
+            const
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return closed_;
+        }
+
+        std::size_t size()
+            const
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return items_.size();
+        }
+
+        bool empty()
+            const
+        {
+            return size() == 0;
+        }
+
+        std::size_t capacity()
+            const noexcept
+        {
+            return capacity_;
+        }
+
+        queue_occupancy stats()
+            const
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            queue_occupancy result;
+            result.pushes = pushes_;
+            result.full_waits = full_waits_;
+            result.max_size = max_size_;
+            result.average_size = pushes_ ? static_cast<double>(size_sum_) / pushes_ : 0;
+            return result;
+        }
+
+    private:
+        void record_push()
+            noexcept
+        {
+            ++pushes_;
+            size_sum_ += items_.size();
+            max_size_ = std::max(max_size_, items_.size());
+        }
+
+        const std::size_t capacity_;
+        mutable std::mutex mtx_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        std::deque<T> items_;
+        bool closed_ = false;
+
+        std::size_t pushes_ = 0;
+        std::size_t full_waits_ = 0;
+        std::size_t max_size_ = 0;
+        std::size_t size_sum_ = 0;
+    };
+}
+
+#endif // !BOUNDED_QUEUE_TS_H
@@ -1,110 +1,154 @@
-/*
- * 线程安全的单向链表
- * 在节点一级加锁
- */
-#ifndef LIST_TS_H
-#define LIST_TS_H
-
-#include <memory>
-#include <mutex>
-
-namespace bitstl
-{
-    template<typename T>
-    class list_ts
-    {
-    private:
-        struct node
-        {
-            std::mutex mtx;
-            std::shared_ptr<T> data;
-            std::unique_ptr<node> next;
-            node() : next() {}
-            node(const T& value) : data(std::make_shared<T>(value)) {}
-        } head_;
-
-    public:
-        list_ts() {}
-
-        ~list_ts()
-        {
-            remove_if([](const node&) { return true; });
-        }
-
-        list_ts(const list_ts& other) = delete;
-        list_ts& operator=(const list_ts& other) = delete;
-
-        void push_front(const T& value)
-        {
-            std::unique_ptr<node> new_node(new node(value));
-            std::lock_guard<std::mutex> lock(head_.mtx);
-            new_node->next = std::move(head_.next);
-            head_.next = std::move(new_node);
-        }
-
-        bool empty()
-        {
-            std::lock_guard<std::mutex> lock(head_.mtx);
-            return head_.next == nullptr;
-        }
-
-        template<typename Function>
-        void for_each(Function f)
-        {
-            node* current = &head_;
-            std::unique_lock<std::mutex> lock(head_.mtx);
-            // 底层const，防止修改数据
-            while (node* const next = current->next.get())
-            {
-                std::unique_lock<std::mutex> next_lock(next->mtx);
-                lock.unlock();
-                f(*next->data);
-                current = next;
-                lock = std::move(next_lock);
-            }
-        }
-
-        template<typename Predicate>
-        std::shared_ptr<T> find_first_if(Predicate p)
-        {
-            node* current = &head_;
-            std::unique_lock<std::mutex> lock(head_.mtx);
-            while (node* const next = current->next.get())
-            {
-                std::unique_lock<std::mutex> next_lock(next->mtx);
-                lock.unlock();
-                if (p(*next->data))
-                {
-                    return next->data;
-                }
-                current = next;
-                lock = std::move(next_lock);
-            }
-            return std::shared_ptr<T>();
-        }
-
-        template<typename Predicate>
-        void remove_if(Predicate p)
-        {
-            node* current = &head_;
-            std::unique_lock<std::mutex> lock(head_.mtx);
-            while (node* const next = current->next.get())
-            {
-                std::unique_lock<std::mutex> next_lock(next->mtx);
-                if (p(*next->data))
-                {
-                    std::unique_ptr<node> old_next = std::move(current->next);
-                    current->next = std::move(next->next);
-                    next_lock.unlock();
-                }
-                else
-                {
-                    lock.unlock(); 
-                    current = next;
-                    lock = std::move(next_lock);
-                }
-            }
-        }
-    };
-}
+/*
+ * 线程安全的单向链表
+ * 在节点一级加锁
+ */
+#ifndef LIST_TS_H
+#define LIST_TS_H
+
+#include <memory>
+#include <mutex>
+
+#include "magazine_allocator.h"
+
+namespace bitstl
+{
+    // 节点和数据均由Alloc分配，默认使用线程缓存的magazine_allocator
+    template<typename T, typename Alloc = magazine_allocator<T>>
+    class list_ts
+    {
+    private:
+        struct node;
+
+        using node_alloc_type   = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+        using node_alloc_traits = std::allocator_traits<node_alloc_type>;
+
+        struct node_deleter
+        {
+            node_alloc_type alloc;
+
+            void operator()(node* p)
+            {
+                node_alloc_traits::destroy(alloc, p);
+                node_alloc_traits::deallocate(alloc, p, 1);
+            }
+        };
+
+        using node_ptr = std::unique_ptr<node, node_deleter>;
+
+        struct node
+        {
+            std::mutex mtx;
+            std::shared_ptr<T> data;
+            node_ptr next;
+            node(const node_deleter& d) : next(nullptr, d) {}
+            node(const T& value, const Alloc& alloc, const node_deleter& d)
+                : data(std::allocate_shared<T>(alloc, value)), next(nullptr, d) {}
+        };
+
+        Alloc alloc_;
+        node_deleter deleter_;
+        node head_;
+
+    public:
+        list_ts(const Alloc& alloc = Alloc())
+            : alloc_(alloc), deleter_{ node_alloc_type(alloc) }, head_(deleter_) {}
+
+        ~list_ts()
+        {
+            remove_if([](const T&) { return true; });
+        }
+
+        list_ts(const list_ts& other) = delete;
+        list_ts& operator=(const list_ts& other) = delete;
+
+        void push_front(const T& value)
+        {
+            node_ptr new_node(create_node(value));
+            std::lock_guard<std::mutex> lock(head_.mtx);
+            new_node->next = std::move(head_.next);
+            head_.next = std::move(new_node);
+        }
+
+        bool empty()
+        {
+            std::lock_guard<std::mutex> lock(head_.mtx);
+            return head_.next == nullptr;
+        }
+
+        template<typename Function>
+        void for_each(Function f)
+        {
+            node* current = &head_;
+            std::unique_lock<std::mutex> lock(head_.mtx);
+            // 底层const，防止修改数据
+            while (node* const next = current->next.get())
+            {
+                std::unique_lock<std::mutex> next_lock(next->mtx);
+                lock.unlock();
+                f(*next->data);
+                current = next;
+                lock = std::move(next_lock);
+            }
+        }
+
+        template<typename Predicate>
+        std::shared_ptr<T> find_first_if(Predicate p)
+        {
+            node* current = &head_;
+            std::unique_lock<std::mutex> lock(head_.mtx);
+            while (node* const next = current->next.get())
+            {
+                std::unique_lock<std::mutex> next_lock(next->mtx);
+                lock.unlock();
+                if (p(*next->data))
+                {
+                    return next->data;
+                }
+                current = next;
+                lock = std::move(next_lock);
+            }
+            return std::shared_ptr<T>();
+        }
+
+        template<typename Predicate>
+        void remove_if(Predicate p)
+        {
+            node* current = &head_;
+            std::unique_lock<std::mutex> lock(head_.mtx);
+            while (node* const next = current->next.get())
+            {
+                std::unique_lock<std::mutex> next_lock(next->mtx);
+                if (p(*next->data))
+                {
+                    node_ptr old_next = std::move(current->next);
+                    current->next = std::move(next->next);
+                    next_lock.unlock();
+                }
+                else
+                {
+                    lock.unlock(); 
+                    current = next;
+                    lock = std::move(next_lock);
+                }
+            }
+        }
+
+    private:
+        node_ptr create_node(const T& value)
+        {
+            node_alloc_type& alloc = deleter_.alloc;
+            node* p = node_alloc_traits::allocate(alloc, 1);
+            try
+            {
+                node_alloc_traits::construct(alloc, p, value, alloc_, deleter_);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(alloc, p, 1);
+                throw;
+            }
+            return node_ptr(p, deleter_);
+        }
+    };
+}
 #endif // !LIST_TS_H
\ No newline at end of file
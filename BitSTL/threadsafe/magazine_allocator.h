@@ -0,0 +1,261 @@
+/*
+ * 线程缓存的节点分配器
+ * 参考Bonwick的magazine分配器：每个线程持有两个弹匣缓存空闲区块，弹匣满或空时与全局仓库交换
+ */
+#ifndef MAGAZINE_ALLOCATOR_H
+#define MAGAZINE_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace bitstl
+{
+    /*
+     * 某一区块大小的缓存
+     * 弹匣为以区块自身串联的单链表，容量为magazine_size
+     * 线程的loaded弹匣为空（满）时先与previous弹匣交换，仍不满足时才加锁访问全局仓库
+     * 因此每次访问仓库至少能服务magazine_size次分配（释放）
+     */
+    template<std::size_t Size, std::size_t Align>
+    class magazine_cache
+    {
+    public:
+        static constexpr std::size_t magazine_size = 64;  // 弹匣容量
+        static constexpr std::size_t depot_limit   = 256; // 仓库中满弹匣数目上限，超过时归还系统
+
+        static void* allocate()
+        {
+            local_cache& cache = local_;
+            if (!cache.registered)
+                register_local();
+
+            if (!cache.loaded_count)
+            {
+                if (cache.previous_count)
+                    swap_magazines(cache);
+                else if (!load_from_depot(cache))
+                    return new_block();
+            }
+            block* result = cache.loaded;
+            cache.loaded = result->next;
+            --cache.loaded_count;
+            return result;
+        }
+
+        static void deallocate(void* p)
+        {
+            local_cache& cache = local_;
+            if (!cache.registered)
+                register_local();
+
+            if (cache.loaded_count == magazine_size)
+            {
+                if (cache.previous_count < magazine_size)
+                    swap_magazines(cache);
+                else
+                    unload_to_depot(cache);
+            }
+            block* b = static_cast<block*>(p);
+            b->next = cache.loaded;
+            cache.loaded = b;
+            ++cache.loaded_count;
+        }
+
+    private:
+        struct block
+        {
+            block* next;
+        };
+
+        struct magazine
+        {
+            block*      head;
+            std::size_t count;
+        };
+
+        // 平凡析构，保证线程退出时（包括主线程的静态对象析构期间）仍可访问
+        struct local_cache
+        {
+            block*      loaded;
+            std::size_t loaded_count;
+            block*      previous;
+            std::size_t previous_count;
+            bool        registered;
+        };
+
+        // 线程退出时将弹匣归还至仓库
+        struct local_cache_guard
+        {
+            ~local_cache_guard()
+            {
+                local_cache& cache = local_;
+                depot& d = get_depot();
+                std::lock_guard<std::mutex> lock(d.mtx);
+                if (cache.loaded_count)
+                    d.put(magazine{ cache.loaded, cache.loaded_count });
+                if (cache.previous_count)
+                    d.put(magazine{ cache.previous, cache.previous_count });
+                cache.loaded = cache.previous = nullptr;
+                cache.loaded_count = cache.previous_count = 0;
+            }
+        };
+
+        // 全局仓库，保存满弹匣
+        struct depot
+        {
+            std::mutex mtx;
+            std::vector<magazine> full;
+
+            void put(const magazine& m)
+            {
+                if (full.size() < depot_limit)
+                    full.push_back(m);
+                else
+                    free_blocks(m.head);
+            }
+        };
+
+        inline static thread_local local_cache local_ = {};
+
+        // 仓库永不析构，避免分离的线程在静态对象析构后退出时访问已析构的仓库
+        static depot& get_depot()
+        {
+            static depot* d = new depot;
+            return *d;
+        }
+
+        static void register_local()
+        {
+            get_depot();
+            local_.registered = true;
+            static thread_local local_cache_guard guard;
+            (void)guard;
+        }
+
+        static void swap_magazines(local_cache& cache)
+            noexcept
+        {
+            block* head = cache.loaded;
+            std::size_t count = cache.loaded_count;
+            cache.loaded = cache.previous;
+            cache.loaded_count = cache.previous_count;
+            cache.previous = head;
+            cache.previous_count = count;
+        }
+
+        // loaded、previous均为空，从仓库取一个满弹匣
+        static bool load_from_depot(local_cache& cache)
+        {
+            depot& d = get_depot();
+            std::lock_guard<std::mutex> lock(d.mtx);
+            if (d.full.empty())
+                return false;
+            magazine m = d.full.back();
+            d.full.pop_back();
+            cache.loaded = m.head;
+            cache.loaded_count = m.count;
+            return true;
+        }
+
+        // loaded、previous均满，将previous交给仓库，loaded移入previous
+        static void unload_to_depot(local_cache& cache)
+        {
+            {
+                depot& d = get_depot();
+                std::lock_guard<std::mutex> lock(d.mtx);
+                d.put(magazine{ cache.previous, cache.previous_count });
+            }
+            cache.previous = cache.loaded;
+            cache.previous_count = cache.loaded_count;
+            cache.loaded = nullptr;
+            cache.loaded_count = 0;
+        }
+
+        static void* new_block()
+        {
+            if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return ::operator new(Size, std::align_val_t(Align));
+            else
+                return ::operator new(Size);
+        }
+
+        static void free_blocks(block* b)
+        {
+            while (b)
+            {
+                block* next = b->next;
+                if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    ::operator delete(b, Size, std::align_val_t(Align));
+                else
+                    ::operator delete(b, Size);
+                b = next;
+            }
+        }
+    };
+
+    /*
+     * 使用magazine_cache的分配器
+     * 单个对象的分配（如链表节点、std::allocate_shared的控制块）走线程缓存，其余情况使用std::allocator
+     * 区块大小上调为16的倍数，使大小相近的类型共用缓存
+     */
+    template<typename T>
+    class magazine_allocator
+    {
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        using propagate_on_container_move_assignment = std::true_type;
+        using is_always_equal                        = std::true_type;
+
+        constexpr magazine_allocator() noexcept {}
+
+        constexpr magazine_allocator(const magazine_allocator&) noexcept {}
+
+        template<typename U>
+        constexpr magazine_allocator(const magazine_allocator<U>&) noexcept {}
+
+        [[nodiscard]]
+        T* allocate(size_type n)
+        {
+            if (n == 1)
+                return static_cast<T*>(cache_of<T>::allocate());
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, size_type n)
+        {
+            if (n == 1)
+                cache_of<T>::deallocate(p);
+            else
+                std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        friend constexpr bool operator==(const magazine_allocator&, const magazine_allocator<U>&)
+            noexcept
+        {
+            return true;
+        }
+
+        template<typename U>
+        friend constexpr bool operator!=(const magazine_allocator&, const magazine_allocator<U>&)
+            noexcept
+        {
+            return false;
+        }
+
+    private:
+        // 使用时才计算T的大小，允许以不完整类型（如节点自身）实例化magazine_allocator
+        template<typename U>
+        using cache_of = magazine_cache<
+            (sizeof(U) + 15) / 16 * 16,
+            (alignof(U) > alignof(void*) ? alignof(U) : alignof(void*))>;
+    };
+}
+
+#endif // !MAGAZINE_ALLOCATOR_H
@@ -1,140 +1,183 @@
-/*
- * 线程安全的队列
- * 队头队尾分别加锁
- */
-#ifndef QUEUE_TS_H
-#define QUEUE_TS_H
-
-#include <memory>
-#include <mutex>
-#include <condition_variable>
-
-namespace bitstl
-{
-    template<typename T>
-    class queue_ts
-    {
-    private:
-        struct node
-        {
-            std::shared_ptr<T> data;
-            std::unique_ptr<node> next;
-        };
-
-        mutable std::mutex head_mtx_;
-        mutable std::mutex tail_mtx_;
-
-        std::unique_ptr<node> head_;
-        node* tail_;
-        
-        std::condition_variable cond_;
-
-    public:
-        queue_ts() : head_(new node), tail_(head_.get()) {}
-
-        queue_ts(const queue_ts& other) = delete;
-        queue_ts& operator=(const queue_ts&) = delete;
-
-        void push(T new_value)
-        {
-            auto new_value_p(std::make_shared<T>(std::move(new_value)));
-            
-            std::unique_ptr<node> p(new node);
-            // 临界区
-            {
-                std::lock_guard<std::mutex> tail_lock(tail_mtx_);
-                tail_->data = new_value_p;
-                node* const new_tail = p.get();
-                tail_->next = std::move(p);
-                tail_ = new_tail;
-            }
-            cond_.notify_one();
-        }
-
-        void wait_and_pop(T& value)
-        {
-            const std::unique_ptr<node> old_head = wait_pop_head(value);
-        }
-
-        std::shared_ptr<T> wait_and_pop()
-        {
-            const std::unique_ptr<node> old_head = wait_pop_head();
-            return old_head->data;
-        }
-
-        bool try_pop(T& value)
-        {
-            const std::unique_ptr<node> old_head = try_pop_head(value);
-            return old_head;
-        }
-
-        std::shared_ptr<T> try_pop()
-        {
-            const std::unique_ptr<node> old_head = try_pop_head();
-            return old_head ? old_head->data : std::shared_ptr<T>();
-        }
-
-        bool empty()
-        {
-            std::lock_guard<std::mutex> head_lock(head_mtx_);
-            return head_.get() == get_tail();
-        }
-
-    private:
-        node* get_tail()
-        {
-            std::lock_guard<std::mutex> tail_lock(tail_mtx_);
-            return tail_;
-        }
-
-        std::unique_ptr<node> pop_head()
-        {
-            std::unique_ptr<node> old_head = std::move(head_);
-            head_ = std::move(old_head->next);
-            return old_head;
-        }
-
-        std::unique_lock<std::mutex> wait_for_data()
-        {
-            std::unique_lock<std::mutex> head_lock(head_mtx_);
-            cond_.wait(head_lock, [&] {return head_.get() != get_tail(); });
-            return std::move(head_lock);
-        }
-
-        std::unique_ptr<node> wait_pop_head()
-        {
-            std::unique_lock<std::mutex> head_lock(wait_for_data());
-            return pop_head();
-        }
-
-        std::unique_ptr<node> wait_pop_head(T& value)
-        {
-            std::unique_lock<std::mutex> head_lock(wait_for_data());
-            value = std::move(*head_->data);
-            return pop_head();
-        }
-
-        std::unique_ptr<node> try_pop_head()
-        {
-            std::unique_lock<std::mutex> head_lock(head_mtx_);
-            if (head_.get() == get_tail())
-            {
-                return std::unique_ptr<node>();
-            }
-            return pop_head();
-        }
-
-        std::unique_ptr<node> try_pop_head(T& value)
-        {
-            std::unique_lock<std::mutex> head_lock(head_mtx_);
-            if (head_.get() == get_tail())
-            {
-                return std::unique_ptr<node>();
-            }
-            value = std::move(*head_->data);
-            return pop_head();
-        }
-    };
-}
-#endif // !QUEUE_TS_H
-
+/*
+ * 线程安全的队列
+ * 队头队尾分别加锁
+ */
+#ifndef QUEUE_TS_H
+#define QUEUE_TS_H
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "magazine_allocator.h"
+
+namespace bitstl
+{
+    // 节点和数据均由Alloc分配，默认使用线程缓存的magazine_allocator
+    template<typename T, typename Alloc = magazine_allocator<T>>
+    class queue_ts
+    {
+    private:
+        struct node;
+
+        using node_alloc_type   = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+        using node_alloc_traits = std::allocator_traits<node_alloc_type>;
+
+        struct node_deleter
+        {
+            node_alloc_type alloc;
+
+            void operator()(node* p)
+            {
+                node_alloc_traits::destroy(alloc, p);
+                node_alloc_traits::deallocate(alloc, p, 1);
+            }
+        };
+
+        using node_ptr = std::unique_ptr<node, node_deleter>;
+
+        struct node
+        {
+            std::shared_ptr<T> data;
+            node_ptr next;
+
+            node(const node_deleter& d) : next(nullptr, d) {}
+        };
+
+        mutable std::mutex head_mtx_;
+        mutable std::mutex tail_mtx_;
+
+        Alloc alloc_;
+        node_deleter deleter_;
+
+        node_ptr head_;
+        node* tail_;
+        
+        std::condition_variable cond_;
+
+    public:
+        queue_ts(const Alloc& alloc = Alloc())
+            : alloc_(alloc), deleter_{ node_alloc_type(alloc) }, head_(create_node()), tail_(head_.get()) {}
+
+        queue_ts(const queue_ts& other) = delete;
+        queue_ts& operator=(const queue_ts&) = delete;
+
+        void push(T new_value)
+        {
+            auto new_value_p(std::allocate_shared<T>(alloc_, std::move(new_value)));
+            
+            node_ptr p(create_node());
+            // 临界区
+            {
+                std::lock_guard<std::mutex> tail_lock(tail_mtx_);
+                tail_->data = new_value_p;
+                node* const new_tail = p.get();
+                tail_->next = std::move(p);
+                tail_ = new_tail;
+            }
+            cond_.notify_one();
+        }
+
+        void wait_and_pop(T& value)
+        {
+            const node_ptr old_head = wait_pop_head(value);
+        }
+
+        std::shared_ptr<T> wait_and_pop()
+        {
+            const node_ptr old_head = wait_pop_head();
+            return old_head->data;
+        }
+
+        bool try_pop(T& value)
+        {
+            const node_ptr old_head = try_pop_head(value);
+            return old_head;
+        }
+
+        std::shared_ptr<T> try_pop()
+        {
+            const node_ptr old_head = try_pop_head();
+            return old_head ? old_head->data : std::shared_ptr<T>();
+        }
+
+        bool empty()
+        {
+            std::lock_guard<std::mutex> head_lock(head_mtx_);
+            return head_.get() == get_tail();
+        }
+
+    private:
+        node_ptr create_node()
+        {
+            node_alloc_type& alloc = deleter_.alloc;
+            node* p = node_alloc_traits::allocate(alloc, 1);
+            try
+            {
+                node_alloc_traits::construct(alloc, p, deleter_);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(alloc, p, 1);
+                throw;
+            }
+            return node_ptr(p, deleter_);
+        }
+
+        node* get_tail()
+        {
+            std::lock_guard<std::mutex> tail_lock(tail_mtx_);
+            return tail_;
+        }
+
+        node_ptr pop_head()
+        {
+            node_ptr old_head = std::move(head_);
+            head_ = std::move(old_head->next);
+            return old_head;
+        }
+
+        std::unique_lock<std::mutex> wait_for_data()
+        {
+            std::unique_lock<std::mutex> head_lock(head_mtx_);
+            cond_.wait(head_lock, [&] {return head_.get() != get_tail(); });
+            return std::move(head_lock);
+        }
+
+        node_ptr wait_pop_head()
+        {
+            std::unique_lock<std::mutex> head_lock(wait_for_data());
+            return pop_head();
+        }
+
+        node_ptr wait_pop_head(T& value)
+        {
+            std::unique_lock<std::mutex> head_lock(wait_for_data());
+            value = std::move(*head_->data);
+            return pop_head();
+        }
+
+        node_ptr try_pop_head()
+        {
+            std::unique_lock<std::mutex> head_lock(head_mtx_);
+            if (head_.get() == get_tail())
+            {
+                return node_ptr(nullptr, deleter_);
+            }
+            return pop_head();
+        }
+
+        node_ptr try_pop_head(T& value)
+        {
+            std::unique_lock<std::mutex> head_lock(head_mtx_);
+            if (head_.get() == get_tail())
+            {
+                return node_ptr(nullptr, deleter_);
+            }
+            value = std::move(*head_->data);
+            return pop_head();
+        }
+    };
+}
+#endif // !QUEUE_TS_H
+
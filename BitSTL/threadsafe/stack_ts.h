@@ -1,125 +1,179 @@
-/*
- * 线程安全的栈
- * 无锁
- */
-#ifndef STACK_TS_H
-#define STACK_TS_H
-
-#include <atomic>
-#include <memory>
-
-namespace bitstl
-{
-    template<typename T>
-    class stack_ts
-    {
-    private:
-        struct node
-        {
-            std::shared_ptr<T> data;
-            node* next;
-            node(const T& _data) : data(std::make_shared<T>(_data)), next(nullptr) {}
-            // data移动构造
-            node(T&& _data) : data(std::make_shared<T>(std::move(_data))), next(nullptr) {}
-        };
-        std::atomic<node*> head_;
-
-    public:
-        void push(const T& new_value)
-        {
-            node* const new_node = new node(new_value);
-            new_node->next = head_.load();
-            // 当head未被其它指针改动过时更新head_
-            while (!head_.compare_exchange_weak(new_node->next, new_node));
-        }
-
-        void push(T&& new_value)
-        {
-            // 此处也需要std::move
-            node* const new_node = new node(std::move(new_value));
-            new_node->next = head_.load();
-            while (!head_.compare_exchange_weak(new_node->next, new_node));
-        }
-
-        std::shared_ptr<T> pop()
-        {
-            ++threads_popping_;
-            node* old_head = head_.load();
-            // 当head未被其它指针改动过时更新head_
-            while (old_head && !head_.compare_exchange_weak(old_head, old_head->next));
-            std::shared_ptr<T> res;
-            if (old_head)
-                res.swap(old_head->data);
-            try_delete(old_head);
-            return res;
-        }
-
-        bool empty()
-            const
-        {
-            return head_.load() == nullptr;
-        }
-
-    private:
-        std::atomic<unsigned int> threads_popping_; // 当前使用pop函数的线程数量
-        std::atomic<node*> delete_candidate_; 
-
-        void try_delete(node* old_head)
-        {
-            // 高并发场景下threads_popping_一直不为1，导致delete_candidate_无限增加，得不到释放
-            // 实际上没有线程访问的node即可释放，使用hazard pointer、引用计数能够实现
-            if (threads_popping_ == 1)
-            {
-                node* candidates = delete_candidate_.exchange(nullptr);
-                if (!(--threads_popping_)) // threads_in_pop为0，无线程调用pop
-                {
-                    delete_nodes(candidates);
-                }
-                else if (candidates)
-                {
-                    add_candidates(candidates);
-                }
-                delete old_head; // 先尝试删除delete_candidate_，再删除old_head
-            }
-            else
-            {
-                if(old_head)
-                    add_candidate(old_head);
-                --threads_popping_;
-            }
-        }
-
-        static void delete_nodes(node* ns)
-        {
-            while (ns)
-            {
-                node* next = ns->next;
-                delete ns;
-                ns = next;
-            }
-        }
-
-        void add_candidate(node* n)
-        {
-            add_candidates(n, n);
-        }
-
-        void add_candidates(node* first, node* last)
-        {
-            last->next = delete_candidate_;
-            while (!delete_candidate_.compare_exchange_weak(last->next, first));
-        }
-
-        void add_candidates(node* ns)
-        {
-            node* last = ns;
-            // 将last移动到链表末端
-            while (node* const next = last->next) 
-            {
-                last = next;
-            }
-            add_candidates(ns, last);
-        }
-    };
-}
+/*
+ * 线程安全的栈
+ * 无锁
+ */
+#ifndef STACK_TS_H
+#define STACK_TS_H
+
+#include <atomic>
+#include <memory>
+
+#include "magazine_allocator.h"
+
+namespace bitstl
+{
+    // 节点和数据均由Alloc分配，默认使用线程缓存的magazine_allocator
+    template<typename T, typename Alloc = magazine_allocator<T>>
+    class stack_ts
+    {
+    private:
+        struct node
+        {
+            std::shared_ptr<T> data;
+            // 弹出失败的线程可能仍在读取已被移入delete_candidate_的节点的next，因此为原子类型
+            std::atomic<node*> next;
+            node(const T& _data, const Alloc& alloc) : data(std::allocate_shared<T>(alloc, _data)), next(nullptr) {}
+            // data移动构造
+            node(T&& _data, const Alloc& alloc) : data(std::allocate_shared<T>(alloc, std::move(_data))), next(nullptr) {}
+        };
+
+        using node_alloc_type  = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+        using node_alloc_traits = std::allocator_traits<node_alloc_type>;
+
+        std::atomic<node*> head_;
+        Alloc alloc_;
+        node_alloc_type node_alloc_;
+
+    public:
+        stack_ts(const Alloc& alloc = Alloc()) : head_(nullptr), alloc_(alloc), node_alloc_(alloc) {}
+
+        stack_ts(const stack_ts&) = delete;
+        stack_ts& operator=(const stack_ts&) = delete;
+
+        // 析构时不应有其它线程访问
+        ~stack_ts()
+        {
+            delete_nodes(head_.load());
+            delete_nodes(delete_candidate_.load());
+        }
+
+        void push(const T& new_value)
+        {
+            push_node(create_node(new_value));
+        }
+
+        void push(T&& new_value)
+        {
+            // 此处也需要std::move
+            push_node(create_node(std::move(new_value)));
+        }
+
+        std::shared_ptr<T> pop()
+        {
+            ++threads_popping_;
+            node* old_head = head_.load();
+            // 当head未被其它指针改动过时更新head_
+            while (old_head && !head_.compare_exchange_weak(old_head, old_head->next.load()));
+            std::shared_ptr<T> res;
+            if (old_head)
+                res.swap(old_head->data);
+            try_delete(old_head);
+            return res;
+        }
+
+        bool empty()
+            const
+        {
+            return head_.load() == nullptr;
+        }
+
+    private:
+        std::atomic<unsigned int> threads_popping_{ 0 }; // 当前使用pop函数的线程数量
+        std::atomic<node*> delete_candidate_{ nullptr };
+
+        void push_node(node* const new_node)
+        {
+            node* old_head = head_.load();
+            // 当head未被其它指针改动过时更新head_
+            do
+            {
+                new_node->next.store(old_head);
+            } while (!head_.compare_exchange_weak(old_head, new_node));
+        }
+
+        void try_delete(node* old_head)
+        {
+            // 高并发场景下threads_popping_一直不为1，导致delete_candidate_无限增加，得不到释放
+            // 实际上没有线程访问的node即可释放，使用hazard pointer、引用计数能够实现
+            if (threads_popping_ == 1)
+            {
+                node* candidates = delete_candidate_.exchange(nullptr);
+                if (!(--threads_popping_)) // threads_in_pop为0，无线程调用pop
+                {
+                    delete_nodes(candidates);
+                }
+                else if (candidates)
+                {
+                    add_candidates(candidates);
+                }
+                destroy_node(old_head); // 先尝试删除delete_candidate_，再删除old_head
+            }
+            else
+            {
+                if(old_head)
+                    add_candidate(old_head);
+                --threads_popping_;
+            }
+        }
+
+        template<typename U>
+        node* create_node(U&& value)
+        {
+            node* p = node_alloc_traits::allocate(node_alloc_, 1);
+            try
+            {
+                node_alloc_traits::construct(node_alloc_, p, std::forward<U>(value), alloc_);
+            }
+            catch (...)
+            {
+                node_alloc_traits::deallocate(node_alloc_, p, 1);
+                throw;
+            }
+            return p;
+        }
+
+        void destroy_node(node* p)
+        {
+            if (!p)
+                return;
+            node_alloc_traits::destroy(node_alloc_, p);
+            node_alloc_traits::deallocate(node_alloc_, p, 1);
+        }
+
+        void delete_nodes(node* ns)
+        {
+            while (ns)
+            {
+                node* next = ns->next.load();
+                destroy_node(ns);
+                ns = next;
+            }
+        }
+
+        void add_candidate(node* n)
+        {
+            add_candidates(n, n);
+        }
+
+        void add_candidates(node* first, node* last)
+        {
+            node* old_first = delete_candidate_.load();
+            do
+            {
+                last->next.store(old_first);
+            } while (!delete_candidate_.compare_exchange_weak(old_first, first));
+        }
+
+        void add_candidates(node* ns)
+        {
+            node* last = ns;
+            // 将last移动到链表末端
+            while (node* const next = last->next.load())
+            {
+                last = next;
+            }
+            add_candidates(ns, last);
+        }
+    };
+}
 #endif // !STACK_TS_H
\ No newline at end of file
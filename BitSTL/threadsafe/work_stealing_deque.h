@@ -0,0 +1,146 @@
+/*
+ * 工作窃取双端队列
+ * 参考Chase、Lev的"Dynamic Circular Work-Stealing Deque"及Lê等人在C11内存模型下的实现
+ * 所有者线程在底部push、pop，其它线程在顶部steal；仅在所有者与窃取者争抢最后一个元素时使用CAS
+ */
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace bitstl
+{
+    // 元素须可平凡复制（一般为任务指针），队列为空或争抢失败时返回T()
+    template<typename T>
+    class work_stealing_deque
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "work_stealing_deque requires trivially copyable elements");
+
+    private:
+        // 容量为2的幂的环形数组，下标对容量取模
+        struct ring
+        {
+            const std::int64_t capacity;
+            const std::int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+
+            explicit ring(std::int64_t _capacity)
+                : capacity(_capacity), mask(_capacity - 1), slots(new std::atomic<T>[_capacity]) {}
+
+            T get(std::int64_t i)
+                const noexcept
+            {
+                return slots[i & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t i, T x)
+                noexcept
+            {
+                slots[i & mask].store(x, std::memory_order_relaxed);
+            }
+
+            // 容量加倍，复制[top, bottom)
+            std::unique_ptr<ring> grow(std::int64_t top, std::int64_t bottom)
+                const
+            {
+                auto bigger = std::make_unique<ring>(capacity * 2);
+                for (std::int64_t i = top; i < bottom; ++i)
+                    bigger->put(i, get(i));
+                return bigger;
+            }
+        };
+
+        // top、bottom分处不同的缓存行，避免窃取者与所有者的伪共享
+        alignas(64) std::atomic<std::int64_t> top_;
+        alignas(64) std::atomic<std::int64_t> bottom_;
+        std::atomic<ring*> ring_;
+        // 扩容后旧数组可能仍在被窃取者读取，直到析构时才释放
+        std::vector<std::unique_ptr<ring>> rings_;
+
+    public:
+        explicit work_stealing_deque(std::int64_t capacity = 256)
+            : top_(0), bottom_(0)
+        {
+            std::int64_t c = 1;
+            while (c < capacity)
+                c *= 2;
+            rings_.push_back(std::make_unique<ring>(c));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+        // 仅所有者线程调用
+        void push(T x)
+        {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_acquire);
+            ring* r = ring_.load(std::memory_order_relaxed);
+            if (b - t > r->capacity - 1)
+            {
+                rings_.push_back(r->grow(t, b));
+                r = rings_.back().get();
+                ring_.store(r, std::memory_order_release);
+            }
+            r->put(b, x);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // 仅所有者线程调用，后进先出
+        T pop()
+        {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            ring* r = ring_.load(std::memory_order_relaxed);
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top_.load(std::memory_order_relaxed);
+
+            T x = T();
+            if (t <= b)
+            {
+                x = r->get(b);
+                // 只剩最后一个元素，与窃取者争抢
+                if (t == b)
+                {
+                    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        x = T();
+                    bottom_.store(b + 1, std::memory_order_relaxed);
+                }
+            }
+            else
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            return x;
+        }
+
+        // 任意线程调用，先进先出
+        T steal()
+        {
+            std::int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+                return T();
+
+            ring* r = ring_.load(std::memory_order_acquire);
+            T x = r->get(t);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return T();
+            return x;
+        }
+
+        // 近似值，仅用于判断是否值得窃取
+        bool empty()
+            const noexcept
+        {
+            return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif // !WORK_STEALING_DEQUE_H
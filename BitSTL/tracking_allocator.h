@@ -0,0 +1,370 @@
+/*
+ * 统计内存使用的分配器适配器
+ * 包装任意分配器，记录分配次数、存活字节数、峰值字节数和按大小分级的直方图
+ */
+#ifndef TRACKING_ALLOCATOR_H
+#define TRACKING_ALLOCATOR_H
+
+#include <atomic>
+#include <bit>
+#include <string>
+#include <thread>
+
+#include "config.h"
+#include "type_traits.h"
+#include "allocator.h"
+#include "allocator_traits.h"
+
+namespace bitstl
+{
+    // tracking_stats在某一时刻的统计结果
+    struct tracking_snapshot
+    {
+        static constexpr size_t size_class_num = 32;
+
+        size_t    allocations;   // 分配次数
+        size_t    deallocations; // 释放次数
+        ptrdiff_t live_bytes;    // 存活字节数
+        ptrdiff_t peak_bytes;    // 峰值字节数
+        // 第i级统计大小在(2^(i-1), 2^i]内的分配次数，第0级为0~1bytes，最后一级包括所有更大的分配
+        size_t    size_classes[size_class_num];
+
+        // 第i级的大小上限
+        static constexpr size_t size_class_bound(size_t i)
+            noexcept
+        {
+            return size_t(1) << i;
+        }
+
+        // 形如{"allocations":3,...,"size_classes":[{"max_bytes":16,"count":2},...]}，只输出非空的级别
+        std::string to_json()
+            const
+        {
+            std::string json = "{\"allocations\":" + std::to_string(allocations)
+                + ",\"deallocations\":" + std::to_string(deallocations)
+                + ",\"live_bytes\":" + std::to_string(live_bytes)
+                + ",\"peak_bytes\":" + std::to_string(peak_bytes)
+                + ",\"size_classes\":[";
+            bool first = true;
+            for (size_t i = 0; i < size_class_num; ++i)
+            {
+                if (!size_classes[i])
+                    continue;
+                if (!first)
+                    json += ',';
+                first = false;
+                json += "{\"max_bytes\":";
+                json += i + 1 == size_class_num ? std::string("null") : std::to_string(size_class_bound(i));
+                json += ",\"count\":" + std::to_string(size_classes[i]) + "}";
+            }
+            json += "]}";
+            return json;
+        }
+    };
+
+    /*
+     * 内存使用统计
+     * 计数器分为stripe_num组，组与组之间按缓存行对齐避免伪共享
+     * 线程首次统计时独占其中一组（线程退出时交还），只有该线程写入，更新为relaxed的读取加写入，无需原子读改写
+     * 组被占满后的线程共用额外的一组，以fetch_add更新，仍然无锁
+     * 峰值需要全局的存活字节数，各组将变化量累积至peak_batch bytes，或可能超过已知峰值时，再汇入全局并更新峰值
+     * 单线程时峰值精确，多线程时误差不超过其它组未汇入的变化量，查询时会以精确的存活字节数修正
+     */
+    class tracking_stats
+    {
+    public:
+        static constexpr size_t    stripe_num = 64; // 可被线程独占的组数
+        static constexpr ptrdiff_t peak_batch = 64 << 10;
+
+        tracking_stats() noexcept = default;
+
+        tracking_stats(const tracking_stats&) = delete;
+        tracking_stats& operator=(const tracking_stats&) = delete;
+
+        // 未指定统计对象的tracking_allocator使用的全局统计
+        static tracking_stats& global()
+            noexcept
+        {
+            static tracking_stats stats;
+            return stats;
+        }
+
+        void record_allocate(size_t bytes)
+            noexcept
+        {
+            const stripe_owner& owner = local_owner();
+            stripe& s = stripes_[owner.index];
+            add(s.allocations, size_t(1), owner.exclusive);
+            add(s.size_classes[size_class(bytes)], size_t(1), owner.exclusive);
+            add_live(s, ptrdiff_t(bytes), owner.exclusive);
+        }
+
+        void record_deallocate(size_t bytes)
+            noexcept
+        {
+            const stripe_owner& owner = local_owner();
+            stripe& s = stripes_[owner.index];
+            add(s.deallocations, size_t(1), owner.exclusive);
+            add_live(s, -ptrdiff_t(bytes), owner.exclusive);
+        }
+
+        void record_expand(size_t old_bytes, size_t new_bytes)
+            noexcept
+        {
+            const stripe_owner& owner = local_owner();
+            add_live(stripes_[owner.index], ptrdiff_t(new_bytes) - ptrdiff_t(old_bytes), owner.exclusive);
+        }
+
+        tracking_snapshot snapshot()
+            const noexcept
+        {
+            tracking_snapshot result{};
+            for (const stripe& s : stripes_)
+            {
+                result.allocations   += s.allocations.load(std::memory_order_relaxed);
+                result.deallocations += s.deallocations.load(std::memory_order_relaxed);
+                result.live_bytes    += s.pending_bytes.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < tracking_snapshot::size_class_num; ++i)
+                    result.size_classes[i] += s.size_classes[i].load(std::memory_order_relaxed);
+            }
+            result.live_bytes += global_live_.load(std::memory_order_relaxed);
+            const ptrdiff_t peak = peak_bytes_.load(std::memory_order_relaxed);
+            result.peak_bytes = peak > result.live_bytes ? peak : result.live_bytes;
+            return result;
+        }
+
+        size_t allocations() const noexcept { return snapshot().allocations; }
+        ptrdiff_t live_bytes() const noexcept { return snapshot().live_bytes; }
+        ptrdiff_t peak_bytes() const noexcept { return snapshot().peak_bytes; }
+
+        std::string to_json()
+            const
+        {
+            return snapshot().to_json();
+        }
+
+        // 清空计数，调用时不应有其它线程通过该统计分配或释放
+        void reset()
+            noexcept
+        {
+            for (stripe& s : stripes_)
+            {
+                s.allocations.store(0, std::memory_order_relaxed);
+                s.deallocations.store(0, std::memory_order_relaxed);
+                s.pending_bytes.store(0, std::memory_order_relaxed);
+                for (auto& c : s.size_classes)
+                    c.store(0, std::memory_order_relaxed);
+            }
+            global_live_.store(0, std::memory_order_relaxed);
+            peak_bytes_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        struct alignas(64) stripe
+        {
+            std::atomic<size_t>    allocations{ 0 };
+            std::atomic<size_t>    deallocations{ 0 };
+            // 尚未汇入全局的存活字节数变化量，区块可以由其它线程释放，因此可能为负
+            std::atomic<ptrdiff_t> pending_bytes{ 0 };
+            std::atomic<size_t>    size_classes[tracking_snapshot::size_class_num] = {};
+        };
+
+        // 最后一组由未能独占的线程共用
+        stripe stripes_[stripe_num + 1];
+        // 存活字节数为global_live_与各组pending_bytes之和
+        alignas(64) std::atomic<ptrdiff_t> global_live_{ 0 };
+        std::atomic<ptrdiff_t> peak_bytes_{ 0 };
+
+        // 组号在所有tracking_stats间共用，线程在每个统计对象中使用同一组号
+        inline static std::atomic<bool> stripe_used_[stripe_num] = {};
+
+        // 线程持有的组号，线程退出时交还
+        struct stripe_owner
+        {
+            size_t index;
+            bool   exclusive;
+
+            stripe_owner() noexcept : index(stripe_num), exclusive(false)
+            {
+                for (size_t i = 0; i < stripe_num; ++i)
+                {
+                    if (!stripe_used_[i].load(std::memory_order_relaxed) &&
+                        !stripe_used_[i].exchange(true, std::memory_order_acquire))
+                    {
+                        index = i;
+                        exclusive = true;
+                        break;
+                    }
+                }
+            }
+
+            // release保证下一个持有者看到本线程写入的计数
+            ~stripe_owner()
+            {
+                if (exclusive)
+                    stripe_used_[index].store(false, std::memory_order_release);
+            }
+        };
+
+        static const stripe_owner& local_owner()
+            noexcept
+        {
+            thread_local const stripe_owner owner;
+            return owner;
+        }
+
+        template<typename U>
+        static U add(std::atomic<U>& counter, U delta, bool exclusive)
+            noexcept
+        {
+            if (exclusive)
+            {
+                const U result = counter.load(std::memory_order_relaxed) + delta;
+                counter.store(result, std::memory_order_relaxed);
+                return result;
+            }
+            return counter.fetch_add(delta, std::memory_order_relaxed) + delta;
+        }
+
+        static constexpr size_t size_class(size_t bytes)
+            noexcept
+        {
+            const size_t i = bytes > 1 ? size_t(std::bit_width(bytes - 1)) : 0;
+            return i < tracking_snapshot::size_class_num ? i : tracking_snapshot::size_class_num - 1;
+        }
+
+        void add_live(stripe& s, ptrdiff_t delta, bool exclusive)
+            noexcept
+        {
+            const ptrdiff_t pending = add(s.pending_bytes, delta, exclusive);
+            // 未达到批量时，只有可能刷新峰值的分配才汇入全局；稳定状态下仅读取全局计数，不产生缓存行争用
+            if (pending < peak_batch && pending > -peak_batch)
+            {
+                if (delta <= 0)
+                    return;
+                if (global_live_.load(std::memory_order_relaxed) + pending <= peak_bytes_.load(std::memory_order_relaxed))
+                    return;
+            }
+
+            const ptrdiff_t flushed = exclusive
+                ? (s.pending_bytes.store(0, std::memory_order_relaxed), pending)
+                : s.pending_bytes.exchange(0, std::memory_order_relaxed);
+            const ptrdiff_t live = global_live_.fetch_add(flushed, std::memory_order_relaxed) + flushed;
+            ptrdiff_t peak = peak_bytes_.load(std::memory_order_relaxed);
+            while (live > peak && !peak_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+        }
+    };
+
+    /*
+     * 统计内存使用的分配器适配器
+     * 实际的分配与释放交由Alloc，同时将字节数记入tracking_stats
+     * 定义了rebind，重绑定后的分配器共享同一统计对象，节点容器的节点分配也能被统计
+     */
+    template<typename Alloc>
+    class tracking_allocator
+    {
+    private:
+        using inner_traits = allocator_traits<Alloc>;
+
+    public:
+        using inner_allocator_type = Alloc;
+        using value_type           = typename inner_traits::value_type;
+        using size_type            = typename inner_traits::size_type;
+        using difference_type      = typename inner_traits::difference_type;
+
+        // 传播与相等性由内部分配器和统计对象共同决定
+        using propagate_on_container_copy_assignment = typename inner_traits::propagate_on_container_copy_assignment;
+        using propagate_on_container_move_assignment = typename inner_traits::propagate_on_container_move_assignment;
+        using propagate_on_container_swap            = typename inner_traits::propagate_on_container_swap;
+        using is_always_equal                        = false_type;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = tracking_allocator<typename inner_traits::template rebind_alloc<U>>;
+        };
+
+        tracking_allocator() noexcept(noexcept(Alloc()))
+            : inner_(), stats_(&tracking_stats::global()) {}
+
+        explicit tracking_allocator(tracking_stats& stats, const Alloc& inner = Alloc())
+            : inner_(inner), stats_(&stats) {}
+
+        tracking_allocator(const tracking_allocator&) = default;
+
+        template<typename A>
+        tracking_allocator(const tracking_allocator<A>& other)
+            : inner_(other.inner_allocator()), stats_(&other.stats()) {}
+
+        tracking_allocator& operator=(const tracking_allocator&) = default;
+
+        const Alloc& inner_allocator()
+            const noexcept
+        {
+            return inner_;
+        }
+
+        tracking_stats& stats()
+            const noexcept
+        {
+            return *stats_;
+        }
+
+        [[nodiscard]]
+        value_type* allocate(size_type n)
+        {
+            value_type* p = inner_traits::allocate(inner_, n);
+            stats_->record_allocate(n * sizeof(value_type));
+            return p;
+        }
+
+        void deallocate(value_type* p, size_type n)
+        {
+            inner_traits::deallocate(inner_, p, n);
+            stats_->record_deallocate(n * sizeof(value_type));
+        }
+
+        [[nodiscard]]
+        allocation_result<value_type*, size_type> allocate_at_least(size_type n)
+        {
+            auto result = inner_traits::allocate_at_least(inner_, n);
+            stats_->record_allocate(result.count * sizeof(value_type));
+            return { result.ptr, result.count };
+        }
+
+        // 原地扩展只计入存活字节数的变化，不算作一次分配
+        bool try_expand(value_type* p, size_type old_n, size_type new_n)
+        {
+            if (!inner_traits::try_expand(inner_, p, old_n, new_n))
+                return false;
+            stats_->record_expand(old_n * sizeof(value_type), new_n * sizeof(value_type));
+            return true;
+        }
+
+        tracking_allocator select_on_container_copy_construction()
+            const
+        {
+            return tracking_allocator(*stats_, inner_traits::select_on_container_copy_construction(inner_));
+        }
+
+        template<typename A>
+        friend bool operator==(const tracking_allocator& lhs, const tracking_allocator<A>& rhs)
+            noexcept
+        {
+            return &lhs.stats() == &rhs.stats() && lhs.inner_allocator() == rhs.inner_allocator();
+        }
+
+        template<typename A>
+        friend bool operator!=(const tracking_allocator& lhs, const tracking_allocator<A>& rhs)
+            noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Alloc inner_;
+        tracking_stats* stats_;
+    };
+}
+
+#endif // !TRACKING_ALLOCATOR_H
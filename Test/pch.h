@@ -1,13 +1,16 @@
-//
-// pch.h
-//
-
-#pragma once
-
-#include "gtest/gtest.h"
-
-#include <syncstream>
-#include <random>
-#include <iterator>
-#include <cmath>
-#include <numeric>
+//
+// pch.h
+//
+
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include <syncstream>
+#include <random>
+#include <iterator>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <execution>
+#include <barrier>
@@ -1,390 +1,1522 @@
-#include "pch.h"
-#include "common.h"
-
-namespace test_type_traits
-{
-    template<typename T>
-    T add(T a, type_identity_t<T> b) { return a + b; }
-
-    template<typename T>
-    class Foo {};
-
-    TEST(Test_type_identity_t, Test0)
-    {
-        ASSERT_EQ(add(1.f, 2), 1.f + 2);
-    }
-
-    TEST(Test_is_same, Test0)
-    {
-        ASSERT_TRUE((is_same_v<int, int>));
-        ASSERT_FALSE((is_same_v<int, float>));
-        ASSERT_FALSE((is_same<float, Foo<float>>()));
-        ASSERT_FALSE((is_same<float, double>{}));
-    }
-
-    TEST(Test_replace_first_arg, Test0)
-    {
-        ASSERT_TRUE((is_same_v<
-            Foo<int>,
-            typename replace_first_arg<Foo<float>, int>::type>));
-    }
-}
-
-namespace test_vector
-{
-    class Foo
-    {
-    public:
-        int x;
-        Foo() { x = -1; }
-        explicit Foo(int _x) : x(_x + 1) {}
-        bool operator==(const Foo& other)
-            const
-        {
-            return x == other.x;
-        }
-        auto operator<=>(const Foo& other)
-            const
-        {
-            return x <=> other.x;
-        }
-    };
-
-    template <typename T>
-    T sum(T* arr, size_t size) 
-    {
-        remove_const_t<T> res = remove_const_t<T>();
-        for (size_t i = 0; i < size; ++i)
-            res += arr[i];
-        return res;
-    }
-
-    TEST(Test_ctor, Test0)
-    {
-        vector<int> v1();
-
-        vector<int> v2(10);
-        ASSERT_EQ(v2[5], 0);
-
-        vector<int> v3(200, 3);
-        ASSERT_EQ(v3[127], 3);
-
-        int a[3] = { 4, 5, 6 };
-        ASSERT_TRUE(is_input_iterator<int*>);
-        vector<int> v4(a, a+3);
-        ASSERT_EQ(v4[2], 6);
-
-        vector<int> v5(v4);
-        ASSERT_EQ(v5[2], v4[2]);
-
-        vector<int> v6(move(v5));
-        ASSERT_EQ(v6[2], v4[2]);
-
-        vector<int> v7{ 7, 8, 9 };
-        ASSERT_EQ(v7[2], 9);
-    }
-
-    TEST(Test_ctor, Test1)
-    {
-        vector<Foo> v1();
-
-        vector<Foo> v2(10);
-        ASSERT_EQ(v2[5].x, -1);
-
-        vector<Foo> v3(200, Foo(3));
-        ASSERT_EQ(v3[127].x, 4);
-
-        Foo a[3] = { Foo(4), Foo(5), Foo(6) };
-        ASSERT_TRUE(is_input_iterator<Foo*>);
-        vector<Foo> v4(a, a + 3);
-        ASSERT_EQ(v4[2].x, 7);
-
-        vector<Foo> v5(v4);
-        ASSERT_EQ(v5[2], v4[2]);
-
-        vector<Foo> v6(move(v5));
-        ASSERT_EQ(v6[2], v4[2]);
-
-        vector<Foo> v7{ Foo(7), Foo(8), Foo(9) };
-        ASSERT_EQ(v7[2].x, 10);
-    }
-
-    TEST(Test_data_access, Test0)
-    {
-        vector<int> v{1, 2, 3};
-        const vector<int> cv{ 4, 5, 6 };
-        ASSERT_EQ( *v.begin(),   v[0]);
-        ASSERT_EQ(*cv.begin(),  cv[0]);
-        ASSERT_EQ(*cv.cbegin(), cv[0]);
-        ASSERT_EQ( *(v.end()  - 1),  v[2]);
-        ASSERT_EQ(*(cv.end()  - 1), cv[2]);
-        ASSERT_EQ(*(cv.cend() - 1), cv[2]);
-        ASSERT_EQ( *v.rbegin(),   v[2]);
-        ASSERT_EQ(*cv.rbegin(),  cv[2]);
-        ASSERT_EQ(*cv.crbegin(), cv[2]);
-        ASSERT_EQ( *(v.rend()  - 1),  v[0]);
-        ASSERT_EQ(*(cv.rend()  - 1), cv[0]);
-        ASSERT_EQ(*(cv.crend() - 1), cv[0]);
-    }
-
-    TEST(Test_data_access, Test1)
-    {
-        vector<int> v{ 1, 2, 3 };
-        const vector<int> cv{ 4, 5, 6 };
-        ASSERT_EQ( v[0],  v.at(0));
-        ASSERT_EQ(cv[0], cv.at(0));
-        ASSERT_EQ( v.front(),  v.at(0));
-        ASSERT_EQ(cv.front(), cv.at(0));
-        ASSERT_EQ( v.back(),   v.at(2));
-        ASSERT_EQ(cv.back(),  cv.at(2));
-
-    }
-
-    TEST(Test_data_access, Test2)
-    {
-        vector<int> v{ 1, 2, 3 };
-        const vector<int> cv{ 4, 5, 6 };
-        ASSERT_EQ(sum( v.data(),  v.size()),  6);
-        ASSERT_EQ(sum(cv.data(), cv.size()), 15);
-    }
-
-    TEST(Test_swap, Test0)
-    {
-        vector<int> v1{ 1, 2, 3 };
-        vector<int> v2{ 4, 5, 6 };
-        v1.swap(v2);
-        ASSERT_EQ(v1[0], 4);
-        ASSERT_EQ(v2[0], 1);
-    }
-
-    TEST(Test_swap, Test1)
-    {
-        vector<int> v1{ 1, 2, 3 };
-        vector<int> v2{ 4, 5, 6 };
-        swap(v1, v2);
-        ASSERT_EQ(v1[0], 4);
-        ASSERT_EQ(v2[0], 1);
-    }
-
-    TEST(Test_capacity, Test0)
-    {
-        vector<int> v1{};
-        ASSERT_TRUE(v1.empty());
-        ASSERT_EQ(v1.size(), 0);
-        ASSERT_EQ(v1.max_size(), static_cast<size_t>(-1) / sizeof(int));
-        ASSERT_EQ(allocator<int>(), v1.get_allocator());
-    }
-
-    TEST(Test_capacity, Test1)
-    {
-        vector<int> v2{ 1, 2, 3 };
-        ASSERT_EQ(v2.capacity(), 3);
-        v2.reserve(8);
-        ASSERT_EQ(v2.capacity(), 8);
-        v2.shrink_to_fit();
-        ASSERT_EQ(v2.capacity(), 3);
-    }
-
-    TEST(Test_assign_op, Test0)
-    {
-        vector<int> v1{ 1, 2 };
-        vector<int> v2{ 1, 2, 3, 4 };
-        v1 = v2;
-        ASSERT_EQ(v1.size(), 4);
-        ASSERT_EQ(v1.capacity(), 4);
-    }
-
-    TEST(Test_assign_op, Test1)
-    {
-        vector<int> v1{ 1, 2, 3, 4 };
-        vector<int> v2{ 1, 2 };
-        v1 = v2;
-        ASSERT_EQ(v1.size(), 2);
-        ASSERT_EQ(v1.capacity(), 4);
-    }
-
-    TEST(Test_assign_op, Test2)
-    {
-        vector<int> v1{ 1, 2 };
-        vector<int> v2{ 1, 2, 3, 4 };
-        v1.reserve(6);
-        v1 = v2;
-        ASSERT_EQ(v1.size(), 4);
-        ASSERT_EQ(v1.capacity(), 4);
-    }
-
-    TEST(Test_assign_op, Test3)
-    {
-        vector<int> v1{ 1, 2 };
-        vector<int> v2{ 1, 2, 3, 4 };
-        v1 = move(v2);
-        ASSERT_EQ(v1.size(), 4);
-        ASSERT_EQ(v1.capacity(), 4);
-        ASSERT_EQ(v2.size(), 0);
-    }
-
-    TEST(Test_assign_op, Test4)
-    {
-        vector<int> v1{ 1, 2 };
-        v1 = { 1, 2, 3, 4 };
-        ASSERT_EQ(v1.size(), 4);
-        ASSERT_EQ(v1.capacity(), 4);
-    }
-
-    TEST(Test_assign, Test0)
-    {
-        vector<int> v1{ 1, 2, 3};
-        v1.assign(5, 1);
-        ASSERT_EQ(v1.size(), 5);
-        ASSERT_EQ(v1.capacity(), 5);
-    }
-
-    TEST(Test_assign, Test1)
-    {
-        vector<int> v1{ 1, 2, 3 };
-        v1.reserve(7);
-        v1.assign(5, 1);
-        ASSERT_EQ(v1.size(), 5);
-        ASSERT_EQ(v1.capacity(), 7);
-    }
-
-    TEST(Test_assign, Test2)
-    {
-        vector<int> v1{ 1, 2, 3 };
-        v1.assign(2, 1);
-        ASSERT_EQ(v1.size(), 2);
-        ASSERT_EQ(v1.capacity(), 3);
-    }
-
-    TEST(Test_assign, Test3)
-    {
-        vector<int> v1{ 1, 2, 3 };
-        vector<int> v2{ 4, 5, 6 };
-
-        v1.assign(v2.begin(), v2.begin() + 2);
-        ASSERT_EQ(v1.size(), 2);
-        ASSERT_EQ(v1.capacity(), 2);
-
-        v1.assign({ 7, 8, 9, 10 });
-        ASSERT_EQ(v1.size(), 4);
-        ASSERT_EQ(v1.capacity(), 4);
-
-        v1.resize(5, 8);
-        ASSERT_EQ(v1[0], 8);
-        ASSERT_EQ(v1.size(), 5);
-        ASSERT_EQ(v1.capacity(), 5);
-    }
-
-    TEST(Test_erase, Test0)
-    {
-        vector<int> v1{ 1, 2, 3, 4, 5, 6 };
-        v1.erase(v1.begin() + 1);
-        ASSERT_EQ(v1[1], 3);
-        v1.erase(v1.begin(), v1.end() - 1);
-        ASSERT_EQ(v1[0], 6);
-        v1.clear();
-        ASSERT_EQ(v1.size(), 0);
-        ASSERT_EQ(v1.capacity(), 6);
-    }
-
-    TEST(Test_push_pop, test0)
-    {
-        vector<int> v1;
-        int x = 3;
-        v1.resize(5, 1);        
-        v1.push_back(2);
-        v1.push_back(x);
-        v1.pop_back();
-        ASSERT_EQ(v1.emplace_back(move(x)), x);
-        ASSERT_EQ(v1.size(), 7);
-        ASSERT_EQ(v1.capacity(), 10);
-    }
-
-    TEST(Test_insert, test0)
-    {
-        vector<int> v1{ 1, 2, 3, 4, 5, 6 };
-        int x = 3;
-        v1.insert(v1.begin(), 7);
-        ASSERT_EQ(v1[0], 7);
-        v1.insert(v1.begin() + 1, x);
-        ASSERT_EQ(v1[1], x);
-        v1.emplace(v1.begin() + 2, 9);
-        ASSERT_EQ(v1[2], 9);
-        v1.insert(v1.begin(), 2, 8);
-        ASSERT_EQ(v1[0], 8);
-        ASSERT_EQ(v1[1], 8);
-        vector<int>().swap(v1);
-        vector<int> v2{ 1, 2, 3 };
-        v1.insert(v1.begin(), v2.begin(), v2.end());
-        ASSERT_EQ(v1[0], 1);
-        vector<int>().swap(v1);
-        v1.insert(v1.begin(), { 1, 2, 3 });
-        ASSERT_EQ(v1[0], 1);
-    }
-}
-
-namespace test_delegate
-{
-    class Foo
-    {      
-    public:
-        int x = 0;
-
-        Foo() {}
-        ~Foo() {}
-
-        int add(int a, int b)
-        {
-            return a + b;
-        }
-
-        void store_add(int a, int b)
-        {
-            x = a + b;
-        }
-    };
-    
-    int add(int a, int b)
-    {
-        return a + b;
-    }
-
-    TEST(Test_delegate_twoparam, Test0)
-    {
-        Foo test;
-        auto delegate1 = 
-            delegate_twoparam<int, int, int>
-            ::from_class_func<Foo, &Foo::add>(&test);
-        ASSERT_EQ(delegate1(1, 3), 4);
-        ASSERT_EQ(delegate1.execute(2, 2), 4);
-        ASSERT_TRUE(delegate1.isbound());
-        delegate1.unbind();
-        ASSERT_FALSE(delegate1.isbound());
-        delegate1.bind_func<&add>();
-        ASSERT_EQ(delegate1(1, 7), 8);
-
-        auto delegate2 =
-            delegate_twoparam<int, int, int>
-            ::from_func<&add>();
-        ASSERT_EQ(delegate2(2, 4), 6);
-        ASSERT_EQ(delegate2.execute(2, 4), 6);
-        ASSERT_TRUE(delegate2.isbound());
-        delegate2.unbind();
-        ASSERT_FALSE(delegate2.isbound());
-        delegate2.bind_class_func<Foo, &Foo::add>(&test);
-        ASSERT_EQ(delegate2(1, 5), 6);
-        ASSERT_FALSE(delegate2.execute_ifbound(2, 3));
-
-        auto delegate3 =
-            delegate_twoparam<void, int, int>
-            ::from_class_func<Foo, &Foo::store_add>(&test);
-        ASSERT_TRUE(delegate3.execute_ifbound(2, 3));
-        ASSERT_TRUE(test.x, 5);        
-    }
-}
-
-int main(int argc, char** argv)
-{
-    testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+#include "pch.h"
+#include "common.h"
+
+namespace test_type_traits
+{
+    template<typename T>
+    T add(T a, type_identity_t<T> b) { return a + b; }
+
+    template<typename T>
+    class Foo {};
+
+    TEST(Test_type_identity_t, Test0)
+    {
+        ASSERT_EQ(add(1.f, 2), 1.f + 2);
+    }
+
+    TEST(Test_is_same, Test0)
+    {
+        ASSERT_TRUE((is_same_v<int, int>));
+        ASSERT_FALSE((is_same_v<int, float>));
+        ASSERT_FALSE((is_same<float, Foo<float>>()));
+        ASSERT_FALSE((is_same<float, double>{}));
+    }
+
+    TEST(Test_replace_first_arg, Test0)
+    {
+        ASSERT_TRUE((is_same_v<
+            Foo<int>,
+            typename replace_first_arg<Foo<float>, int>::type>));
+    }
+}
+
+namespace test_vector
+{
+    class Foo
+    {
+    public:
+        int x;
+        Foo() { x = -1; }
+        explicit Foo(int _x) : x(_x + 1) {}
+        bool operator==(const Foo& other)
+            const
+        {
+            return x == other.x;
+        }
+        auto operator<=>(const Foo& other)
+            const
+        {
+            return x <=> other.x;
+        }
+    };
+
+    template <typename T>
+    T sum(T* arr, size_t size) 
+    {
+        remove_const_t<T> res = remove_const_t<T>();
+        for (size_t i = 0; i < size; ++i)
+            res += arr[i];
+        return res;
+    }
+
+    TEST(Test_ctor, Test0)
+    {
+        vector<int> v1();
+
+        vector<int> v2(10);
+        ASSERT_EQ(v2[5], 0);
+
+        vector<int> v3(200, 3);
+        ASSERT_EQ(v3[127], 3);
+
+        int a[3] = { 4, 5, 6 };
+        ASSERT_TRUE(is_input_iterator<int*>);
+        vector<int> v4(a, a+3);
+        ASSERT_EQ(v4[2], 6);
+
+        vector<int> v5(v4);
+        ASSERT_EQ(v5[2], v4[2]);
+
+        vector<int> v6(move(v5));
+        ASSERT_EQ(v6[2], v4[2]);
+
+        vector<int> v7{ 7, 8, 9 };
+        ASSERT_EQ(v7[2], 9);
+    }
+
+    TEST(Test_ctor, Test1)
+    {
+        vector<Foo> v1();
+
+        vector<Foo> v2(10);
+        ASSERT_EQ(v2[5].x, -1);
+
+        vector<Foo> v3(200, Foo(3));
+        ASSERT_EQ(v3[127].x, 4);
+
+        Foo a[3] = { Foo(4), Foo(5), Foo(6) };
+        ASSERT_TRUE(is_input_iterator<Foo*>);
+        vector<Foo> v4(a, a + 3);
+        ASSERT_EQ(v4[2].x, 7);
+
+        vector<Foo> v5(v4);
+        ASSERT_EQ(v5[2], v4[2]);
+
+        vector<Foo> v6(move(v5));
+        ASSERT_EQ(v6[2], v4[2]);
+
+        vector<Foo> v7{ Foo(7), Foo(8), Foo(9) };
+        ASSERT_EQ(v7[2].x, 10);
+    }
+
+    TEST(Test_data_access, Test0)
+    {
+        vector<int> v{1, 2, 3};
+        const vector<int> cv{ 4, 5, 6 };
+        ASSERT_EQ( *v.begin(),   v[0]);
+        ASSERT_EQ(*cv.begin(),  cv[0]);
+        ASSERT_EQ(*cv.cbegin(), cv[0]);
+        ASSERT_EQ( *(v.end()  - 1),  v[2]);
+        ASSERT_EQ(*(cv.end()  - 1), cv[2]);
+        ASSERT_EQ(*(cv.cend() - 1), cv[2]);
+        ASSERT_EQ( *v.rbegin(),   v[2]);
+        ASSERT_EQ(*cv.rbegin(),  cv[2]);
+        ASSERT_EQ(*cv.crbegin(), cv[2]);
+        ASSERT_EQ( *(v.rend()  - 1),  v[0]);
+        ASSERT_EQ(*(cv.rend()  - 1), cv[0]);
+        ASSERT_EQ(*(cv.crend() - 1), cv[0]);
+    }
+
+    TEST(Test_data_access, Test1)
+    {
+        vector<int> v{ 1, 2, 3 };
+        const vector<int> cv{ 4, 5, 6 };
+        ASSERT_EQ( v[0],  v.at(0));
+        ASSERT_EQ(cv[0], cv.at(0));
+        ASSERT_EQ( v.front(),  v.at(0));
+        ASSERT_EQ(cv.front(), cv.at(0));
+        ASSERT_EQ( v.back(),   v.at(2));
+        ASSERT_EQ(cv.back(),  cv.at(2));
+
+    }
+
+    TEST(Test_data_access, Test2)
+    {
+        vector<int> v{ 1, 2, 3 };
+        const vector<int> cv{ 4, 5, 6 };
+        ASSERT_EQ(sum( v.data(),  v.size()),  6);
+        ASSERT_EQ(sum(cv.data(), cv.size()), 15);
+    }
+
+    TEST(Test_swap, Test0)
+    {
+        vector<int> v1{ 1, 2, 3 };
+        vector<int> v2{ 4, 5, 6 };
+        v1.swap(v2);
+        ASSERT_EQ(v1[0], 4);
+        ASSERT_EQ(v2[0], 1);
+    }
+
+    TEST(Test_swap, Test1)
+    {
+        vector<int> v1{ 1, 2, 3 };
+        vector<int> v2{ 4, 5, 6 };
+        swap(v1, v2);
+        ASSERT_EQ(v1[0], 4);
+        ASSERT_EQ(v2[0], 1);
+    }
+
+    TEST(Test_capacity, Test0)
+    {
+        vector<int> v1{};
+        ASSERT_TRUE(v1.empty());
+        ASSERT_EQ(v1.size(), 0);
+        ASSERT_EQ(v1.max_size(), static_cast<size_t>(-1) / sizeof(int));
+        ASSERT_EQ(allocator<int>(), v1.get_allocator());
+    }
+
+    TEST(Test_capacity, Test1)
+    {
+        vector<int> v2{ 1, 2, 3 };
+        ASSERT_EQ(v2.capacity(), 3);
+        v2.reserve(8);
+        ASSERT_EQ(v2.capacity(), 8);
+        v2.shrink_to_fit();
+        ASSERT_EQ(v2.capacity(), 3);
+    }
+
+    TEST(Test_assign_op, Test0)
+    {
+        vector<int> v1{ 1, 2 };
+        vector<int> v2{ 1, 2, 3, 4 };
+        v1 = v2;
+        ASSERT_EQ(v1.size(), 4);
+        ASSERT_EQ(v1.capacity(), 4);
+    }
+
+    TEST(Test_assign_op, Test1)
+    {
+        vector<int> v1{ 1, 2, 3, 4 };
+        vector<int> v2{ 1, 2 };
+        v1 = v2;
+        ASSERT_EQ(v1.size(), 2);
+        ASSERT_EQ(v1.capacity(), 4);
+    }
+
+    TEST(Test_assign_op, Test2)
+    {
+        vector<int> v1{ 1, 2 };
+        vector<int> v2{ 1, 2, 3, 4 };
+        v1.reserve(6);
+        const int* data = v1.data();
+        // 容量足够时不重新分配
+        v1 = v2;
+        ASSERT_EQ(v1.size(), 4);
+        ASSERT_EQ(v1.capacity(), 6);
+        ASSERT_EQ(v1.data(), data);
+        ASSERT_EQ(v1[3], 4);
+    }
+
+    TEST(Test_assign_op, Test3)
+    {
+        vector<int> v1{ 1, 2 };
+        vector<int> v2{ 1, 2, 3, 4 };
+        v1 = move(v2);
+        ASSERT_EQ(v1.size(), 4);
+        ASSERT_EQ(v1.capacity(), 4);
+        ASSERT_EQ(v2.size(), 0);
+    }
+
+    TEST(Test_assign_op, Test4)
+    {
+        vector<int> v1{ 1, 2 };
+        v1 = { 1, 2, 3, 4 };
+        ASSERT_EQ(v1.size(), 4);
+        ASSERT_EQ(v1.capacity(), 4);
+    }
+
+    TEST(Test_assign, Test0)
+    {
+        vector<int> v1{ 1, 2, 3};
+        v1.assign(5, 1);
+        ASSERT_EQ(v1.size(), 5);
+        ASSERT_EQ(v1.capacity(), 5);
+    }
+
+    TEST(Test_assign, Test1)
+    {
+        vector<int> v1{ 1, 2, 3 };
+        v1.reserve(7);
+        v1.assign(5, 1);
+        ASSERT_EQ(v1.size(), 5);
+        ASSERT_EQ(v1.capacity(), 7);
+    }
+
+    TEST(Test_assign, Test2)
+    {
+        vector<int> v1{ 1, 2, 3 };
+        v1.assign(2, 1);
+        ASSERT_EQ(v1.size(), 2);
+        ASSERT_EQ(v1.capacity(), 3);
+    }
+
+    TEST(Test_assign, Test3)
+    {
+        vector<int> v1{ 1, 2, 3 };
+        vector<int> v2{ 4, 5, 6 };
+
+        v1.assign(v2.begin(), v2.begin() + 2);
+        ASSERT_EQ(v1.size(), 2);
+        ASSERT_EQ(v1.capacity(), 2);
+
+        v1.assign({ 7, 8, 9, 10 });
+        ASSERT_EQ(v1.size(), 4);
+        ASSERT_EQ(v1.capacity(), 4);
+
+        v1.resize(5, 8);
+        ASSERT_EQ(v1[0], 8);
+        ASSERT_EQ(v1.size(), 5);
+        ASSERT_EQ(v1.capacity(), 5);
+    }
+
+    TEST(Test_erase, Test0)
+    {
+        vector<int> v1{ 1, 2, 3, 4, 5, 6 };
+        v1.erase(v1.begin() + 1);
+        ASSERT_EQ(v1[1], 3);
+        v1.erase(v1.begin(), v1.end() - 1);
+        ASSERT_EQ(v1[0], 6);
+        v1.clear();
+        ASSERT_EQ(v1.size(), 0);
+        ASSERT_EQ(v1.capacity(), 6);
+    }
+
+    TEST(Test_push_pop, test0)
+    {
+        vector<int> v1;
+        int x = 3;
+        v1.resize(5, 1);        
+        v1.push_back(2);
+        v1.push_back(x);
+        v1.pop_back();
+        ASSERT_EQ(v1.emplace_back(move(x)), x);
+        ASSERT_EQ(v1.size(), 7);
+        ASSERT_EQ(v1.capacity(), 10);
+    }
+
+    TEST(Test_insert, test0)
+    {
+        vector<int> v1{ 1, 2, 3, 4, 5, 6 };
+        int x = 3;
+        v1.insert(v1.begin(), 7);
+        ASSERT_EQ(v1[0], 7);
+        v1.insert(v1.begin() + 1, x);
+        ASSERT_EQ(v1[1], x);
+        v1.emplace(v1.begin() + 2, 9);
+        ASSERT_EQ(v1[2], 9);
+        v1.insert(v1.begin(), 2, 8);
+        ASSERT_EQ(v1[0], 8);
+        ASSERT_EQ(v1[1], 8);
+        vector<int>().swap(v1);
+        vector<int> v2{ 1, 2, 3 };
+        v1.insert(v1.begin(), v2.begin(), v2.end());
+        ASSERT_EQ(v1[0], 1);
+        vector<int>().swap(v1);
+        v1.insert(v1.begin(), { 1, 2, 3 });
+        ASSERT_EQ(v1[0], 1);
+    }
+}
+
+namespace test_algorithm
+{
+    TEST(Test_contiguous_iterator, Test0)
+    {
+        ASSERT_TRUE(is_contiguous_iterator<int*>);
+        ASSERT_TRUE(is_contiguous_iterator<const int*>);
+        ASSERT_TRUE(is_contiguous_iterator<vector<int>::iterator>);
+        ASSERT_FALSE(is_contiguous_iterator<vector<int>::reverse_iterator>);
+        ASSERT_TRUE(is_random_access_iterator<vector<int>::reverse_iterator>);
+        ASSERT_FALSE(is_contiguous_iterator<std::list<int>::iterator>);
+
+        ASSERT_TRUE((is_memmove_copyable<const int*, int*, false>));
+        ASSERT_TRUE((is_memmove_copyable<vector<int>::const_iterator, vector<int>::iterator, true>));
+        ASSERT_FALSE((is_memmove_copyable<int*, const int*, false>));
+        ASSERT_FALSE((is_memmove_copyable<int*, long*, false>));
+        ASSERT_FALSE((is_memmove_copyable<std::list<int>::iterator, int*, false>));
+        ASSERT_FALSE((is_memmove_copyable<vector<int>*, vector<int>*, false>));
+        ASSERT_TRUE(is_memset_fillable<vector<double>::iterator>);
+        ASSERT_FALSE(is_memset_fillable<vector<int>::reverse_iterator>);
+    }
+
+    TEST(Test_contiguous_iterator, Test1)
+    {
+        vector<int> v1{ 1, 2, 3, 4, 5, 6 };
+        int a[6] = {};
+        ASSERT_EQ(copy(v1.begin(), v1.end(), a), a + 6);
+        ASSERT_EQ(a[5], 6);
+        // 区间重叠
+        ASSERT_EQ(move(v1.begin() + 2, v1.end(), v1.begin()), v1.begin() + 4);
+        ASSERT_EQ(v1[0], 3);
+        ASSERT_EQ(v1[3], 6);
+
+        std::list<int> l1{ 7, 8 };
+        ASSERT_EQ(bitstl::copy(l1.begin(), l1.end(), a), a + 2);
+        ASSERT_EQ(a[1], 8);
+
+        // 各字节相同的值使用memset，其余逐个写入
+        vector<int> v2(100, 1);
+        fill(v2.begin(), v2.end(), 0);
+        ASSERT_EQ(v2[99], 0);
+        fill(v2.begin(), v2.end(), -1);
+        ASSERT_EQ(v2[50], -1);
+        ASSERT_EQ(fill_n(v2.begin(), 10, 0x01020304), v2.begin() + 10);
+        ASSERT_EQ(v2[9], 0x01020304);
+        ASSERT_EQ(v2[10], -1);
+        ASSERT_EQ(fill_n(v2.begin(), -1, 5), v2.begin());
+
+        vector<char> v3(10, 'a');
+        fill(v3.begin() + 5, v3.end(), 98);
+        ASSERT_EQ(v3[4], 'a');
+        ASSERT_EQ(v3[5], 'b');
+
+        vector<double> v4(10, 2.5);
+        fill_n(v4.begin(), 5, 0.5);
+        ASSERT_EQ(v4[4], 0.5);
+        ASSERT_EQ(v4[5], 2.5);
+    }
+
+    TEST(Test_contiguous_iterator, Test2)
+    {
+        // 16B至64MiB（定义BENCH_LARGE时至1GiB），每个大小重复至共处理256MiB
+#ifdef BENCH_LARGE
+        const size_t max_bytes = size_t(1) << 30;
+#else
+        const size_t max_bytes = size_t(1) << 26;
+#endif
+        const size_t total_bytes = size_t(1) << 28;
+        std::vector<int> src(max_bytes / sizeof(int), 1), dst(max_bytes / sizeof(int));
+
+        for (size_t bytes = 16; bytes <= max_bytes; bytes *= 4)
+        {
+            const size_t n = bytes / sizeof(int);
+            const size_t reps = total_bytes / bytes;
+            int* first = src.data();
+            int* dest = dst.data();
+            LOG << "copy " << bytes << " bytes x " << reps << std::endl;
+            {
+                BENCHMARK(for (size_t i = 0; i < reps; ++i) copy(first, first + n, dest); ,
+                    for (size_t i = 0; i < reps; ++i) std::copy(first, first + n, dest););
+            }
+            LOG << "fill " << bytes << " bytes x " << reps << std::endl;
+            {
+                BENCHMARK(for (size_t i = 0; i < reps; ++i) fill_n(dest, n, 0x01020304); ,
+                    for (size_t i = 0; i < reps; ++i) std::fill_n(dest, n, 0x01020304););
+            }
+            ASSERT_EQ(dst[n - 1], 0x01020304);
+        }
+    }
+
+    // 与std的结果逐个比较，覆盖向量宽度前后的长度与未对齐的起始位置
+    template<typename T>
+    void check_search(std::mt19937& gen)
+    {
+        std::uniform_int_distribution<int> dist(0, 3);
+        for (size_t n = 0; n < 150; ++n)
+        {
+            vector<T> v1(n + 1), v2(n + 1);
+            for (size_t i = 0; i <= n; ++i)
+                v1[i] = v2[i] = static_cast<T>(dist(gen));
+            const T* first = v1.data() + 1;
+            const T* last = v1.data() + n + 1;
+            for (int x = 0; x < 4; ++x)
+            {
+                ASSERT_EQ(find(first, last, static_cast<T>(x)), std::find(first, last, static_cast<T>(x)));
+                ASSERT_EQ(count(first, last, static_cast<T>(x)), std::count(first, last, static_cast<T>(x)));
+            }
+            ASSERT_TRUE(equal(v1.begin(), v1.end(), v2.begin(), v2.end()));
+            if (n)
+            {
+                v2[n / 2 + 1] = static_cast<T>(5);
+                ASSERT_EQ(mismatch(v1.begin(), v1.end(), v2.begin()).first, v1.begin() + n / 2 + 1);
+                ASSERT_FALSE(equal(v1.begin(), v1.end(), v2.begin()));
+                ASSERT_EQ(lexicographical_compare(v1.begin(), v1.end(), v2.begin(), v2.end()),
+                    std::lexicographical_compare(v1.data(), v1.data() + n + 1, v2.data(), v2.data() + n + 1));
+            }
+        }
+    }
+
+    TEST(Test_simd_search, Test0)
+    {
+        std::mt19937 gen(1);
+        const simd::level detected = simd::detected_level();
+        for (int l = 0; l <= static_cast<int>(detected); ++l)
+        {
+            ASSERT_EQ(simd::set_active_level(static_cast<simd::level>(l)), static_cast<simd::level>(l));
+            check_search<uint8_t>(gen);
+            check_search<char>(gen);
+            check_search<short>(gen);
+            check_search<int>(gen);
+            check_search<unsigned long long>(gen);
+            check_search<float>(gen);
+            check_search<double>(gen);
+        }
+        simd::set_active_level(detected);
+
+        // 整数之间按==的语义比较
+        vector<uint8_t> v1{ 0, 255, 44 };
+        ASSERT_EQ(find(v1.begin(), v1.end(), 300), v1.end());
+        ASSERT_EQ(find(v1.begin(), v1.end(), 44ll), v1.begin() + 2);
+        ASSERT_EQ(count(v1.begin(), v1.end(), -1), 0);
+        vector<unsigned> v2{ 1, 0xFFFFFFFF };
+        ASSERT_EQ(find(v2.begin(), v2.end(), -1), v2.begin() + 1);
+
+        // 浮点数：+0.0等于-0.0，NaN不等于任何数
+        vector<double> v3{ 1.0, std::nan(""), -0.0, 2.0, 0.0 };
+        ASSERT_EQ(count(v3.begin(), v3.end(), 0.0), 2);
+        ASSERT_EQ(find(v3.begin(), v3.end(), std::nan("")), v3.end());
+        ASSERT_FALSE(equal(v3.begin(), v3.end(), v3.begin()));
+        ASSERT_FALSE(lexicographical_compare(v3.begin(), v3.end(), v3.begin(), v3.end()));
+
+        vector<bool*> v4{ nullptr };
+        ASSERT_EQ(find(v4.begin(), v4.end(), nullptr), v4.begin());
+        std::list<int> l1{ 1, 2, 3 };
+        ASSERT_EQ(*bitstl::find(l1.begin(), l1.end(), 2), 2);
+        ASSERT_EQ(bitstl::count(l1.begin(), l1.end(), 4), 0);
+    }
+
+    TEST(Test_simd_search, Test1)
+    {
+        // 查找位于末尾的元素，即扫描整个缓冲区
+        const size_t n = size_t(1) << 26;
+        const int reps = 10;
+        {
+            vector<int> v1(n, 0);
+            v1.back() = 1;
+            const int* first = v1.data();
+            const int* last = first + n;
+            LOG << "find int " << n << " x " << reps << std::endl;
+            {
+                BENCHMARK(for (int i = 0; i < reps; ++i) ASSERT_EQ(find(first, last, 1), last - 1); ,
+                    for (int i = 0; i < reps; ++i) ASSERT_EQ(std::find(first, last, 1), last - 1););
+            }
+            LOG << "count int " << n << " x " << reps << std::endl;
+            {
+                BENCHMARK(for (int i = 0; i < reps; ++i) ASSERT_EQ(count(first, last, 1), 1); ,
+                    for (int i = 0; i < reps; ++i) ASSERT_EQ(std::count(first, last, 1), 1););
+            }
+        }
+        {
+            vector<uint8_t> v1(n, 0);
+            v1.back() = 1;
+            const uint8_t* first = v1.data();
+            const uint8_t* last = first + n;
+            LOG << "find uint8_t " << n << " x " << reps << std::endl;
+            {
+                BENCHMARK(for (int i = 0; i < reps; ++i) ASSERT_EQ(find(first, last, 1), last - 1); ,
+                    for (int i = 0; i < reps; ++i) ASSERT_EQ(std::find(first, last, 1), last - 1););
+            }
+            LOG << "count uint8_t " << n << " x " << reps << std::endl;
+            {
+                BENCHMARK(for (int i = 0; i < reps; ++i) ASSERT_EQ(count(first, last, 1), 1); ,
+                    for (int i = 0; i < reps; ++i) ASSERT_EQ(std::count(first, last, 1), 1););
+            }
+            vector<uint8_t> v2(v1);
+            const uint8_t* first2 = v2.data();
+            LOG << "equal uint8_t " << n << " x " << reps << std::endl;
+            {
+                BENCHMARK(for (int i = 0; i < reps; ++i) ASSERT_TRUE(equal(first, last, first2)); ,
+                    for (int i = 0; i < reps; ++i) ASSERT_TRUE(std::equal(first, last, first2)););
+            }
+        }
+    }
+}
+
+namespace test_sort
+{
+    // 随机、有序、逆序、少量不同值、先增后减（organ pipe）
+    std::vector<int> make_input(const std::string& pattern, int n, std::mt19937& gen)
+    {
+        std::vector<int> v(n);
+        if (pattern == "random")
+            for (auto& x : v) x = static_cast<int>(gen());
+        else if (pattern == "sorted")
+            std::iota(v.begin(), v.end(), 0);
+        else if (pattern == "reversed")
+            std::iota(v.rbegin(), v.rend(), 0);
+        else if (pattern == "few_unique")
+            for (auto& x : v) x = static_cast<int>(gen() % 8);
+        else
+            for (int i = 0; i < n; ++i) v[i] = i < n / 2 ? i : n - i;
+        return v;
+    }
+
+    const char* patterns[] = { "random", "sorted", "reversed", "few_unique", "organ_pipe" };
+
+    TEST(Test_sort, Test0)
+    {
+        std::mt19937 gen(1);
+        for (const char* pattern : patterns)
+        {
+            for (int n : { 0, 1, 2, 46, 47, 100, 285, 286, 1000, 5000, 100000 })
+            {
+                std::vector<int> v1 = make_input(pattern, n, gen);
+                std::vector<int> v2 = v1;
+                bitstl::sort(v1.begin(), v1.end());
+                std::sort(v2.begin(), v2.end());
+                ASSERT_EQ(v1, v2) << pattern << " " << n;
+
+                v1 = make_input(pattern, n, gen);
+                v2 = v1;
+                bitstl::sort(v1.begin(), v1.end(), std::greater<>());
+                std::sort(v2.begin(), v2.end(), std::greater<>());
+                ASSERT_EQ(v1, v2) << pattern << " " << n;
+            }
+        }
+
+        // 递归深度耗尽时使用堆排序
+        std::vector<int> v3 = make_input("random", 10000, gen);
+        std::vector<int> v4 = v3;
+        std::less<> comp;
+        sort_detail::quick_sort(v3.begin(), v3.end(), 1, true, comp);
+        std::sort(v4.begin(), v4.end());
+        ASSERT_EQ(v3, v4);
+
+        // 只可移动的类型
+        std::vector<std::unique_ptr<int>> v5;
+        for (int i = 0; i < 1000; ++i)
+            v5.push_back(std::make_unique<int>(static_cast<int>(gen() % 100)));
+        auto deref_less = [](const auto& a, const auto& b) { return *a < *b; };
+        bitstl::sort(v5.begin(), v5.end(), deref_less);
+        ASSERT_TRUE(std::is_sorted(v5.data(), v5.data() + v5.size(), deref_less));
+    }
+
+    TEST(Test_sort, Test1)
+    {
+        // 按键排序，检查相等键的原有顺序
+        std::mt19937 gen(2);
+        auto key_less = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+        for (const char* pattern : patterns)
+        {
+            for (int n : { 0, 1, 31, 32, 33, 100, 1000, 100000 })
+            {
+                std::vector<int> keys = make_input(pattern, n, gen);
+                std::vector<std::pair<int, int>> v1(n);
+                for (int i = 0; i < n; ++i)
+                    v1[i] = { keys[i] % 50, i };
+                std::vector<std::pair<int, int>> v2 = v1;
+                bitstl::stable_sort(v1.begin(), v1.end(), key_less);
+                std::stable_sort(v2.begin(), v2.end(), key_less);
+                ASSERT_EQ(v1, v2) << pattern << " " << n;
+            }
+        }
+
+        std::vector<std::unique_ptr<int>> v3;
+        for (int i = 0; i < 1000; ++i)
+            v3.push_back(std::make_unique<int>(static_cast<int>(gen() % 10)));
+        auto deref_less = [](const auto& a, const auto& b) { return *a < *b; };
+        bitstl::stable_sort(v3.begin(), v3.end(), deref_less);
+        ASSERT_TRUE(std::is_sorted(v3.data(), v3.data() + v3.size(), deref_less));
+    }
+
+    TEST(Test_sort, Test2)
+    {
+        std::mt19937 gen(3);
+        const int n = int(1e7);
+        for (const char* pattern : patterns)
+        {
+            const std::vector<int> input = make_input(pattern, n, gen);
+            LOG << "sort " << pattern << " " << n << std::endl;
+            {
+                std::vector<int> v1 = input, v2 = input;
+                BENCHMARK(bitstl::sort(v1.begin(), v1.end()); ,
+                    std::sort(v2.begin(), v2.end()););
+                ASSERT_EQ(v1, v2);
+            }
+            LOG << "stable_sort " << pattern << " " << n << std::endl;
+            {
+                std::vector<int> v1 = input, v2 = input;
+                BENCHMARK(bitstl::stable_sort(v1.begin(), v1.end()); ,
+                    std::stable_sort(v2.begin(), v2.end()););
+                ASSERT_EQ(v1, v2);
+            }
+        }
+    }
+}
+
+namespace test_radix_sort
+{
+    template<typename T>
+    void check_radix_sort(const std::vector<T>& input)
+    {
+        vector<T> v1(input.size());
+        bitstl::copy(input.begin(), input.end(), v1.begin());
+        std::vector<T> v2 = input;
+        radix_sort(v1);
+        std::sort(v2.begin(), v2.end());
+        ASSERT_TRUE(std::equal(v2.begin(), v2.end(), v1.data()));
+    }
+
+    TEST(Test_radix_sort, Test0)
+    {
+        std::mt19937_64 gen(1);
+        for (int n : { 0, 1, 63, 64, 1000, 100000 })
+        {
+            std::vector<std::uint64_t> u(n);
+            for (auto& x : u) x = gen();
+            check_radix_sort(u);
+            std::vector<std::uint32_t> u32(n);
+            for (auto& x : u32) x = static_cast<std::uint32_t>(gen() % 1000);
+            check_radix_sort(u32);
+            std::vector<std::uint8_t> u8(n);
+            for (auto& x : u8) x = static_cast<std::uint8_t>(gen());
+            check_radix_sort(u8);
+            std::vector<int> i32(n);
+            for (auto& x : i32) x = static_cast<int>(gen());
+            check_radix_sort(i32);
+            std::vector<long long> i64(n);
+            for (auto& x : i64) x = static_cast<long long>(gen() % 2001) - 1000;
+            check_radix_sort(i64);
+            std::vector<short> i16(n);
+            for (auto& x : i16) x = static_cast<short>(gen());
+            check_radix_sort(i16);
+            std::vector<float> f(n);
+            for (auto& x : f) x = static_cast<float>(static_cast<long long>(gen() % 2001) - 1000) / 7.0f;
+            check_radix_sort(f);
+            std::vector<double> d(n);
+            for (auto& x : d) x = std::ldexp(static_cast<double>(static_cast<long long>(gen())), -40);
+            check_radix_sort(d);
+        }
+
+        // 浮点数的特殊值
+        vector<double> v1{ 1.0, -0.5, std::numeric_limits<double>::infinity(), 0.0,
+            -std::numeric_limits<double>::infinity(), -1e300, 1e-300, -2.0 };
+        radix_sort(v1.begin(), v1.end());
+        ASSERT_TRUE(std::is_sorted(v1.data(), v1.data() + v1.size()));
+        ASSERT_EQ(v1[0], -std::numeric_limits<double>::infinity());
+    }
+
+    struct record
+    {
+        std::int64_t timestamp;
+        int id;
+    };
+
+    TEST(Test_radix_sort, Test1)
+    {
+        // 以成员指针或函数作为键提取函数，相等键保持原有顺序
+        std::mt19937 gen(2);
+        std::vector<record> input(10000);
+        for (int i = 0; i < 10000; ++i)
+            input[i] = { static_cast<std::int64_t>(gen() % 100) - 50, i };
+
+        vector<record> v1(input.size());
+            bitstl::copy(input.begin(), input.end(), v1.begin());
+        radix_sort(v1, &record::timestamp);
+        std::vector<record> v2 = input;
+        std::stable_sort(v2.begin(), v2.end(), [](const record& a, const record& b) { return a.timestamp < b.timestamp; });
+        for (size_t i = 0; i < v2.size(); ++i)
+        {
+            ASSERT_EQ(v1[i].timestamp, v2[i].timestamp);
+            ASSERT_EQ(v1[i].id, v2[i].id);
+        }
+
+        // 不可平凡复制的元素
+        std::vector<std::unique_ptr<int>> v3;
+        for (int i = 0; i < 1000; ++i)
+            v3.push_back(std::make_unique<int>(static_cast<int>(gen() % 100)));
+        radix_sort(v3.begin(), v3.end(), [](const std::unique_ptr<int>& p) { return *p; });
+        ASSERT_TRUE(std::is_sorted(v3.begin(), v3.end(), [](const auto& a, const auto& b) { return *a < *b; }));
+
+        // 暂存区由容器的分配器分配
+        tracking_stats stats;
+        tracking_allocator<allocator<std::uint32_t>> alloc(stats);
+        vector<std::uint32_t, tracking_allocator<allocator<std::uint32_t>>> v4(alloc);
+        for (int i = 0; i < 1000; ++i)
+            v4.push_back(gen());
+        const size_t before = stats.snapshot().allocations;
+        radix_sort(v4);
+        ASSERT_EQ(stats.snapshot().allocations, before + 1);
+        ASSERT_TRUE(std::is_sorted(v4.data(), v4.data() + v4.size()));
+    }
+
+    TEST(Test_radix_sort, Test2)
+    {
+        std::mt19937_64 gen(3);
+        const int n = int(1e7);
+        {
+            // 32位ID
+            std::vector<std::uint32_t> input(n);
+            for (auto& x : input) x = static_cast<std::uint32_t>(gen());
+            vector<std::uint32_t> v1(input.size());
+            bitstl::copy(input.begin(), input.end(), v1.begin());
+            std::vector<std::uint32_t> v2 = input;
+            LOG << "radix_sort uint32_t " << n << std::endl;
+            BENCHMARK(radix_sort(v1); , std::sort(v2.begin(), v2.end()););
+            ASSERT_TRUE(std::equal(v2.begin(), v2.end(), v1.data()));
+        }
+        {
+            // 集中在一天之内的纳秒时间戳，高位字节相同而被跳过
+            std::vector<std::int64_t> input(n);
+            const std::int64_t base = 1700000000ll * 1000000000ll;
+            for (auto& x : input) x = base + static_cast<std::int64_t>(gen() % (86400ull * 1000000000ull));
+            vector<std::int64_t> v1(input.size());
+            bitstl::copy(input.begin(), input.end(), v1.begin());
+            std::vector<std::int64_t> v2 = input;
+            LOG << "radix_sort timestamp " << n << std::endl;
+            BENCHMARK(radix_sort(v1); , std::sort(v2.begin(), v2.end()););
+            ASSERT_TRUE(std::equal(v2.begin(), v2.end(), v1.data()));
+        }
+        {
+            std::vector<double> input(n);
+            for (auto& x : input) x = std::ldexp(static_cast<double>(static_cast<long long>(gen())), -40);
+            vector<double> v1(input.size());
+            bitstl::copy(input.begin(), input.end(), v1.begin());
+            std::vector<double> v2 = input;
+            LOG << "radix_sort double " << n << std::endl;
+            BENCHMARK(radix_sort(v1); , std::sort(v2.begin(), v2.end()););
+            ASSERT_TRUE(std::equal(v2.begin(), v2.end(), v1.data()));
+        }
+    }
+}
+
+namespace test_trivially_relocatable
+{
+    // 持有堆内存的句柄，移动构造和析构都不平凡
+    template<bool Relocatable>
+    struct handle
+    {
+        inline static int alive = 0;
+        int* p;
+
+        handle(int x) : p(new int(x)) { ++alive; }
+        handle(const handle& other) : p(new int(*other.p)) { ++alive; }
+        handle(handle&& other) noexcept : p(other.p) { other.p = nullptr; ++alive; }
+        handle& operator=(handle other) noexcept { std::swap(p, other.p); return *this; }
+        ~handle() { delete p; --alive; }
+    };
+}
+
+// 用户类型特化声明可平凡重定位
+template<>
+struct bitstl::is_trivially_relocatable<test_trivially_relocatable::handle<true>> : bitstl::true_type {};
+
+namespace test_trivially_relocatable
+{
+    TEST(Test_trivially_relocatable, Test0)
+    {
+        ASSERT_TRUE(is_trivially_relocatable_v<int>);
+        ASSERT_TRUE(is_trivially_relocatable_v<std::unique_ptr<int>>);
+        ASSERT_TRUE(is_trivially_relocatable_v<vector<std::string>>);
+        ASSERT_TRUE(is_trivially_relocatable_v<handle<true>>);
+        ASSERT_FALSE(is_trivially_relocatable_v<handle<false>>);
+    }
+
+    template<typename T>
+    void check_modifiers()
+    {
+        {
+            vector<T> v1;
+            for (int i = 0; i < 100; ++i)
+                v1.push_back(T(i));
+            v1.insert(v1.begin(), T(-1));
+            v1.insert(v1.begin() + 50, 3, T(-2));
+            v1.emplace(v1.end() - 1, -3);
+            ASSERT_EQ(*v1[0].p, -1);
+            ASSERT_EQ(*v1[49].p, 48);
+            ASSERT_EQ(*v1[50].p, -2);
+            ASSERT_EQ(*v1[53].p, 49);
+            ASSERT_EQ(*v1[103].p, -3);
+            ASSERT_EQ(*v1[104].p, 99);
+
+            // 插入容器自身的元素
+            v1.insert(v1.begin(), v1[1]);
+            ASSERT_EQ(*v1[0].p, 0);
+
+            v1.erase(v1.begin() + 50, v1.begin() + 54);
+            v1.erase(v1.begin());
+            ASSERT_EQ(*v1[0].p, -1);
+            ASSERT_EQ(*v1[48].p, 47);
+            ASSERT_EQ(*v1[49].p, 49);
+            ASSERT_EQ(v1.size(), 101);
+            v1.shrink_to_fit();
+            ASSERT_EQ(*v1[100].p, 99);
+            ASSERT_EQ(T::alive, 101);
+        }
+        ASSERT_EQ(T::alive, 0);
+    }
+
+    TEST(Test_trivially_relocatable, Test1)
+    {
+        check_modifiers<handle<true>>();
+        check_modifiers<handle<false>>();
+    }
+
+    TEST(Test_trivially_relocatable, Test2)
+    {
+        // 扩容与头部插入删除
+        auto churn = [](auto tag)
+            {
+                using T = decltype(tag);
+                vector<T> v;
+                for (int i = 0; i < int(1e6); ++i)
+                    v.emplace_back(i);
+                for (int i = 0; i < 200; ++i)
+                {
+                    v.insert(v.begin(), T(i));
+                    v.erase(v.begin() + 1);
+                }
+                return *v[0].p;
+            };
+
+        int r1 = 0, r2 = 0;
+        BENCHMARK(r1 = churn(handle<true>(0)); ,
+            r2 = churn(handle<false>(0)););
+        ASSERT_EQ(r1, r2);
+    }
+}
+
+namespace test_pool_allocator
+{
+    struct alignas(16) Big
+    {
+        double d[2];
+    };
+
+    TEST(Test_pool_allocator, Test0)
+    {
+        ASSERT_TRUE((is_same_v<
+            pool_allocator<double>,
+            allocator_traits<pool_allocator<int>>::rebind_alloc<double>>));
+
+        pool_allocator<int> alloc;
+        int* p1 = alloc.allocate(3);
+        int* p2 = alloc.allocate(3);
+        ASSERT_NE(p1, p2);
+        alloc.deallocate(p1, 3);
+        // 同一自由链表，后释放的区块先被分配
+        int* p3 = alloc.allocate(4);
+        ASSERT_EQ(p1, p3);
+        alloc.deallocate(p2, 3);
+        alloc.deallocate(p3, 4);
+
+        pool_allocator<Big> big_alloc;
+        Big* p4 = big_alloc.allocate(1);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p4) % alignof(Big), 0);
+        big_alloc.deallocate(p4, 1);
+    }
+
+    TEST(Test_pool_allocator, Test1)
+    {
+        vector<int, pool_allocator<int>> v1{ 1, 2, 3 };
+        for (int i = 4; i <= 100; ++i)
+            v1.push_back(i);
+        ASSERT_EQ(v1.size(), 100);
+        ASSERT_EQ(v1[99], 100);
+        ASSERT_EQ(pool_allocator<int>(), v1.get_allocator());
+
+        vector<test_vector::Foo, pool_allocator<test_vector::Foo>> v2(20, test_vector::Foo(1));
+        v2.shrink_to_fit();
+        ASSERT_EQ(v2[19].x, 2);
+    }
+
+    TEST(Test_pool_allocator, Test2)
+    {
+        // 区块在一个线程分配，在另一个线程释放
+        std::vector<int*> blocks;
+        pool_allocator<int> alloc;
+        std::thread t1([&]
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    blocks.push_back(alloc.allocate(i % 32 + 1));
+                    *blocks.back() = i;
+                }
+            });
+        t1.join();
+
+        std::thread t2([&]
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    ASSERT_EQ(*blocks[i], i);
+                    alloc.deallocate(blocks[i], i % 32 + 1);
+                }
+            });
+        t2.join();
+
+        int* p = alloc.allocate(1);
+        alloc.deallocate(p, 1);
+    }
+
+    TEST(Test_pool_allocator, Test3)
+    {
+        // 大量小vector的反复构造与析构
+        auto churn = [](auto alloc)
+            {
+                using Alloc = decltype(alloc);
+                long long sum = 0;
+                for (int i = 0; i < int(1e6); ++i)
+                {
+                    vector<int, Alloc> v({ i, i + 1, i + 2 }, alloc);
+                    v.push_back(i);
+                    sum += v[3];
+                }
+                return sum;
+            };
+
+        long long sum1 = 0, sum2 = 0;
+        BENCHMARK(sum1 = churn(pool_allocator<int>()); ,
+            sum2 = churn(allocator<int>()););
+        ASSERT_EQ(sum1, sum2);
+    }
+}
+
+namespace test_allocate_at_least
+{
+    // 单块缓冲区上的线性分配器，按16个对象上调分配量，末尾的区块可以原地扩展
+    struct bump_arena
+    {
+        alignas(16) inline static char buffer[1 << 16];
+        inline static size_t used = 0;
+        inline static int allocations = 0;
+    };
+
+    template<typename T>
+    class bump_allocator
+    {
+    public:
+        using value_type = T;
+
+        bump_allocator() noexcept {}
+
+        template<typename U>
+        bump_allocator(const bump_allocator<U>&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            T* p = reinterpret_cast<T*>(bump_arena::buffer + bump_arena::used);
+            bump_arena::used += n * sizeof(T);
+            ++bump_arena::allocations;
+            return p;
+        }
+
+        allocation_result<T*> allocate_at_least(size_t n)
+        {
+            n = (n + 15) / 16 * 16;
+            return { allocate(n), n };
+        }
+
+        bool try_expand(T* p, size_t old_n, size_t new_n)
+        {
+            if (reinterpret_cast<char*>(p + old_n) != bump_arena::buffer + bump_arena::used)
+                return false;
+            bump_arena::used += (new_n - old_n) * sizeof(T);
+            return true;
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (reinterpret_cast<char*>(p + n) == bump_arena::buffer + bump_arena::used)
+                bump_arena::used -= n * sizeof(T);
+        }
+
+        template<typename U>
+        friend bool operator==(const bump_allocator&, const bump_allocator<U>&) noexcept { return true; }
+    };
+
+    TEST(Test_allocate_at_least, Test0)
+    {
+        ASSERT_TRUE(has_allocate_at_least<bump_allocator<int>>::value);
+        ASSERT_TRUE(has_try_expand<bump_allocator<int>>::value);
+        ASSERT_FALSE(has_allocate_at_least<allocator<int>>::value);
+        ASSERT_FALSE(has_try_expand<allocator<int>>::value);
+
+        allocator<int> alloc;
+        auto result = allocator_traits<allocator<int>>::allocate_at_least(alloc, 5);
+        ASSERT_EQ(result.count, 5);
+        ASSERT_FALSE(allocator_traits<allocator<int>>::try_expand(alloc, result.ptr, 5, 10));
+        alloc.deallocate(result.ptr, result.count);
+
+        // 小额区块上调至8的倍数
+        vector<char, pool_allocator<char>> v1;
+        v1.reserve(3);
+        ASSERT_EQ(v1.capacity(), 8);
+    }
+
+    TEST(Test_allocate_at_least, Test1)
+    {
+        bump_arena::used = 0;
+        bump_arena::allocations = 0;
+        {
+            vector<int, bump_allocator<int>> v1;
+            for (int i = 0; i < 1000; ++i)
+                v1.push_back(i);
+            // 首次分配得到16个对象，之后的增长均原地扩展
+            ASSERT_EQ(bump_arena::allocations, 1);
+            ASSERT_EQ(v1.capacity(), 1024);
+            for (int i = 0; i < 1000; ++i)
+                ASSERT_EQ(v1[i], i);
+
+            // 末尾已有其它区块，无法原地扩展
+            vector<int, bump_allocator<int>> v2(v1.begin(), v1.begin() + 10);
+            v1.reserve(2000);
+            ASSERT_EQ(bump_arena::allocations, 3);
+            ASSERT_EQ(v1.capacity(), 2000);
+            ASSERT_EQ(v1[999], 999);
+        }
+
+        // 映射长度上调为大页的倍数
+        const size_t huge = huge_page_alloc::huge_page_size();
+        vector<char, huge_page_allocator<char>> v3((huge_page_allocator<char>(1)));
+        v3.reserve(huge + 1);
+        ASSERT_EQ(v3.capacity(), huge * 2);
+        v3.resize(huge + 1, 'a');
+        v3.reserve(huge * 8);
+        ASSERT_GE(v3.capacity(), huge * 8);
+        ASSERT_EQ(v3[huge], 'a');
+    }
+
+    TEST(Test_allocate_at_least, Test2)
+    {
+        // 大量push_back，映射的内存可以原地扩展，省去搬移
+        auto push = [](auto alloc)
+            {
+                using Alloc = decltype(alloc);
+                vector<int, Alloc> v(alloc);
+                for (int i = 0; i < int(3e7); ++i)
+                    v.push_back(i);
+                return v[v.size() - 1];
+            };
+
+        int last1 = 0, last2 = 0;
+        BENCHMARK(last1 = push(huge_page_allocator<int>()); ,
+            last2 = push(allocator<int>()););
+        ASSERT_EQ(last1, last2);
+    }
+}
+
+namespace test_huge_page_allocator
+{
+    TEST(Test_huge_page_allocator, Test0)
+    {
+        ASSERT_TRUE((is_same_v<
+            huge_page_allocator<double>,
+            allocator_traits<huge_page_allocator<int>>::rebind_alloc<double>>));
+
+        const size_t huge = huge_page_alloc::huge_page_size();
+        huge_page_allocator<char> alloc;
+        ASSERT_EQ(alloc.threshold(), huge);
+        ASSERT_EQ(huge_page_allocator<int>(alloc), alloc);
+        ASSERT_NE(huge_page_allocator<char>(1 << 10), alloc);
+
+        // 大块内存按大页对齐，可读写
+        char* p1 = alloc.allocate(huge + 1);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p1) % huge, 0);
+        p1[0] = 1;
+        p1[huge] = 2;
+        ASSERT_EQ(p1[0] + p1[huge], 3);
+        alloc.deallocate(p1, huge + 1);
+
+        // 小于阈值的请求退回allocator
+        char* p2 = alloc.allocate(16);
+        p2[15] = 1;
+        alloc.deallocate(p2, 16);
+    }
+
+    TEST(Test_huge_page_allocator, Test1)
+    {
+        // 容量跨越阈值的vector，通过allocator_traits透明地切换分配方式
+        huge_page_allocator<int> alloc(1 << 16);
+        vector<int, huge_page_allocator<int>> v1(alloc);
+        for (int i = 0; i < int(1e6); ++i)
+            v1.push_back(i);
+        ASSERT_EQ(v1[999999], 999999);
+        ASSERT_EQ(v1.get_allocator(), alloc);
+
+        vector<int, huge_page_allocator<int>> v2(v1);
+        ASSERT_EQ(v2.size(), v1.size());
+        v2.shrink_to_fit();
+        ASSERT_EQ(v2[123456], 123456);
+
+        // 阈值随分配器传播
+        vector<int, huge_page_allocator<int>> v3;
+        v3 = v1;
+        ASSERT_EQ(v3.get_allocator().threshold(), 1 << 16);
+        ASSERT_EQ(v3[500000], 500000);
+    }
+
+    TEST(Test_huge_page_allocator, Test2)
+    {
+        // 大数组的首次写入与随机访问，大页减少缺页中断和TLB缺失
+        const size_t n = size_t(1) << 25;
+        auto touch = [n](auto alloc)
+            {
+                using Alloc = decltype(alloc);
+                vector<double, Alloc> v(n, 1.0, alloc);
+                double sum = 0;
+                size_t idx = 0;
+                for (size_t i = 0; i < n / 8; ++i)
+                {
+                    idx = (idx * 1103515245 + 12345) & (n - 1);
+                    sum += v[idx];
+                }
+                return sum;
+            };
+
+        double sum1 = 0, sum2 = 0;
+        BENCHMARK(sum1 = touch(huge_page_allocator<double>()); ,
+            sum2 = touch(allocator<double>()););
+        ASSERT_EQ(sum1, sum2);
+    }
+}
+
+namespace test_tracking_allocator
+{
+    TEST(Test_tracking_allocator, Test0)
+    {
+        using tracked = tracking_allocator<allocator<int>>;
+        ASSERT_TRUE((is_same_v<
+            tracking_allocator<allocator<double>>,
+            allocator_traits<tracked>::rebind_alloc<double>>));
+        ASSERT_TRUE((is_same_v<
+            tracking_allocator<pool_allocator<double>>,
+            allocator_traits<tracking_allocator<pool_allocator<int>>>::rebind_alloc<double>>));
+
+        tracking_stats stats;
+        {
+            tracked alloc(stats);
+            vector<int, tracked> v1(alloc);
+            v1.reserve(100);
+            ASSERT_EQ(stats.allocations(), 1);
+            ASSERT_EQ(stats.live_bytes(), 100 * sizeof(int));
+            v1.reserve(1000);
+            ASSERT_EQ(stats.allocations(), 2);
+            ASSERT_EQ(stats.live_bytes(), 1000 * sizeof(int));
+
+            // 拷贝的vector共享统计对象
+            v1.resize(10);
+            vector<int, tracked> v2(v1);
+            ASSERT_EQ(&v2.get_allocator().stats(), &stats);
+            ASSERT_EQ(stats.live_bytes(), 1010 * sizeof(int));
+        }
+        tracking_snapshot snap = stats.snapshot();
+        ASSERT_EQ(snap.allocations, 3);
+        ASSERT_EQ(snap.deallocations, 3);
+        ASSERT_EQ(snap.live_bytes, 0);
+        ASSERT_EQ(snap.peak_bytes, 1100 * sizeof(int));
+        // 400bytes、4000bytes、40bytes分别属于512、4096、64级
+        ASSERT_EQ(snap.size_classes[9], 1);
+        ASSERT_EQ(snap.size_classes[12], 1);
+        ASSERT_EQ(snap.size_classes[6], 1);
+        ASSERT_EQ(stats.to_json(),
+            "{\"allocations\":3,\"deallocations\":3,\"live_bytes\":0,\"peak_bytes\":4400,"
+            "\"size_classes\":[{\"max_bytes\":64,\"count\":1},{\"max_bytes\":512,\"count\":1},{\"max_bytes\":4096,\"count\":1}]}");
+    }
+
+    TEST(Test_tracking_allocator, Test1)
+    {
+        // 节点容器经rebind分配节点，多线程分配与释放
+        tracking_stats stats;
+        {
+            using tracked = tracking_allocator<allocator<int>>;
+            queue_ts<int, tracked> que(tracked{ stats });
+            std::vector<std::thread> vt(4);
+            for (auto& t : vt)
+            {
+                t = std::thread([&]
+                    {
+                        for (int i = 0; i < 1000; ++i)
+                            que.push(i);
+                        for (int i = 0; i < 500; ++i)
+                            que.wait_and_pop();
+                    });
+            }
+            for (auto& t : vt)
+                t.join();
+            ASSERT_GT(stats.live_bytes(), 0);
+            LOG << stats.to_json() << std::endl;
+        }
+        tracking_snapshot snap = stats.snapshot();
+        ASSERT_EQ(snap.allocations, snap.deallocations);
+        ASSERT_EQ(snap.live_bytes, 0);
+        ASSERT_GT(snap.peak_bytes, 0);
+    }
+
+    TEST(Test_tracking_allocator, Test2)
+    {
+        // 统计的开销
+        auto churn = [](auto alloc)
+            {
+                using Alloc = decltype(alloc);
+                long long sum = 0;
+                for (int i = 0; i < int(1e6); ++i)
+                {
+                    vector<int, Alloc> v({ i, i + 1, i + 2 }, alloc);
+                    v.push_back(i);
+                    sum += v[3];
+                }
+                return sum;
+            };
+
+        tracking_stats stats;
+        long long sum1 = 0, sum2 = 0;
+        BENCHMARK(sum1 = churn(tracking_allocator<allocator<int>>(stats)); ,
+            sum2 = churn(allocator<int>()););
+        ASSERT_EQ(sum1, sum2);
+        ASSERT_EQ(stats.live_bytes(), 0);
+    }
+}
+
+namespace test_memory_resource
+{
+    using pmr_vector = vector<int, polymorphic_allocator<int>>;
+
+    // 统计分配次数与字节数的上游资源
+    class counting_resource : public memory_resource
+    {
+    public:
+        int count = 0;
+        bitstl::size_t bytes = 0;
+
+    private:
+        void* do_allocate(bitstl::size_t n, bitstl::size_t alignment) override
+        {
+            ++count;
+            bytes += n;
+            return new_delete_resource()->allocate(n, alignment);
+        }
+
+        void do_deallocate(void* p, bitstl::size_t n, bitstl::size_t alignment) override
+        {
+            --count;
+            bytes -= n;
+            new_delete_resource()->deallocate(p, n, alignment);
+        }
+
+        bool do_is_equal(const memory_resource& other)
+            const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    TEST(Test_monotonic_buffer_resource, Test0)
+    {
+        char buffer[256];
+        counting_resource upstream;
+        {
+            monotonic_buffer_resource arena(buffer, sizeof(buffer), &upstream);
+            void* p1 = arena.allocate(16, 8);
+            void* p2 = arena.allocate(32, 16);
+            ASSERT_EQ(p1, buffer);
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p2) % 16, 0);
+            ASSERT_EQ(upstream.count, 0);
+
+            // 缓冲区用尽后向上游申请
+            ASSERT_NE(arena.allocate(512), nullptr);
+            ASSERT_EQ(upstream.count, 1);
+            ASSERT_NE(arena.allocate(1024), nullptr);
+            ASSERT_EQ(upstream.count, 2);
+
+            arena.release();
+            ASSERT_EQ(upstream.count, 0);
+            ASSERT_EQ(arena.allocate(16, 8), buffer);
+            ASSERT_NE(arena.allocate(4096), nullptr);
+        }
+        ASSERT_EQ(upstream.count, 0);
+    }
+
+    TEST(Test_unsynchronized_pool_resource, Test0)
+    {
+        counting_resource upstream;
+        {
+            pool_options opts;
+            opts.largest_required_pool_block = 256;
+            unsynchronized_pool_resource pool(opts, &upstream);
+            ASSERT_EQ(pool.options().largest_required_pool_block, 256);
+
+            void* p1 = pool.allocate(24, 8);
+            pool.deallocate(p1, 24, 8);
+            // 同一池的区块被复用
+            void* p2 = pool.allocate(20, 4);
+            ASSERT_EQ(p1, p2);
+
+            void* p3 = pool.allocate(64, 64);
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p3) % 64, 0);
+
+            // 超过largest_required_pool_block的分配直接交由上游
+            int before = upstream.count;
+            void* p4 = pool.allocate(1000, 32);
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p4) % 32, 0);
+            ASSERT_EQ(upstream.count, before + 1);
+            pool.deallocate(p4, 1000, 32);
+            ASSERT_EQ(upstream.count, before);
+            ASSERT_NE(pool.allocate(2000), nullptr);
+        }
+        ASSERT_EQ(upstream.count, 0);
+        ASSERT_EQ(upstream.bytes, 0);
+    }
+
+    TEST(Test_synchronized_pool_resource, Test0)
+    {
+        synchronized_pool_resource pool;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&pool, t]
+                {
+                    pmr_vector v(&pool);
+                    for (int i = 0; i < 1000; ++i)
+                        v.push_back(i * t);
+                    ASSERT_EQ(v[999], 999 * t);
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    TEST(Test_polymorphic_allocator, Test0)
+    {
+        using traits = allocator_traits<polymorphic_allocator<int>>;
+        ASSERT_TRUE((is_same_v<polymorphic_allocator<double>, traits::rebind_alloc<double>>));
+        ASSERT_FALSE(traits::is_always_equal::value);
+        ASSERT_FALSE(traits::propagate_on_container_move_assignment::value);
+        ASSERT_TRUE(allocator_traits<allocator<int>>::is_always_equal::value);
+
+        monotonic_buffer_resource arena;
+        pmr_vector v1({ 1, 2, 3 }, &arena);
+        ASSERT_EQ(v1.get_allocator().resource(), &arena);
+
+        // 拷贝构造使用默认资源
+        pmr_vector v2(v1);
+        ASSERT_EQ(v2.get_allocator().resource(), get_default_resource());
+        ASSERT_EQ(v2[2], 3);
+
+        // 移动构造接管内存和分配器
+        pmr_vector v3(move(v1));
+        ASSERT_EQ(v3.get_allocator().resource(), &arena);
+        ASSERT_EQ(v3[2], 3);
+    }
+
+    TEST(Test_polymorphic_allocator, Test1)
+    {
+        counting_resource res1, res2;
+        {
+            pmr_vector v1({ 1, 2, 3 }, &res1);
+            pmr_vector v2({ 4, 5 }, &res2);
+
+            // 分配器不传播，v1仍使用res1
+            v1 = move(v2);
+            ASSERT_EQ(v1.get_allocator().resource(), &res1);
+            ASSERT_EQ(v1.size(), 2);
+            ASSERT_EQ(v1[1], 5);
+
+            pmr_vector v3({ 6, 7, 8, 9 }, &res2);
+            v1 = v3;
+            ASSERT_EQ(v1.get_allocator().resource(), &res1);
+            ASSERT_EQ(v1[3], 9);
+
+            v1.assign({ 1, 2, 3, 4, 5, 6 });
+            v1.push_back(7);
+            ASSERT_EQ(v1[6], 7);
+        }
+        ASSERT_EQ(res1.count, 0);
+        ASSERT_EQ(res2.count, 0);
+        ASSERT_EQ(res1.bytes, 0);
+    }
+
+    TEST(Test_polymorphic_allocator, Test2)
+    {
+        // 每次请求使用一个arena，请求结束时一次性释放
+        auto serve = [](memory_resource* res)
+            {
+                long long sum = 0;
+                for (int i = 0; i < 100; ++i)
+                {
+                    pmr_vector v(res);
+                    for (int j = 0; j < 8; ++j)
+                        v.push_back(i + j);
+                    sum += v[7];
+                }
+                return sum;
+            };
+
+        const int round = int(1e4);
+        long long sum1 = 0, sum2 = 0;
+        BENCHMARK(
+            for (int i = 0; i < round; ++i)
+            {
+                monotonic_buffer_resource arena;
+                sum1 += serve(&arena);
+            },
+            for (int i = 0; i < round; ++i)
+                sum2 += serve(new_delete_resource()););
+        ASSERT_EQ(sum1, sum2);
+    }
+}
+
+namespace test_delegate
+{
+    class Foo
+    {      
+    public:
+        int x = 0;
+
+        Foo() {}
+        ~Foo() {}
+
+        int add(int a, int b)
+        {
+            return a + b;
+        }
+
+        void store_add(int a, int b)
+        {
+            x = a + b;
+        }
+    };
+    
+    int add(int a, int b)
+    {
+        return a + b;
+    }
+
+    TEST(Test_delegate_twoparam, Test0)
+    {
+        Foo test;
+        auto delegate1 = 
+            delegate_twoparam<int, int, int>
+            ::from_class_func<Foo, &Foo::add>(&test);
+        ASSERT_EQ(delegate1(1, 3), 4);
+        ASSERT_EQ(delegate1.execute(2, 2), 4);
+        ASSERT_TRUE(delegate1.isbound());
+        delegate1.unbind();
+        ASSERT_FALSE(delegate1.isbound());
+        delegate1.bind_func<&add>();
+        ASSERT_EQ(delegate1(1, 7), 8);
+
+        auto delegate2 =
+            delegate_twoparam<int, int, int>
+            ::from_func<&add>();
+        ASSERT_EQ(delegate2(2, 4), 6);
+        ASSERT_EQ(delegate2.execute(2, 4), 6);
+        ASSERT_TRUE(delegate2.isbound());
+        delegate2.unbind();
+        ASSERT_FALSE(delegate2.isbound());
+        delegate2.bind_class_func<Foo, &Foo::add>(&test);
+        ASSERT_EQ(delegate2(1, 5), 6);
+        ASSERT_FALSE(delegate2.execute_ifbound(2, 3));
+
+        auto delegate3 =
+            delegate_twoparam<void, int, int>
+            ::from_class_func<Foo, &Foo::store_add>(&test);
+        ASSERT_TRUE(delegate3.execute_ifbound(2, 3));
+        ASSERT_TRUE(test.x, 5);        
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
 }
\ No newline at end of file
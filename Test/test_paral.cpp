@@ -1,69 +1,1549 @@
-#include "pch.h"
-#include "common.h"
-
-namespace test_parallel
-{
-    TEST(Tes_for_each_paral, Test0)
-    {
-        std::vector<double> v1(int(1e6), 5);
-        std::vector<double> v2(int(1e6), 5);
-
-        auto op = [](double& x) {x = std::sqrt(x); };
-        BENCHMARK(for_each_paral(v1.begin(), v1.end(), op); ,
-            std::for_each(v2.begin(), v2.end(), op););
-
-        std::cout << v1[2] << std::endl;
-        std::cout << v2[2] << std::endl;
-        ASSERT_EQ(v1, v2);
-
-    }
-
-    TEST(Test_quick_sort_paral, Test0)
-    {
-        std::vector<int> v(int(1e4), 0);
-        std::iota(v.begin(), v.end(), 1);
-        auto rd = std::random_device{};
-        auto rng = std::default_random_engine{ rd() };
-        std::shuffle(v.begin(), v.end(), rng);
-
-        std::list<int> test_list;
-        test_list.assign(v.begin(), v.end());
-
-        auto comp = std::greater<int>();
-
-        BENCHMARK(auto res = quick_sort_paral(test_list, comp); ,
-            test_list.sort(comp););
-
-        ASSERT_TRUE(std::is_sorted(res.begin(), res.end(), comp));
-    }
-
-    TEST(Test_accumulate_paral, Test0)
-    {
-        std::vector<double> test_vec(int(1e6), 2.2);
-
-        double res1 = 0, res2 = 0;
-        BENCHMARK(res1 = accumulate_paral(test_vec.begin(), test_vec.end(), 0.); ,
-            res2 = std::accumulate(test_vec.begin(), test_vec.end(), 0.););
-
-        ASSERT_NEAR(res1, res2, 1e-3);
-    }
-
-    TEST(Test_find_paral, Test0)
-    {
-        std::vector<int> v(int(1e6), 0);
-        v[200] = 1;
-        BENCHMARK(auto found1 = find_paral(v.begin(), v.end(), 1); ,
-            auto found2 = std::find(v.begin(), v.end(), 1););
-        ASSERT_EQ(found1, found2);
-    }
-
-    TEST(TEST_partial_sum_paral, Test0)
-    {
-        std::vector<int> v1(200, 1);
-        std::vector<int> v2 = v1;
-        BENCHMARK(partial_sum_paral(v1.begin(), v1.end()); ,
-            std::partial_sum(v2.begin(), v2.end(), v2.begin()););
-        ASSERT_EQ(v1, v2);
-    }
-}
-
+#include "pch.h"
+#include "common.h"
+
+namespace test_parallel
+{
+    // 进程的CPU时间（所有线程的用户态与内核态时间之和），单位ms
+    static double process_cpu_ms()
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+        auto to_ms = [](const FILETIME& t) { return (double(t.dwHighDateTime) * 4294967296.0 + t.dwLowDateTime) / 1e4; };
+        return to_ms(kernel) + to_ms(user);
+#else
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#endif
+    }
+
+    TEST(Tes_for_each_paral, Test0)
+    {
+        std::vector<double> v1(int(1e6), 5);
+        std::vector<double> v2(int(1e6), 5);
+
+        auto op = [](double& x) {x = std::sqrt(x); };
+        BENCHMARK(for_each_paral(v1.begin(), v1.end(), op); ,
+            std::for_each(v2.begin(), v2.end(), op););
+
+        std::cout << v1[2] << std::endl;
+        std::cout << v2[2] << std::endl;
+        ASSERT_EQ(v1, v2);
+
+    }
+
+    TEST(Test_quick_sort_paral, Test0)
+    {
+        std::vector<int> v(int(1e4), 0);
+        std::iota(v.begin(), v.end(), 1);
+        auto rd = std::random_device{};
+        auto rng = std::default_random_engine{ rd() };
+        std::shuffle(v.begin(), v.end(), rng);
+
+        std::list<int> test_list;
+        test_list.assign(v.begin(), v.end());
+
+        auto comp = std::greater<int>();
+
+        BENCHMARK(auto res = quick_sort_paral(test_list, comp); ,
+            test_list.sort(comp););
+
+        ASSERT_TRUE(std::is_sorted(res.begin(), res.end(), comp));
+    }
+
+    TEST(Test_quick_sort_paral, Test1)
+    {
+        std::mt19937 gen(11);
+        std::list<int> test_list;
+        for (int i = 0; i < 100000; ++i)
+            test_list.push_back(static_cast<int>(gen()));
+
+        auto res = quick_sort_paral(test_list, std::less<int>());
+        ASSERT_TRUE(std::is_sorted(res.begin(), res.end()));
+
+        // 排序结束后工作线程自旋片刻即阻塞，超时后退出，空闲期间几乎不占用CPU
+        const int idle_ms = 1000;
+        const double cpu_before = process_cpu_ms();
+        std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+        const double idle_cpu = process_cpu_ms() - cpu_before;
+        LOG << "CPU time while idle for " << idle_ms << "ms: " << idle_cpu << "ms" << std::endl;
+        ASSERT_LT(idle_cpu, 50.0);
+
+        // 工作线程退出后再次调用时重新创建
+        const double sort_before = process_cpu_ms();
+        res = quick_sort_paral(test_list, std::less<int>());
+        LOG << "CPU time of a sort: " << process_cpu_ms() - sort_before << "ms" << std::endl;
+        ASSERT_TRUE(std::is_sorted(res.begin(), res.end()));
+    }
+
+    TEST(Test_accumulate_paral, Test0)
+    {
+        std::vector<double> test_vec(int(1e6), 2.2);
+
+        double res1 = 0, res2 = 0;
+        BENCHMARK(res1 = accumulate_paral(test_vec.begin(), test_vec.end(), 0.); ,
+            res2 = std::accumulate(test_vec.begin(), test_vec.end(), 0.););
+
+        ASSERT_NEAR(res1, res2, 1e-3);
+    }
+
+    TEST(Test_reduce_paral, Test0)
+    {
+        std::mt19937_64 gen(14);
+        thread_pool pool1(1), pool3(3), pool7(7);
+        for (int n : { 0, 1, 7, 4096, 4097, 100000, 1000003 })
+        {
+            std::vector<int> v(n);
+            for (auto& x : v) x = static_cast<int>(gen() % 1000) - 500;
+            ASSERT_EQ(reduce_paral(v.begin(), v.end(), 10ll), std::accumulate(v.begin(), v.end(), 10ll));
+            auto max_op = [](int a, int b) { return std::max(a, b); };
+            ASSERT_EQ(reduce_paral(v.begin(), v.end(), INT_MIN, max_op), std::accumulate(v.begin(), v.end(), INT_MIN, max_op));
+            ASSERT_EQ(transform_reduce_paral(v.begin(), v.end(), 0ll, std::plus<>(), [](int x) { return 1ll * x * x; }),
+                std::transform_reduce(v.begin(), v.end(), 0ll, std::plus<>(), [](int x) { return 1ll * x * x; }));
+
+            // 满足结合律而不满足交换律的op：仿射变换的复合
+            using affine = std::pair<std::uint64_t, std::uint64_t>;
+            auto compose = [](const affine& f, const affine& g) { return affine(f.first * g.first, g.first * f.second + g.second); };
+            std::vector<affine> fs(n);
+            for (auto& f : fs) f = { gen() | 1u, gen() };
+            ASSERT_EQ(reduce_paral(fs.begin(), fs.end(), affine(1, 0), compose), std::accumulate(fs.begin(), fs.end(), affine(1, 0), compose));
+
+            // 浮点数的结果与线程数无关
+            std::vector<double> d(n);
+            for (auto& x : d) x = std::ldexp(static_cast<double>(gen() % 1000000) - 500000, static_cast<int>(gen() % 40) - 20);
+            const double r1 = reduce_paral(pool1, d.begin(), d.end(), 0.0);
+            const double r3 = reduce_paral(pool3, d.begin(), d.end(), 0.0);
+            const double r7 = reduce_paral(pool7, d.begin(), d.end(), 0.0);
+            ASSERT_EQ(std::memcmp(&r1, &r3, sizeof(double)), 0);
+            ASSERT_EQ(std::memcmp(&r1, &r7, sizeof(double)), 0);
+            const double c1 = reduce_paral(pool1, d.begin(), d.end(), 0.0, compensated_plus());
+            const double c7 = reduce_paral(pool7, d.begin(), d.end(), 0.0, compensated_plus());
+            ASSERT_EQ(std::memcmp(&c1, &c7, sizeof(double)), 0);
+
+            // 前向迭代器
+            std::list<int> l(v.begin(), v.end());
+            ASSERT_EQ(reduce_paral(l.begin(), l.end(), 0ll), std::accumulate(v.begin(), v.end(), 0ll));
+        }
+
+        // 病态求和：普通求和丢失小量，补偿求和得到精确结果
+        std::vector<double> d(1000000, 1.0);
+        d[0] = 1e16;
+        d[500000] = -1e16;
+        const double plain = reduce_paral(d.begin(), d.end(), 0.0);
+        const double compensated = reduce_paral(d.begin(), d.end(), 0.0, compensated_plus());
+        ASSERT_EQ(compensated, 999998.0);
+        ASSERT_NE(plain, compensated);
+        ASSERT_EQ(transform_reduce_paral(d.begin(), d.end(), 0.0, compensated_plus(), [](double x) { return x * 0.5; }), 499999.0);
+    }
+
+    TEST(Test_reduce_paral, Test1)
+    {
+        std::mt19937_64 gen(15);
+        std::vector<double> d(int(1e8));
+        for (auto& x : d) x = static_cast<double>(gen() % 1000) / 7;
+        double r1 = 0, r2 = 0, r3 = 0;
+        {
+            BENCHMARK(r1 = reduce_paral(d.begin(), d.end(), 0.0); ,
+                r2 = std::reduce(std::execution::par, d.begin(), d.end(), 0.0););
+        }
+        {
+            BENCHMARK(r3 = reduce_paral(d.begin(), d.end(), 0.0, compensated_plus()); ,
+                r2 = std::reduce(std::execution::par_unseq, d.begin(), d.end(), 0.0););
+        }
+        ASSERT_NEAR(r1, r2, 1e-9 * r2);
+        ASSERT_NEAR(r3, r2, 1e-9 * r2);
+    }
+
+    TEST(Test_find_paral, Test0)
+    {
+        std::vector<int> v(int(1e6), 0);
+        v[200] = 1;
+        BENCHMARK(auto found1 = find_paral(v.begin(), v.end(), 1); ,
+            auto found2 = std::find(v.begin(), v.end(), 1););
+        ASSERT_EQ(found1, found2);
+    }
+
+    TEST(Test_find_paral, Test1)
+    {
+        // 匹配位于末尾时各线程均扫描完整个分块
+        std::vector<uint8_t> v1(1 << 26, 0);
+        v1.back() = 1;
+        BENCHMARK(auto found1 = find_paral(v1.begin(), v1.end(), 1); ,
+            auto found2 = std::find(v1.begin(), v1.end(), 1););
+        ASSERT_EQ(found1, v1.end() - 1);
+        ASSERT_EQ(found2, v1.end() - 1);
+        ASSERT_EQ(find_paral(v1.begin(), v1.end(), 2), v1.end());
+
+        std::list<int> l1(10000, 0);
+        l1.back() = 1;
+        ASSERT_EQ(*find_paral(l1.begin(), l1.end(), 1), 1);
+    }
+
+    TEST(Test_find_if_paral, Test0)
+    {
+        // 多个分块中都有匹配时返回最靠前的一个
+        thread_pool pool(7);
+        std::mt19937 gen(20);
+        for (int n : { 0, 1, 100, 4096, 100003, 1000000 })
+        {
+            std::vector<int> v(n);
+            for (auto& x : v) x = static_cast<int>(gen() % 100000);
+            for (int value : { -1, 0, 50000, 99990, 99999 })
+            {
+                auto greater = [value](int x) { return x > value; };
+                ASSERT_EQ(find_if_paral(pool, v.begin(), v.end(), greater), std::find_if(v.begin(), v.end(), greater));
+                ASSERT_EQ(find_paral(pool, v.begin(), v.end(), value), std::find(v.begin(), v.end(), value));
+                ASSERT_EQ(any_of_paral(pool, v.begin(), v.end(), greater), std::any_of(v.begin(), v.end(), greater));
+                ASSERT_EQ(all_of_paral(pool, v.begin(), v.end(), greater), std::all_of(v.begin(), v.end(), greater));
+                ASSERT_EQ(none_of_paral(pool, v.begin(), v.end(), greater), std::none_of(v.begin(), v.end(), greater));
+            }
+            const std::vector<int> s = { 99998, 7, 12345 };
+            ASSERT_EQ(find_first_of_paral(pool, v.begin(), v.end(), s.begin(), s.end()),
+                std::find_first_of(v.begin(), v.end(), s.begin(), s.end()));
+        }
+
+        // 每个分块末尾各有一个匹配
+        std::vector<int> v(1000000, 0);
+        for (int i = 999999; i > 0; i -= 1000) v[i] = 1;
+        ASSERT_EQ(find_paral(pool, v.begin(), v.end(), 1), v.begin() + 999);
+        v[0] = 1;
+        ASSERT_EQ(find_if_paral(pool, v.begin(), v.end(), [](int x) { return x == 1; }), v.begin());
+
+        std::list<int> l(10000, 0);
+        *std::next(l.begin(), 5000) = 1;
+        l.back() = 1;
+        ASSERT_EQ(find_if_paral(pool, l.begin(), l.end(), [](int x) { return x == 1; }), std::next(l.begin(), 5000));
+        ASSERT_TRUE(any_of_paral(l.begin(), l.end(), [](int x) { return x == 1; }));
+        ASSERT_FALSE(all_of_paral(l.begin(), l.end(), [](int x) { return x == 1; }));
+
+        // 匹配靠前时不必扫描完整个区间
+        std::atomic<long long> calls = 0;
+        std::vector<int> w(int(1e7), 0);
+        w[10] = 1;
+        ASSERT_EQ(find_if_paral(pool, w.begin(), w.end(), [&calls](int x) { ++calls; return x == 1; }), w.begin() + 10);
+        ASSERT_LT(calls.load(), static_cast<long long>(w.size()) / 2);
+    }
+
+    TEST(Test_search_paral, Test0)
+    {
+        thread_pool pool(5);
+        std::mt19937 gen(21);
+        for (int n : { 0, 2, 3, 1000, 100003, 1000000 })
+        {
+            std::vector<int> v(n);
+            for (auto& x : v) x = static_cast<int>(gen() % 3);
+            for (int m : { 0, 1, 3, 8, 12 })
+            {
+                std::vector<int> s(m);
+                for (auto& x : s) x = static_cast<int>(gen() % 3);
+                ASSERT_EQ(search_paral(pool, v.begin(), v.end(), s.begin(), s.end()), std::search(v.begin(), v.end(), s.begin(), s.end()));
+            }
+        }
+
+        // 子序列跨越分块边界
+        std::vector<char> text(1 << 20, 'a');
+        const std::string word = "needle";
+        std::copy(word.begin(), word.end(), text.begin() + (1 << 19) - 3);
+        std::copy(word.begin(), word.end(), text.end() - word.size());
+        ASSERT_EQ(search_paral(pool, text.begin(), text.end(), word.begin(), word.end()), text.begin() + (1 << 19) - 3);
+        ASSERT_EQ(search_paral(pool, text.begin(), text.end(), word.begin(), word.end(),
+            [](char a, char b) { return a == b; }), text.begin() + (1 << 19) - 3);
+        ASSERT_EQ(search_paral(text.begin(), text.begin() + 3, word.begin(), word.end()), text.begin() + 3);
+
+        std::vector<char> big(int(1e8), 'a');
+        std::copy(word.begin(), word.end(), big.end() - word.size() - 1000);
+        BENCHMARK(auto found1 = search_paral(big.begin(), big.end(), word.begin(), word.end()); ,
+            auto found2 = std::search(big.begin(), big.end(), word.begin(), word.end()););
+        ASSERT_EQ(found1, found2);
+    }
+
+    TEST(Test_radix_sort_paral, Test0)
+    {
+        std::mt19937_64 gen(1);
+        for (int n : { 0, 1000, 100000, 1000003 })
+        {
+            std::vector<long long> v1(n);
+            for (auto& x : v1) x = static_cast<long long>(gen());
+            std::vector<long long> v2 = v1;
+            radix_sort_paral(v1.begin(), v1.end());
+            std::sort(v2.begin(), v2.end());
+            ASSERT_EQ(v1, v2);
+        }
+
+        // 键提取函数与稳定性
+        std::vector<std::pair<float, int>> v3(500000);
+        for (int i = 0; i < 500000; ++i)
+            v3[i] = { static_cast<float>(static_cast<int>(gen() % 200) - 100) / 4.0f, i };
+        std::vector<std::pair<float, int>> v4 = v3;
+        radix_sort_paral(v3.begin(), v3.end(), [](const std::pair<float, int>& p) { return p.first; });
+        std::stable_sort(v4.begin(), v4.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        ASSERT_EQ(v3, v4);
+    }
+
+    TEST(Test_radix_sort_paral, Test1)
+    {
+        std::mt19937_64 gen(2);
+        std::vector<std::uint64_t> input(int(2e7));
+        for (auto& x : input) x = gen();
+        std::vector<std::uint64_t> v1 = input, v2 = input, v3 = input;
+        {
+            BENCHMARK(radix_sort_paral(v1.begin(), v1.end()); , std::sort(v2.begin(), v2.end()););
+            ASSERT_EQ(v1, v2);
+        }
+        v1 = input;
+        {
+            BENCHMARK(radix_sort_paral(v1.begin(), v1.end()); , radix_sort(v3.begin(), v3.end()););
+            ASSERT_EQ(v1, v3);
+        }
+    }
+
+    TEST(Test_thread_pool, Test0)
+    {
+        thread_pool pool(3);
+        ASSERT_EQ(pool.thread_count(), 3);
+
+        auto f1 = pool.submit([] { return 42; });
+        auto f2 = pool.submit([]() -> int { throw std::runtime_error("task"); });
+        ASSERT_EQ(f1.get(), 42);
+        ASSERT_THROW(f2.get(), std::runtime_error);
+
+        // 任务中嵌套fork-join，等待者执行其它任务，不会死锁
+        std::function<long long(int, int)> sum = [&](int lo, int hi) -> long long
+            {
+                if (hi - lo <= 1000)
+                {
+                    long long s = 0;
+                    for (int i = lo; i < hi; ++i) s += i;
+                    return s;
+                }
+                long long parts[2];
+                const int mid = lo + (hi - lo) / 2;
+                auto half = [&](std::size_t i) { parts[i] = i ? sum(mid, hi) : sum(lo, mid); };
+                pool.run(2, half);
+                return parts[0] + parts[1];
+            };
+        ASSERT_EQ(sum(0, 1000000), 999999LL * 1000000 / 2);
+
+        // 所有任务结束后重新抛出异常
+        std::atomic<int> finished(0);
+        auto throwing = [&](std::size_t i)
+            {
+                if (i == 3)
+                    throw std::logic_error("run");
+                ++finished;
+            };
+        ASSERT_THROW(pool.run(8, throwing), std::logic_error);
+        ASSERT_EQ(finished.load(), 7);
+
+        // 传入线程池的重载
+        std::vector<int> v1(100000);
+        std::iota(v1.begin(), v1.end(), 0);
+        ASSERT_EQ(accumulate_paral(pool, v1.begin(), v1.end(), 0LL), 99999LL * 100000 / 2);
+        ASSERT_EQ(find_paral(pool, v1.begin(), v1.end(), 77777), v1.begin() + 77777);
+        for_each_paral(pool, v1.begin(), v1.end(), [](int& x) { x = -x; });
+        sort_paral(pool, v1.begin(), v1.end());
+        ASSERT_TRUE(std::is_sorted(v1.begin(), v1.end()));
+        stable_sort_paral(pool, v1.begin(), v1.end(), std::greater<int>());
+        ASSERT_TRUE(std::is_sorted(v1.begin(), v1.end(), std::greater<int>()));
+    }
+
+    TEST(Test_thread_pool, Test1)
+    {
+        // 大量小规模调用：复用线程池与每次创建线程比较
+        const int calls = 2000;
+        std::vector<double> v1(20000, 5), v2(20000, 5);
+        auto op = [](double& x) { x = std::sqrt(x); };
+        auto for_each_threads = [&](std::vector<double>& v)
+            {
+                const std::size_t thread_num = std::max(std::thread::hardware_concurrency(), 2u);
+                const std::size_t per_thread = v.size() / thread_num;
+                std::vector<std::thread> threads(thread_num - 1);
+                for (std::size_t t = 0; t + 1 < thread_num; ++t)
+                    threads[t] = std::thread([&, t] { std::for_each(v.begin() + t * per_thread, v.begin() + (t + 1) * per_thread, op); });
+                std::for_each(v.begin() + (thread_num - 1) * per_thread, v.end(), op);
+                for (auto& thread : threads)
+                    thread.join();
+            };
+        BENCHMARK(for (int i = 0; i < calls; ++i) for_each_paral(v1.begin(), v1.end(), op); ,
+            for (int i = 0; i < calls; ++i) for_each_threads(v2););
+        ASSERT_EQ(v1, v2);
+    }
+
+    TEST(Test_sort_paral, Test0)
+    {
+        std::mt19937 gen(3);
+        const int n = 300000;
+        std::vector<std::vector<int>> inputs;
+        std::vector<int> v(n);
+        for (auto& x : v) x = static_cast<int>(gen());
+        inputs.push_back(v);                                    // 随机
+        std::sort(v.begin(), v.end());
+        inputs.push_back(v);                                    // 有序
+        std::reverse(v.begin(), v.end());
+        inputs.push_back(v);                                    // 逆序
+        for (auto& x : v) x = static_cast<int>(gen() % 4);
+        inputs.push_back(v);                                    // 少量不同值
+        for (int i = 0; i < n; ++i) v[i] = std::min(i, n - i);
+        inputs.push_back(v);                                    // 管风琴
+        inputs.push_back(std::vector<int>(n, 7));               // 全部相等
+
+        for (const auto& input : inputs)
+        {
+            std::vector<int> v1 = input, v2 = input;
+            sort_paral(v1.begin(), v1.end());
+            std::sort(v2.begin(), v2.end());
+            ASSERT_EQ(v1, v2);
+
+            v1 = input;
+            sort_paral(v1.begin(), v1.end(), std::greater<int>());
+            ASSERT_TRUE(std::is_sorted(v1.begin(), v1.end(), std::greater<int>()));
+        }
+
+        std::vector<std::string> v3(100000);
+        for (auto& s : v3) s = std::to_string(gen());
+        std::vector<std::string> v4 = v3;
+        sort_paral(v3.begin(), v3.end());
+        std::sort(v4.begin(), v4.end());
+        ASSERT_EQ(v3, v4);
+    }
+
+    TEST(Test_sort_paral, Test1)
+    {
+        std::mt19937_64 gen(4);
+        std::vector<std::uint64_t> input(int(2e7));
+        for (auto& x : input) x = gen();
+        std::vector<std::uint64_t> v1 = input, v2 = input;
+        {
+            BENCHMARK(sort_paral(v1.begin(), v1.end()); , std::sort(std::execution::par, v2.begin(), v2.end()););
+            ASSERT_EQ(v1, v2);
+        }
+        // 少量不同值
+        for (auto& x : input) x %= 16;
+        v1 = input, v2 = input;
+        {
+            BENCHMARK(sort_paral(v1.begin(), v1.end()); , std::sort(std::execution::par, v2.begin(), v2.end()););
+            ASSERT_EQ(v1, v2);
+        }
+    }
+
+    TEST(Test_merge_paral, Test0)
+    {
+        // 以first比较，second记录来源以检查稳定性
+        using item = std::pair<int, int>;
+        auto comp = [](const item& a, const item& b) { return a.first < b.first; };
+        std::mt19937 gen(5);
+        for (auto [n1, n2] : { std::pair{ 0, 1000 }, std::pair{ 100000, 0 }, std::pair{ 300000, 200001 }, std::pair{ 1000, 500000 } })
+        {
+            std::vector<item> v1(n1), v2(n2);
+            for (int i = 0; i < n1; ++i) v1[i] = { static_cast<int>(gen() % 1000), i };
+            for (int i = 0; i < n2; ++i) v2[i] = { static_cast<int>(gen() % 1000), -i };
+            std::stable_sort(v1.begin(), v1.end(), comp);
+            std::stable_sort(v2.begin(), v2.end(), comp);
+            std::vector<item> res1(n1 + n2), res2(n1 + n2);
+            ASSERT_EQ(merge_paral(v1.begin(), v1.end(), v2.begin(), v2.end(), res1.begin(), comp), res1.end());
+            std::merge(v1.begin(), v1.end(), v2.begin(), v2.end(), res2.begin(), comp);
+            ASSERT_EQ(res1, res2);
+        }
+    }
+
+    TEST(Test_merge_paral, Test1)
+    {
+        std::mt19937_64 gen(6);
+        std::vector<std::uint64_t> v1(int(1e7)), v2(int(1e7));
+        for (auto& x : v1) x = gen();
+        for (auto& x : v2) x = gen();
+        std::sort(v1.begin(), v1.end());
+        std::sort(v2.begin(), v2.end());
+        std::vector<std::uint64_t> res1(v1.size() + v2.size()), res2(v1.size() + v2.size());
+        BENCHMARK(merge_paral(v1.begin(), v1.end(), v2.begin(), v2.end(), res1.begin()); ,
+            std::merge(std::execution::par, v1.begin(), v1.end(), v2.begin(), v2.end(), res2.begin()););
+        ASSERT_EQ(res1, res2);
+    }
+
+    TEST(Test_multiway_merge_paral, Test0)
+    {
+        using item = std::pair<int, int>;
+        auto comp = [](const item& a, const item& b) { return a.first < b.first; };
+        std::mt19937 gen(7);
+        for (int k : { 1, 2, 3, 8, 37 })
+        {
+            // 长度不等的有序区间，含空区间
+            std::vector<std::vector<item>> shards(k);
+            std::vector<item> all;
+            for (int r = 0; r < k; ++r)
+            {
+                shards[r].resize(r % 5 == 4 ? 0 : gen() % 40000);
+                for (auto& x : shards[r]) x = { static_cast<int>(gen() % 500), r };
+                std::stable_sort(shards[r].begin(), shards[r].end(), comp);
+                all.insert(all.end(), shards[r].begin(), shards[r].end());
+            }
+            std::vector<std::pair<std::vector<item>::const_iterator, std::vector<item>::const_iterator>> runs;
+            for (const auto& shard : shards)
+                runs.emplace_back(shard.cbegin(), shard.cend());
+
+            std::vector<item> res(all.size());
+            ASSERT_EQ(multiway_merge_paral(runs, res.begin(), comp), res.end());
+            std::stable_sort(all.begin(), all.end(), comp);
+            ASSERT_EQ(res, all);
+        }
+    }
+
+    TEST(Test_multiway_merge_paral, Test1)
+    {
+        // 16个有序分片，与单线程的多路归并比较
+        std::mt19937_64 gen(8);
+        std::vector<std::vector<std::uint64_t>> shards(16, std::vector<std::uint64_t>(1 << 20));
+        std::vector<std::pair<const std::uint64_t*, const std::uint64_t*>> runs;
+        for (auto& shard : shards)
+        {
+            for (auto& x : shard) x = gen();
+            std::sort(shard.begin(), shard.end());
+            runs.emplace_back(shard.data(), shard.data() + shard.size());
+        }
+        std::vector<std::uint64_t> res1(16 << 20), res2(16 << 20);
+        std::less<> comp;
+        BENCHMARK(multiway_merge_paral(runs, res1.begin()); ,
+            merge_detail::multiway_merge(runs, res2.begin(), comp););
+        ASSERT_EQ(res1, res2);
+        ASSERT_TRUE(std::is_sorted(res1.begin(), res1.end()));
+    }
+
+    TEST(Test_stable_sort_paral, Test0)
+    {
+        using item = std::pair<int, int>;
+        auto comp = [](const item& a, const item& b) { return a.first < b.first; };
+        std::mt19937 gen(9);
+        for (int n : { 0, 1000, 100000, 1000003 })
+        {
+            std::vector<item> v1(n);
+            for (int i = 0; i < n; ++i) v1[i] = { static_cast<int>(gen() % 1000), i };
+            std::vector<item> v2 = v1;
+            stable_sort_paral(v1.begin(), v1.end(), comp);
+            std::stable_sort(v2.begin(), v2.end(), comp);
+            ASSERT_EQ(v1, v2);
+        }
+
+        // 不可平凡复制的元素
+        std::vector<std::string> v3(200000);
+        for (auto& s : v3) s = std::to_string(gen() % 10000);
+        std::vector<std::string> v4 = v3;
+        auto by_length = [](const std::string& a, const std::string& b) { return a.size() < b.size(); };
+        stable_sort_paral(v3.begin(), v3.end(), by_length);
+        std::stable_sort(v4.begin(), v4.end(), by_length);
+        ASSERT_EQ(v3, v4);
+    }
+
+    TEST(Test_stable_sort_paral, Test1)
+    {
+        std::mt19937_64 gen(10);
+        std::vector<std::uint64_t> input(int(2e7));
+        for (auto& x : input) x = gen();
+        std::vector<std::uint64_t> v1 = input, v2 = input;
+        BENCHMARK(stable_sort_paral(v1.begin(), v1.end()); ,
+            std::stable_sort(std::execution::par, v2.begin(), v2.end()););
+        ASSERT_EQ(v1, v2);
+    }
+
+    TEST(TEST_partial_sum_paral, Test0)
+    {
+        std::vector<int> v1(200, 1);
+        std::vector<int> v2 = v1;
+        BENCHMARK(partial_sum_paral(v1.begin(), v1.end()); ,
+            std::partial_sum(v2.begin(), v2.end(), v2.begin()););
+        ASSERT_EQ(v1, v2);
+    }
+
+    TEST(Test_scan_paral, Test0)
+    {
+        std::mt19937 gen(13);
+        for (int n : { 0, 1, 1000, 100003, 1000000 })
+        {
+            std::vector<int> input(n);
+            for (auto& x : input) x = static_cast<int>(gen() % 100) - 50;
+
+            std::vector<int> res(n), expected(n);
+            ASSERT_EQ(inclusive_scan_paral(input.begin(), input.end(), res.begin()), res.end());
+            std::inclusive_scan(input.begin(), input.end(), expected.begin());
+            ASSERT_EQ(res, expected);
+
+            ASSERT_EQ(exclusive_scan_paral(input.begin(), input.end(), res.begin(), 7), res.end());
+            std::exclusive_scan(input.begin(), input.end(), expected.begin(), 7);
+            ASSERT_EQ(res, expected);
+
+            // 原地计算
+            res = input;
+            partial_sum_paral(res.begin(), res.end());
+            std::partial_sum(input.begin(), input.end(), expected.begin());
+            ASSERT_EQ(res, expected);
+
+            res = input;
+            exclusive_scan_paral(res.begin(), res.end(), res.begin(), 0);
+            std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0);
+            ASSERT_EQ(res, expected);
+
+            // 满足结合律而不满足交换律的op：仿射变换x -> a * x + b的复合
+            using affine = std::pair<std::uint32_t, std::uint32_t>;
+            auto compose = [](const affine& f, const affine& g) { return affine(f.first * g.first, g.first * f.second + g.second); };
+            std::vector<affine> fs(n), r1(n), r2(n);
+            for (auto& f : fs) f = { static_cast<std::uint32_t>(gen()) | 1u, static_cast<std::uint32_t>(gen()) };
+            inclusive_scan_paral(fs.begin(), fs.end(), r1.begin(), compose, affine(3, 5));
+            std::inclusive_scan(fs.begin(), fs.end(), r2.begin(), compose, affine(3, 5));
+            ASSERT_EQ(r1, r2);
+            exclusive_scan_paral(fs.begin(), fs.end(), r1.begin(), affine(1, 0), compose);
+            std::exclusive_scan(fs.begin(), fs.end(), r2.begin(), affine(1, 0), compose);
+            ASSERT_EQ(r1, r2);
+
+            // 前向迭代器，输出类型与输入不同
+            std::list<int> l(input.begin(), input.end());
+            std::vector<long long> r3(n), r4(n);
+            inclusive_scan_paral(l.begin(), l.end(), r3.begin(), std::plus<long long>(), 0ll);
+            std::inclusive_scan(input.begin(), input.end(), r4.begin(), std::plus<long long>(), 0ll);
+            ASSERT_EQ(r3, r4);
+        }
+    }
+
+    TEST(Test_scan_paral, Test1)
+    {
+        // 原地扫描，1e6至1e8个元素（定义BENCH_LARGE时至1e9个，需要8GB内存）
+        std::vector<std::size_t> sizes = { std::size_t(1e6), std::size_t(1e7), std::size_t(1e8) };
+#ifdef BENCH_LARGE
+        sizes.push_back(std::size_t(1e9));
+#endif
+        for (std::size_t n : sizes)
+        {
+            std::vector<std::uint32_t> v1(n), v2(n);
+            for (std::size_t i = 0; i < n; ++i)
+                v1[i] = v2[i] = static_cast<std::uint32_t>(i * 2654435761u);
+            LOG << n << " elements" << std::endl;
+            BENCHMARK(inclusive_scan_paral(v1.begin(), v1.end(), v1.begin()); ,
+                std::inclusive_scan(std::execution::par, v2.begin(), v2.end(), v2.begin()););
+            ASSERT_EQ(v1, v2);
+        }
+    }
+
+    TEST(Test_transform_paral, Test0)
+    {
+        std::mt19937 gen(16);
+        for (int n : { 0, 1, 1000, 1000003 })
+        {
+            std::vector<int> a(n), b(n);
+            for (auto& x : a) x = static_cast<int>(gen() % 1000);
+            for (auto& x : b) x = static_cast<int>(gen() % 1000);
+            std::vector<long long> r1(n), r2(n);
+            ASSERT_EQ(transform_paral(a.begin(), a.end(), r1.begin(), [](int x) { return 3ll * x; }), r1.end());
+            std::transform(a.begin(), a.end(), r2.begin(), [](int x) { return 3ll * x; });
+            ASSERT_EQ(r1, r2);
+            ASSERT_EQ(transform_paral(a.begin(), a.end(), b.begin(), r1.begin(), std::multiplies<long long>()), r1.end());
+            std::transform(a.begin(), a.end(), b.begin(), r2.begin(), std::multiplies<long long>());
+            ASSERT_EQ(r1, r2);
+
+            // 前向迭代器，原地变换
+            std::list<int> l(a.begin(), a.end());
+            ASSERT_EQ(transform_paral(l.begin(), l.end(), l.begin(), [](int x) { return x + 1; }), l.end());
+            std::transform(a.begin(), a.end(), a.begin(), [](int x) { return x + 1; });
+            ASSERT_TRUE(std::equal(l.begin(), l.end(), a.begin(), a.end()));
+        }
+    }
+
+    TEST(Test_copy_if_paral, Test0)
+    {
+        std::mt19937 gen(17);
+        for (int n : { 0, 1, 1000, 100003, 1000000 })
+        {
+            for (int keep : { 0, 1, 50, 100 })
+            {
+                // keep%的元素满足pred
+                std::vector<int> v(n);
+                for (auto& x : v) x = static_cast<int>(gen() % 100);
+                auto pred = [keep](int x) { return x < keep; };
+
+                std::vector<int> r1(n, -1), r2(n, -1);
+                auto end1 = copy_if_paral(v.begin(), v.end(), r1.begin(), pred);
+                auto end2 = std::copy_if(v.begin(), v.end(), r2.begin(), pred);
+                ASSERT_EQ(end1 - r1.begin(), end2 - r2.begin());
+                ASSERT_EQ(r1, r2);
+
+                std::vector<int> v1 = v, v2 = v;
+                auto rend1 = remove_if_paral(v1.begin(), v1.end(), pred);
+                auto rend2 = std::remove_if(v2.begin(), v2.end(), pred);
+                ASSERT_EQ(rend1 - v1.begin(), rend2 - v2.begin());
+                ASSERT_TRUE(std::equal(v1.begin(), rend1, v2.begin(), rend2));
+
+                v1 = v, v2 = v;
+                auto p1 = partition_paral(v1.begin(), v1.end(), pred);
+                auto p2 = std::stable_partition(v2.begin(), v2.end(), pred);
+                ASSERT_EQ(p1 - v1.begin(), p2 - v2.begin());
+                ASSERT_EQ(v1, v2);
+            }
+        }
+
+        // 不可平凡复制的元素
+        std::vector<std::string> s(200000);
+        for (auto& x : s) x = std::to_string(gen() % 100000);
+        auto odd_length = [](const std::string& x) { return x.size() % 2 == 1; };
+        std::vector<std::string> s1 = s, s2 = s;
+        auto p1 = partition_paral(s1.begin(), s1.end(), odd_length);
+        auto p2 = std::stable_partition(s2.begin(), s2.end(), odd_length);
+        ASSERT_EQ(p1 - s1.begin(), p2 - s2.begin());
+        ASSERT_EQ(s1, s2);
+        s1 = s, s2 = s;
+        auto e1 = remove_if_paral(s1.begin(), s1.end(), odd_length);
+        auto e2 = std::remove_if(s2.begin(), s2.end(), odd_length);
+        ASSERT_TRUE(std::equal(s1.begin(), e1, s2.begin(), e2));
+
+        // 前向迭代器
+        std::list<int> l(100000);
+        for (auto& x : l) x = static_cast<int>(gen() % 10);
+        std::vector<int> expected(l.begin(), l.end());
+        auto lp = partition_paral(l.begin(), l.end(), [](int x) { return x < 3; });
+        auto ep = std::stable_partition(expected.begin(), expected.end(), [](int x) { return x < 3; });
+        ASSERT_EQ(std::distance(l.begin(), lp), ep - expected.begin());
+        ASSERT_TRUE(std::equal(l.begin(), l.end(), expected.begin(), expected.end()));
+
+        // pred抛出异常时已移入暂存区的元素被正确销毁
+        std::vector<std::string> s3 = s;
+        std::atomic<int> calls(0);
+        ASSERT_THROW(partition_paral(thread_pool::default_pool(), s3.begin(), s3.end(),
+            [&calls](const std::string&) { if (++calls == 150000) throw std::runtime_error("pred"); return true; }),
+            std::runtime_error);
+    }
+
+    TEST(Test_copy_if_paral, Test1)
+    {
+        std::mt19937 gen(18);
+        std::vector<std::uint32_t> v(int(5e7));
+        for (auto& x : v) x = static_cast<std::uint32_t>(gen());
+        auto pred = [](std::uint32_t x) { return x % 3 == 0; };
+        std::vector<std::uint32_t> r1(v.size()), r2(v.size());
+        std::vector<std::uint32_t>::iterator end1, end2;
+        BENCHMARK(end1 = copy_if_paral(v.begin(), v.end(), r1.begin(), pred); ,
+            end2 = std::copy_if(std::execution::par, v.begin(), v.end(), r2.begin(), pred););
+        ASSERT_EQ(end1 - r1.begin(), end2 - r2.begin());
+        ASSERT_EQ(r1, r2);
+    }
+
+    TEST(Test_partitioner, Test0)
+    {
+        // 各划分器恰好访问每个下标一次
+        for (std::size_t threads : { 1, 3, 8 })
+        {
+            thread_pool pool(threads);
+            for (std::size_t n : { 0, 1, 7, 100, 4097, 100003 })
+            {
+                auto check = [&](auto&& partitioner)
+                    {
+                        std::vector<std::atomic<int>> visits(n);
+                        auto body = [&](std::size_t begin, std::size_t end)
+                            {
+                                ASSERT_LT(begin, end);
+                                ASSERT_LE(end, n);
+                                for (std::size_t i = begin; i < end; ++i)
+                                    ++visits[i];
+                            };
+                        partitioner.run(pool, n, body);
+                        for (std::size_t i = 0; i < n; ++i)
+                            ASSERT_EQ(visits[i].load(), 1);
+                    };
+                check(static_partitioner());
+                check(static_partitioner(1000));
+                check(dynamic_partitioner(1));
+                check(dynamic_partitioner(333));
+                check(guided_partitioner());
+                check(guided_partitioner(64));
+                check(auto_partitioner());
+                check(auto_partitioner(std::chrono::nanoseconds(0), std::chrono::nanoseconds(0)));
+            }
+        }
+
+        // 元素很少时auto_partitioner在当前线程完成
+        thread_pool pool(7);
+        const std::thread::id caller = std::this_thread::get_id();
+        std::vector<int> small(640, 1);
+        std::atomic<bool> other_thread = false;
+        auto_partitioner ap(std::chrono::microseconds(100), std::chrono::milliseconds(1));
+        for_each_paral(pool, small.begin(), small.end(), [&](int& x) { x += 1; if (std::this_thread::get_id() != caller) other_thread = true; }, ap);
+        ASSERT_FALSE(other_thread);
+        ASSERT_EQ(ap.last_grain(), 0);
+        ASSERT_EQ(std::count(small.begin(), small.end(), 2), 640);
+
+        // 元素昂贵时分为多块
+        std::vector<int> slow(2000, 0);
+        for_each_paral(pool, slow.begin(), slow.end(), [](int& x) { std::this_thread::sleep_for(std::chrono::microseconds(20)); x = 1; }, ap);
+        ASSERT_GE(ap.last_grain(), 1);
+        ASSERT_LE(ap.last_grain(), 2000 / (4 * pool.concurrency()) + 1);
+        ASSERT_EQ(std::count(slow.begin(), slow.end(), 1), 2000);
+
+        // 各算法接受划分器，结果与std一致
+        std::vector<int> input(100003);
+        std::iota(input.begin(), input.end(), 0);
+        std::vector<long long> out(input.size()), expected(input.size());
+        std::transform(input.begin(), input.end(), expected.begin(), [](int x) { return x * 3ll; });
+        ASSERT_EQ(transform_paral(pool, input.begin(), input.end(), out.begin(), [](int x) { return x * 3ll; }, guided_partitioner(16)), out.end());
+        ASSERT_EQ(out, expected);
+        ASSERT_EQ(transform_paral(input.begin(), input.end(), input.begin(), out.begin(), std::plus<long long>(), dynamic_partitioner(100)), out.end());
+        ASSERT_EQ(out[100002], 200004);
+        ASSERT_EQ(accumulate_paral(pool, input.begin(), input.end(), 0ll, dynamic_partitioner(10)), 100003ll * 100002 / 2);
+        ASSERT_EQ(accumulate_paral(input.begin(), input.end(), 0ll, static_partitioner()), 100003ll * 100002 / 2);
+
+        // 部分和按块的顺序合并
+        std::vector<std::string> digits(5000);
+        for (int i = 0; i < 5000; ++i) digits[i] = std::to_string(i % 10);
+        const std::string joined = std::accumulate(digits.begin(), digits.end(), std::string());
+        ASSERT_EQ(accumulate_paral(pool, digits.begin(), digits.end(), std::string(), dynamic_partitioner(7)), joined);
+        ASSERT_EQ(accumulate_paral(pool, digits.begin(), digits.end(), std::string(), guided_partitioner()), joined);
+
+        std::list<int> l(1000, 1);
+        for_each_paral(pool, l.begin(), l.end(), [](int& x) { ++x; }, dynamic_partitioner());
+        ASSERT_EQ(accumulate_paral(pool, l.begin(), l.end(), 0, dynamic_partitioner()), 2000);
+
+        // 不指定划分器时按并发数等分，浮点数的结果逐位相同
+        std::mt19937 gen(21);
+        std::vector<double> d(100003);
+        for (auto& x : d) x = std::ldexp(static_cast<double>(gen()), -static_cast<int>(gen() % 40));
+        const double first_sum = accumulate_paral(pool, d.begin(), d.end(), 0.0);
+        for (int r = 0; r < 20; ++r)
+            ASSERT_EQ(accumulate_paral(pool, d.begin(), d.end(), 0.0), first_sum);
+    }
+
+    TEST(Test_partitioner, Test1)
+    {
+        // 各元素耗时相同与耗时集中在最后八分之一两种负载
+        const int n = int(2e5);
+        std::vector<double> v(n, 1.0);
+        auto work = [](double& x, int rounds)
+            {
+                for (int r = 0; r < rounds; ++r)
+                    x = std::sqrt(x + r);
+            };
+        auto uniform = [&](double& x) { work(x, 20); };
+        auto skewed = [&](double& x) { work(x, &x - v.data() >= n / 8 * 7 ? 400 : 5); };
+
+        auto bench = [&](const char* name, const auto& f)
+            {
+                LOG << name << std::endl;
+                {
+                    BENCHMARK(for_each_paral(v.begin(), v.end(), f, static_partitioner()); ,
+                        for_each_paral(v.begin(), v.end(), f, dynamic_partitioner()););
+                }
+                {
+                    BENCHMARK(for_each_paral(v.begin(), v.end(), f, guided_partitioner()); ,
+                        for_each_paral(v.begin(), v.end(), f, auto_partitioner()););
+                }
+            };
+        bench("uniform", uniform);
+        bench("skewed", skewed);
+    }
+
+    TEST(Test_sync, Test0)
+    {
+        // latch：所有线程完成准备后主线程才继续
+        {
+            const int n = 8;
+            bitstl::latch done(n);
+            std::vector<int> ready(n, 0);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < n; ++t)
+                threads.emplace_back([&, t] { ready[t] = 1; done.count_down(); });
+            done.wait();
+            ASSERT_TRUE(done.try_wait());
+            ASSERT_EQ(std::count(ready.begin(), ready.end(), 1), n);
+            for (auto& th : threads) th.join();
+        }
+
+        // barrier：completion在所有线程到达后、任何线程离开前调用一次
+        {
+            const int n = 6, rounds = 300;
+            std::vector<int> data(n, -1);
+            int completed = 0;
+            bool consistent = true;
+            bitstl::barrier sync(n, [&]() noexcept
+                {
+                    if (completed % 2 == 0)
+                        for (int x : data)
+                            consistent &= x == completed / 2;
+                    ++completed;
+                });
+            std::atomic<bool> ok = true;
+            std::vector<std::thread> threads;
+            for (int t = 0; t < n; ++t)
+                threads.emplace_back([&, t]
+                    {
+                        for (int r = 0; r < rounds; ++r)
+                        {
+                            data[t] = r;
+                            sync.arrive_and_wait();
+                            if (completed != 2 * r + 1) ok = false;
+                            sync.arrive_and_wait();
+                        }
+                    });
+            for (auto& th : threads) th.join();
+            ASSERT_TRUE(ok);
+            ASSERT_TRUE(consistent);
+            ASSERT_EQ(completed, 2 * rounds);
+        }
+
+        // arrive_and_drop：退出的线程不再被等待
+        {
+            const int n = 4, rounds = 50;
+            std::atomic<int> completed = 0;
+            bitstl::barrier sync(n, [&]() noexcept { ++completed; });
+            std::vector<std::thread> threads;
+            for (int t = 0; t < n; ++t)
+                threads.emplace_back([&, t]
+                    {
+                        for (int r = 0; r < rounds; ++r)
+                        {
+                            if (t == 0 && r == 10)
+                            {
+                                sync.arrive_and_drop();
+                                return;
+                            }
+                            auto token = sync.arrive();
+                            sync.wait(std::move(token));
+                        }
+                    });
+            for (auto& th : threads) th.join();
+            ASSERT_EQ(completed, rounds);
+        }
+
+        // phaser：运行中注册与注销参与者
+        {
+            const int rounds = 40;
+            std::atomic<int> completed = 0;
+            bitstl::phaser sync(2, [&]() noexcept { ++completed; });
+            std::atomic<int> arrivals = 0;
+            std::atomic<bool> ok = true;
+            std::thread late;
+            auto worker = [&](bool spawn)
+                {
+                    for (int r = 0; r < rounds; ++r)
+                    {
+                        if (spawn && r == 5)
+                        {
+                            const std::uint32_t first_phase = sync.register_party();
+                            late = std::thread([&, first_phase]
+                                {
+                                    for (std::uint32_t p = first_phase; p < 20; ++p)
+                                    {
+                                        ++arrivals;
+                                        if (sync.arrive_and_await_advance() != p + 1) ok = false;
+                                    }
+                                    sync.arrive_and_deregister();
+                                });
+                        }
+                        ++arrivals;
+                        if (sync.arrive_and_await_advance() != static_cast<std::uint32_t>(r + 1)) ok = false;
+                    }
+                    sync.arrive_and_deregister();
+                };
+            std::thread a(worker, true), b(worker, false);
+            a.join();
+            b.join();
+            late.join();
+            ASSERT_TRUE(ok);
+            // 最后一次的注销推进了一个阶段
+            ASSERT_EQ(completed, rounds + 1);
+            ASSERT_EQ(sync.phase(), static_cast<std::uint32_t>(rounds + 1));
+            ASSERT_EQ(sync.registered_parties(), 0u);
+            ASSERT_EQ(arrivals, 2 * rounds + (20 - 5));
+        }
+    }
+
+    TEST(Test_sync, Test1)
+    {
+        // 每轮所有线程到达一次栅栏，线程数超过核数时std::barrier的实现与此处的自旋后阻塞对比
+        for (int n : { 2, 4, 8, 16, 32, 64, 128 })
+        {
+            const int rounds = 2000;
+            auto round_trip = [&](auto& sync)
+                {
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < n; ++t)
+                        threads.emplace_back([&] { for (int r = 0; r < rounds; ++r) sync.arrive_and_wait(); });
+                    for (auto& th : threads) th.join();
+                };
+            bitstl::barrier b1(n);
+            std::barrier b2(n);
+            LOG << n << " threads, " << rounds << " rounds" << std::endl;
+            BENCHMARK(round_trip(b1); , round_trip(b2););
+        }
+    }
+
+    TEST(Test_parallel_for, Test0)
+    {
+        // 每个下标恰好访问一次，块的各维不超过粒度
+        thread_pool pool(5);
+        {
+            std::vector<std::atomic<int>> visits(1001);
+            parallel_for(pool, blocked_range<int>(0, 1001, 10), [&](const blocked_range<int>& r)
+                {
+                    ASSERT_LE(r.size(), 10u);
+                    for (int i = r.begin(); i != r.end(); ++i)
+                        ++visits[i];
+                });
+            for (auto& v : visits)
+                ASSERT_EQ(v.load(), 1);
+        }
+        for (auto [rows, cols] : { std::pair{ 1, 1 }, std::pair{ 3, 1000 }, std::pair{ 257, 129 }, std::pair{ 1000, 3 } })
+        {
+            std::vector<std::atomic<int>> visits(rows * cols);
+            parallel_for(pool, blocked_range2d<int>(0, rows, 16, 0, cols, 32), [&](const blocked_range2d<int>& r)
+                {
+                    ASSERT_LE(r.rows().size(), 16u);
+                    ASSERT_LE(r.cols().size(), 32u);
+                    for (int i = r.rows().begin(); i != r.rows().end(); ++i)
+                        for (int j = r.cols().begin(); j != r.cols().end(); ++j)
+                            ++visits[i * cols + j];
+                }, dynamic_partitioner(1));
+            for (auto& v : visits)
+                ASSERT_EQ(v.load(), 1);
+        }
+        {
+            const int pages = 37, rows = 20, cols = 50;
+            std::vector<std::atomic<int>> visits(pages * rows * cols);
+            std::atomic<int> tiles = 0;
+            parallel_for(pool, blocked_range3d<int>(0, pages, 0, rows, 0, cols), [&](const blocked_range3d<int>& r)
+                {
+                    ++tiles;
+                    ASSERT_LE(r.pages().size(), 16u);
+                    ASSERT_LE(r.rows().size(), 16u);
+                    ASSERT_LE(r.cols().size(), 16u);
+                    for (int p = r.pages().begin(); p != r.pages().end(); ++p)
+                        for (int i = r.rows().begin(); i != r.rows().end(); ++i)
+                            for (int j = r.cols().begin(); j != r.cols().end(); ++j)
+                                ++visits[(p * rows + i) * cols + j];
+                });
+            for (auto& v : visits)
+                ASSERT_EQ(v.load(), 1);
+            // 每一维都对半分割：37 -> 4块，20 -> 2块，50 -> 4块
+            ASSERT_EQ(tiles, 4 * 2 * 4);
+        }
+        bool called = false;
+        parallel_for(blocked_range2d<int>(0, 0, 5, 5), [&](const blocked_range2d<int>&) { called = true; });
+        ASSERT_FALSE(called);
+    }
+
+    TEST(Test_parallel_for, Test1)
+    {
+        // 分块与按行划分的对比：转置的按列写入在按行划分时每个元素各占一个缓存行，分块时缓存行在换出前被整块写满
+        const int n = 4096;
+        bitstl::vector<double> a(n * n), b(n * n), c(n * n);
+        for (int i = 0; i < n * n; ++i) a[i] = i;
+        std::vector<int> row_index(n);
+        std::iota(row_index.begin(), row_index.end(), 0);
+        {
+            BENCHMARK(parallel_for(blocked_range2d<int>(0, n, 0, n), [&](const blocked_range2d<int>& r)
+                {
+                    for (int i = r.rows().begin(); i != r.rows().end(); ++i)
+                        for (int j = r.cols().begin(); j != r.cols().end(); ++j)
+                            b[j * n + i] = a[i * n + j];
+                }); ,
+                for_each_paral(row_index.begin(), row_index.end(), [&](int i)
+                    {
+                        for (int j = 0; j < n; ++j)
+                            c[j * n + i] = a[i * n + j];
+                    }););
+            for (int i = 0; i < n * n; i += 4097)
+                ASSERT_EQ(b[i], c[i]);
+        }
+
+        // 三维7点模板：按行划分时需要相邻的三个面同时在缓存中，面超过缓存时分块只需三个块大小的面
+        // 连续的一维不分割，块内最内层循环仍足够长以便向量化与预取
+        const int m = 256;
+        bitstl::vector<double> u(m * m * m), v1(m * m * m), v2(m * m * m);
+        for (int i = 0; i < m * m * m; ++i) u[i] = i % 17;
+        auto stencil = [&](bitstl::vector<double>& out, int p, int i, int j)
+            {
+                const int k = (p * m + i) * m + j;
+                out[k] = (6 * u[k] - u[k - 1] - u[k + 1] - u[k - m] - u[k + m] - u[k - m * m] - u[k + m * m]) / 6;
+            };
+        std::vector<int> plane_rows((m - 2) * (m - 2));
+        std::iota(plane_rows.begin(), plane_rows.end(), 0);
+        {
+            BENCHMARK(parallel_for(blocked_range3d<int>(1, m - 1, 8, 1, m - 1, 8, 1, m - 1, m), [&](const blocked_range3d<int>& r)
+                {
+                    for (int p = r.pages().begin(); p != r.pages().end(); ++p)
+                        for (int i = r.rows().begin(); i != r.rows().end(); ++i)
+                            for (int j = r.cols().begin(); j != r.cols().end(); ++j)
+                                stencil(v1, p, i, j);
+                }); ,
+                for_each_paral(plane_rows.begin(), plane_rows.end(), [&](int pi)
+                    {
+                        for (int j = 1; j < m - 1; ++j)
+                            stencil(v2, pi / (m - 2) + 1, pi % (m - 2) + 1, j);
+                    }););
+            for (int i = 0; i < m * m * m; i += 1001)
+                ASSERT_EQ(v1[i], v2[i]);
+        }
+    }
+
+    TEST(Test_pipeline, Test0)
+    {
+        // parse -> enrich（并行） -> aggregate（按序） -> emit，结果与串行处理相同且保持源的顺序
+        const int num = 20000;
+        std::vector<std::string> lines(num);
+        for (int i = 0; i < num; ++i) lines[i] = std::to_string(i);
+        {
+            int next = 0;
+            long long running = 0;
+            std::vector<long long> emitted;
+            auto p = make_pipeline("read", [&]() -> std::optional<std::string>
+                {
+                    if (next == num) return std::nullopt;
+                    return lines[next++];
+                })
+                .then("parse", stage_mode::parallel, [](const std::string& s) { return std::stoi(s); }, 8)
+                .then("enrich", stage_mode::parallel, [](int x) { return std::pair<int, long long>(x, 1ll * x * x); }, 8)
+                .then("aggregate", stage_mode::serial_in_order, [&](std::pair<int, long long> v) { running += v.second; return std::pair(v.first, running); })
+                .sink("emit", stage_mode::serial_in_order, [&](std::pair<int, long long> v) { emitted.push_back(v.second); ASSERT_EQ(v.first, static_cast<int>(emitted.size()) - 1); });
+            p.run();
+            ASSERT_EQ(emitted.size(), num);
+            long long expected = 0;
+            for (int i = 0; i < num; ++i)
+            {
+                expected += 1ll * i * i;
+                ASSERT_EQ(emitted[i], expected);
+            }
+            for (const auto& s : p.stats())
+                ASSERT_EQ(s.items, num);
+        }
+
+        // 乱序阶段处理所有元素；下游慢时各队列的长度不超过容量，源与下游之间的元素数有上限
+        {
+            std::atomic<int> produced = 0, consumed = 0, max_in_flight = 0;
+            std::vector<int> seen;
+            auto p = make_pipeline("source", [&]() -> std::optional<int>
+                {
+                    if (produced == 3000) return std::nullopt;
+                    const int in_flight = ++produced - consumed;
+                    int m = max_in_flight;
+                    while (in_flight > m && !max_in_flight.compare_exchange_weak(m, in_flight));
+                    return produced - 1;
+                })
+                .then("square", stage_mode::parallel, [](int x) { return x * 2; }, 4)
+                .then("any_order", stage_mode::serial_out_of_order, [](int x) { return x + 1; }, 4)
+                .sink("slow", stage_mode::serial_out_of_order, [&](int x)
+                    {
+                        if (x % 100 == 1) std::this_thread::sleep_for(std::chrono::microseconds(200));
+                        seen.push_back(x);
+                        ++consumed;
+                    }, 4);
+            p.run();
+            std::sort(seen.begin(), seen.end());
+            ASSERT_EQ(seen.size(), 3000u);
+            for (int i = 0; i < 3000; ++i)
+                ASSERT_EQ(seen[i], 2 * i + 1);
+            const auto stats = p.stats();
+            std::size_t capacity = 0, threads = 0;
+            for (std::size_t i = 1; i < stats.size(); ++i)
+            {
+                ASSERT_LE(stats[i].queue.max_size, stats[i].tokens);
+                capacity += stats[i].tokens;
+                threads += stats[i].threads;
+            }
+            // 默认的令牌数：每个阶段的线程各持有一个正在处理的元素，源另持有一个
+            ASSERT_EQ(p.max_in_flight(), capacity + threads + 1);
+            ASSERT_LE(max_in_flight.load(), static_cast<int>(p.max_in_flight()));
+            ASSERT_GT(stats.back().queue.full_waits + stats[1].queue.full_waits + stats[2].queue.full_waits, 0u);
+        }
+
+        // 并行阶段中的一个元素很慢时，其后的元素在按序阶段中暂存，令牌数限制了暂存的元素数
+        {
+            const int num = 3000;
+            int produced = 0;
+            std::atomic<int> consumed = 0;
+            int max_in_flight = 0;
+            auto p = make_pipeline("source", [&]() -> std::optional<int>
+                {
+                    if (produced == num) return std::nullopt;
+                    max_in_flight = std::max(max_in_flight, ++produced - consumed);
+                    return produced - 1;
+                })
+                .then("slow_first", stage_mode::parallel, [](int x)
+                    {
+                        if (x == 0) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                        return x;
+                    }, 4)
+                .sink("in_order", stage_mode::serial_in_order, [&](int x)
+                    {
+                        ASSERT_EQ(x, consumed.load());
+                        ++consumed;
+                    });
+            p.max_in_flight(32);
+            p.run();
+            ASSERT_EQ(consumed, num);
+            ASSERT_LE(max_in_flight, 32);
+            ASSERT_GT(max_in_flight, 1);
+        }
+
+        // cancel：源停止产生，已产生的元素仍全部流过
+        {
+            std::atomic<int> produced = 0;
+            int consumed = 0;
+            pipeline* self = nullptr;
+            auto p = make_pipeline("endless", [&]() -> std::optional<int> { return produced++; })
+                .then("id", stage_mode::parallel, [](int x) { return x; })
+                .sink("stop", stage_mode::serial_in_order, [&](int x)
+                    {
+                        ASSERT_EQ(x, consumed);
+                        if (++consumed == 100)
+                            self->cancel();
+                    });
+            self = &p;
+            p.run();
+            ASSERT_GE(consumed, 100);
+            ASSERT_EQ(consumed, produced.load());
+        }
+
+        // 阶段函数的异常在所有线程结束后重新抛出
+        {
+            int next = 0;
+            auto p = make_pipeline("source", [&]() -> std::optional<int> { return next++; })
+                .then("faulty", stage_mode::parallel, [](int x) { if (x == 500) throw std::runtime_error("bad record"); return x; })
+                .sink("emit", stage_mode::serial_out_of_order, [](int) {});
+            ASSERT_THROW(p.run(), std::runtime_error);
+        }
+    }
+
+    TEST(Test_pipeline, Test1)
+    {
+        // 解析与计算分散到多个线程，输出保持顺序；与串行处理对比并输出各阶段的统计
+        const int num = 200000;
+        std::vector<std::string> lines(num);
+        for (int i = 0; i < num; ++i) lines[i] = std::to_string(i) + "," + std::to_string(i % 97);
+        auto parse = [](const std::string& s)
+            {
+                const auto comma = s.find(',');
+                return std::pair<int, int>(std::stoi(s.substr(0, comma)), std::stoi(s.substr(comma + 1)));
+            };
+        auto enrich = [](std::pair<int, int> v)
+            {
+                double x = v.second;
+                for (int r = 0; r < 200; ++r)
+                    x = std::sqrt(x + r);
+                return x;
+            };
+        double sum1 = 0, sum2 = 0;
+        int next = 0;
+        auto p = make_pipeline("read", [&]() -> std::optional<std::string>
+            {
+                if (next == num) return std::nullopt;
+                return lines[next++];
+            })
+            .then("parse", stage_mode::parallel, parse, 64)
+            .then("enrich", stage_mode::parallel, enrich, 64)
+            .sink("aggregate", stage_mode::serial_in_order, [&](double x) { sum1 += x; }, 64);
+        BENCHMARK(p.run(); ,
+            for (const auto& line : lines) sum2 += enrich(parse(line)););
+        ASSERT_EQ(sum1, sum2);
+        for (const auto& s : p.stats())
+            LOG << s.name << ": " << s.threads << " threads, " << static_cast<long long>(s.throughput()) << " items/s, utilization "
+                << s.utilization() << ", queue average " << s.queue.average_size << "/" << s.tokens
+                << ", full waits " << s.queue.full_waits << std::endl;
+    }
+
+    TEST(Test_task_graph, Test0)
+    {
+        thread_pool pool(3);
+
+        // 菱形依赖与then、when_all：每个任务开始时其前驱都已完成，同一个图运行多次
+        {
+            task_graph g;
+            std::atomic<int> clock = 0;
+            int a = -1, b = -1, c = -1, d = -1, e = -1;
+            auto ta = g.emplace([&]() { a = clock++; });
+            auto tb = ta.then([&]() { b = clock++; });
+            auto tc = ta.then([&]() { c = clock++; });
+            auto td = g.when_all({ tb, tc }, [&]() { d = clock++; });
+            auto te = g.emplace([&]() { e = clock++; });
+            te.succeed(td, ta);
+            ASSERT_EQ(g.size(), 5u);
+            ASSERT_EQ(td.num_dependencies(), 2u);
+            ASSERT_EQ(ta.num_successors(), 3u);
+            for (int r = 0; r < 200; ++r)
+            {
+                clock = 0;
+                g.run(pool);
+                ASSERT_EQ(clock, 5);
+                ASSERT_EQ(a, 0);
+                ASSERT_LT(a, b);
+                ASSERT_LT(a, c);
+                ASSERT_LT(std::max(b, c), d);
+                ASSERT_EQ(e, 4);
+            }
+        }
+
+        // 随机的有向无环图（边只从编号小的节点指向编号大的节点），每个节点执行时其前驱都已完成
+        {
+            std::mt19937 gen(5);
+            const int num = 2000;
+            task_graph g;
+            std::vector<task_graph::task> tasks;
+            std::vector<std::vector<int>> preds(num);
+            std::vector<std::atomic<int>> done(num);
+            std::atomic<int> violations = 0;
+            for (int i = 0; i < num; ++i)
+            {
+                for (int k = 0; k < 3 && i > 0; ++k)
+                    preds[i].push_back(static_cast<int>(gen() % i));
+                std::sort(preds[i].begin(), preds[i].end());
+                preds[i].erase(std::unique(preds[i].begin(), preds[i].end()), preds[i].end());
+                tasks.push_back(g.emplace([&, i]()
+                    {
+                        for (int p : preds[i])
+                            if (!done[p]) ++violations;
+                        done[i] = 1;
+                    }, static_cast<int>(gen() % 4)));
+                for (int p : preds[i])
+                    tasks[p].precede(tasks[i]);
+            }
+            for (int r = 0; r < 5; ++r)
+            {
+                for (auto& x : done) x = 0;
+                g.run(pool);
+                ASSERT_EQ(violations, 0);
+                for (auto& x : done) ASSERT_EQ(x, 1);
+            }
+            // 可以在池中的任务里运行，也可以运行在默认线程池上
+            for (auto& x : done) x = 0;
+            pool.submit([&]() { g.run(pool); }).get();
+            ASSERT_EQ(violations, 0);
+            for (auto& x : done) ASSERT_EQ(x, 1);
+            for (auto& x : done) x = 0;
+            g.run();
+            for (auto& x : done) ASSERT_EQ(x, 1);
+        }
+
+        // 同时就绪的任务按优先级从高到低执行，优先级相同时按创建顺序
+        {
+            thread_pool single(1);
+            // 唯一的工作线程被占用，所有任务由调用run的线程依次执行
+            std::promise<void> entered, release;
+            auto blocker = single.submit([&]() { entered.set_value(); release.get_future().wait(); });
+            entered.get_future().wait();
+
+            task_graph g;
+            std::vector<int> order;
+            auto gate = g.emplace([&]() { order.push_back(-1); });
+            for (int i = 0; i < 12; ++i)
+                gate.then([&order, i]() { order.push_back(i); }, i % 4);
+            // 低优先级的任务完成后才就绪的高优先级任务，不会越过已在执行的任务
+            auto low = g.emplace([&]() { order.push_back(100); }, -1);
+            low.then([&]() { order.push_back(101); }, 10);
+            g.run(single);
+            release.set_value();
+            blocker.get();
+            const std::vector<int> expected = { -1, 3, 7, 11, 2, 6, 10, 1, 5, 9, 0, 4, 8, 100, 101 };
+            ASSERT_EQ(order, expected);
+        }
+
+        // 任务抛出的异常由run重新抛出，之后的任务不再执行，图仍可再次运行
+        {
+            task_graph g;
+            bool fail = true;
+            std::atomic<int> count = 0;
+            auto first = g.emplace([&]() { ++count; if (fail) throw std::runtime_error("failed"); });
+            auto second = first.then([&]() { ++count; });
+            second.then([&]() { ++count; });
+            ASSERT_THROW(g.run(pool), std::runtime_error);
+            ASSERT_EQ(count, 1);
+            fail = false;
+            g.run(pool);
+            ASSERT_EQ(count, 4);
+        }
+
+        // 空图
+        {
+            task_graph g;
+            g.run(pool);
+            ASSERT_TRUE(g.empty());
+        }
+
+        // 有环时run抛出异常且不执行任何任务；空任务与其它图的任务不能用于建立依赖，抛出异常时图不被修改
+        {
+            task_graph g, other;
+            int count = 0;
+            auto a = g.emplace([&]() { ++count; });
+            auto b = a.then([&]() { ++count; });
+            auto c = b.then([&]() { ++count; });
+            c.precede(a);
+            ASSERT_THROW(g.run(pool), std::logic_error);
+            ASSERT_EQ(count, 0);
+
+            task_graph h;
+            auto x = h.emplace([&]() { ++count; });
+            x.precede(x);
+            ASSERT_THROW(h.run(pool), std::logic_error);
+
+            auto foreign = other.emplace([]() {});
+            task_graph::task none;
+            ASSERT_THROW(a.precede(foreign), std::invalid_argument);
+            ASSERT_THROW(a.succeed(b, none), std::invalid_argument);
+            ASSERT_THROW(none.precede(a), std::invalid_argument);
+            ASSERT_THROW(none.then([]() {}), std::invalid_argument);
+            ASSERT_THROW(g.when_all({ a, foreign }, []() {}), std::invalid_argument);
+            ASSERT_EQ(g.size(), 3u);
+            ASSERT_EQ(a.num_dependencies(), 1u);
+            ASSERT_EQ(b.num_dependencies(), 1u);
+        }
+    }
+
+    TEST(Test_task_graph, Test1)
+    {
+        // 分块的波前计算：块(i, j)依赖(i - 1, j)与(i, j - 1)，同一条反对角线上的块可以同时计算
+        // 与每个块一个std::async、阻塞在前驱的future上等待相比，任务图只在前驱都完成时才提交任务，且可以反复运行
+        const int blocks = 16, block_size = 64, rounds = 20;
+        const int n = blocks * block_size;
+        std::vector<double> grid1((n + 1) * (n + 1), 1.0), grid2((n + 1) * (n + 1), 1.0);
+        auto compute = [n](std::vector<double>& grid, int bi, int bj)
+            {
+                for (int i = bi * block_size + 1; i <= (bi + 1) * block_size; ++i)
+                    for (int j = bj * block_size + 1; j <= (bj + 1) * block_size; ++j)
+                        grid[i * (n + 1) + j] = std::sqrt(grid[(i - 1) * (n + 1) + j] + grid[i * (n + 1) + j - 1]
+                            + grid[(i - 1) * (n + 1) + j - 1]);
+            };
+
+        task_graph g;
+        std::vector<task_graph::task> tasks(blocks * blocks);
+        for (int i = 0; i < blocks; ++i)
+            for (int j = 0; j < blocks; ++j)
+            {
+                tasks[i * blocks + j] = g.emplace([&, i, j]() { compute(grid1, i, j); }, 2 * blocks - i - j);
+                if (i > 0) tasks[(i - 1) * blocks + j].precede(tasks[i * blocks + j]);
+                if (j > 0) tasks[i * blocks + j - 1].precede(tasks[i * blocks + j]);
+            }
+
+        BENCHMARK(
+            for (int r = 0; r < rounds; ++r) g.run(); ,
+            for (int r = 0; r < rounds; ++r)
+            {
+                std::vector<std::shared_future<void>> futures(blocks * blocks);
+                for (int i = 0; i < blocks; ++i)
+                    for (int j = 0; j < blocks; ++j)
+                    {
+                        std::shared_future<void> up = i > 0 ? futures[(i - 1) * blocks + j] : std::shared_future<void>();
+                        std::shared_future<void> left = j > 0 ? futures[i * blocks + j - 1] : std::shared_future<void>();
+                        futures[i * blocks + j] = std::async(std::launch::async, [&, i, j, up, left]()
+                            {
+                                if (up.valid()) up.get();
+                                if (left.valid()) left.get();
+                                compute(grid2, i, j);
+                            }).share();
+                    }
+                futures.back().get();
+            });
+        ASSERT_EQ(grid1, grid2);
+    }
+
+    TEST(Test_execution_policy, Test0)
+    {
+        // 各策略的结果与std一致，阈值以下与非随机访问迭代器退回串行
+        std::mt19937 gen(11);
+        thread_pool pool(3);
+        const auto par_small = bitstl::execution::par.with_threshold(64).on(pool);
+        const auto par_unseq_small = bitstl::execution::par_unseq.with_threshold(64);
+        for (int n : { 0, 1, 50, 1000, 100003 })
+        {
+            std::vector<int> input(n);
+            for (auto& x : input) x = static_cast<int>(gen() % 1000);
+
+            auto check = [&](const auto& policy)
+                {
+                    std::vector<int> v = input;
+                    bitstl::for_each(policy, v.begin(), v.end(), [](int& x) { x *= 3; });
+                    std::vector<int> expected = input;
+                    std::for_each(expected.begin(), expected.end(), [](int& x) { x *= 3; });
+                    ASSERT_EQ(v, expected);
+
+                    std::vector<long long> w(n);
+                    ASSERT_EQ(bitstl::transform(policy, input.begin(), input.end(), w.begin(), [](int x) { return x * 2ll; }), w.end());
+                    ASSERT_EQ(bitstl::transform(policy, input.begin(), input.end(), w.begin(), w.begin(),
+                        [](int x, long long y) { return x + y; }), w.end());
+                    for (int i = 0; i < n; ++i)
+                        ASSERT_EQ(w[i], input[i] * 3ll);
+
+                    std::vector<int> c(n);
+                    ASSERT_EQ(bitstl::copy(policy, input.begin(), input.end(), c.begin()), c.end());
+                    ASSERT_EQ(c, input);
+                    bitstl::fill(policy, c.begin(), c.end(), 7);
+                    ASSERT_EQ(std::count(c.begin(), c.end(), 7), n);
+                    ASSERT_EQ(bitstl::fill_n(policy, c.data(), n / 2, -1), c.data() + n / 2);
+                    ASSERT_EQ(bitstl::for_each_n(policy, c.begin(), n / 2, [](int& x) { ++x; }), c.begin() + n / 2);
+                    ASSERT_EQ(std::count(c.begin(), c.end(), 0), n / 2);
+
+                    const long long sum = std::accumulate(input.begin(), input.end(), 0ll);
+                    ASSERT_EQ(bitstl::reduce(policy, input.begin(), input.end(), 0ll), sum);
+                    ASSERT_EQ(bitstl::reduce(policy, input.begin(), input.end()), static_cast<int>(sum));
+                    ASSERT_EQ(bitstl::transform_reduce(policy, input.begin(), input.end(), 0ll, std::plus<>(),
+                        [](int x) { return x * 2ll; }), sum * 2);
+                    ASSERT_EQ(bitstl::transform_reduce(policy, input.begin(), input.end(), input.begin(), 0ll),
+                        std::inner_product(input.begin(), input.end(), input.begin(), 0ll));
+
+                    for (int value : { 0, 500, 999, 1000 })
+                    {
+                        ASSERT_EQ(bitstl::find(policy, input.begin(), input.end(), value), std::find(input.begin(), input.end(), value));
+                        ASSERT_EQ(bitstl::count(policy, input.begin(), input.end(), value), std::count(input.begin(), input.end(), value));
+                        auto greater = [value](int x) { return x > value; };
+                        ASSERT_EQ(bitstl::find_if(policy, input.begin(), input.end(), greater), std::find_if(input.begin(), input.end(), greater));
+                        ASSERT_EQ(bitstl::count_if(policy, input.begin(), input.end(), greater), std::count_if(input.begin(), input.end(), greater));
+                    }
+
+                    std::vector<int> s = input;
+                    bitstl::sort(policy, s.begin(), s.end());
+                    ASSERT_TRUE(std::is_sorted(s.begin(), s.end()));
+                    std::vector<std::pair<int, int>> p(n), q(n);
+                    for (int i = 0; i < n; ++i) p[i] = q[i] = { input[i] % 10, i };
+                    auto by_first = [](const auto& a, const auto& b) { return a.first < b.first; };
+                    bitstl::stable_sort(policy, p.begin(), p.end(), by_first);
+                    std::stable_sort(q.begin(), q.end(), by_first);
+                    ASSERT_EQ(p, q);
+                };
+            check(bitstl::execution::seq);
+            check(bitstl::execution::unseq);
+            check(bitstl::execution::par);
+            check(bitstl::execution::par_unseq);
+            check(par_small);
+            check(par_unseq_small);
+        }
+
+        // 非随机访问迭代器
+        std::list<int> l(1000, 1);
+        bitstl::for_each(bitstl::execution::par, l.begin(), l.end(), [](int& x) { x += 1; });
+        ASSERT_EQ(bitstl::reduce(bitstl::execution::par, l.begin(), l.end(), 0), 2000);
+        ASSERT_EQ(bitstl::find(bitstl::execution::par_unseq, l.begin(), l.end(), 3), l.end());
+
+        // 元素访问函数的异常在所有分块结束后重新抛出
+        std::vector<int> v(100000, 1);
+        v[77777] = 0;
+        ASSERT_THROW(bitstl::for_each(par_small, v.begin(), v.end(), [](int x) { if (!x) throw std::runtime_error("zero"); }),
+            std::runtime_error);
+
+        static_assert(bitstl::execution::is_execution_policy_v<bitstl::execution::parallel_unsequenced_policy>);
+        static_assert(!bitstl::execution::is_execution_policy_v<std::execution::parallel_policy>);
+    }
+
+    TEST(Test_execution_policy, Test1)
+    {
+        std::mt19937 gen(12);
+        std::vector<float> a(int(2e7)), b(int(2e7));
+        for (auto& x : a) x = static_cast<float>(gen() % 100) / 100;
+        for (auto& x : b) x = static_cast<float>(gen() % 100) / 100;
+        std::vector<float> c1(a.size()), c2(a.size());
+        {
+            BENCHMARK(bitstl::transform(bitstl::execution::par_unseq, a.begin(), a.end(), b.begin(), c1.begin(), std::plus<>()); ,
+                std::transform(std::execution::par_unseq, a.begin(), a.end(), b.begin(), c2.begin(), std::plus<>()););
+            ASSERT_EQ(c1, c2);
+        }
+        {
+            double r1 = 0, r2 = 0;
+            BENCHMARK(r1 = bitstl::transform_reduce(bitstl::execution::par_unseq, a.begin(), a.end(), b.begin(), 0.0); ,
+                r2 = std::transform_reduce(std::execution::par_unseq, a.begin(), a.end(), b.begin(), 0.0););
+            const double exact = static_cast<double>(std::inner_product(a.begin(), a.end(), b.begin(), 0.0L));
+            ASSERT_NEAR(r1, exact, 1e-6 * exact);
+            // 标准库的相对误差约为3e-6，容差放宽一个数量级
+            ASSERT_NEAR(r2, exact, 1e-5 * exact);
+        }
+    }
+}
+
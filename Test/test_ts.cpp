@@ -1,163 +1,339 @@
-#include "pch.h"
-#include "common.h"
-
-namespace test_threadsafe
-{
-    TEST(Test_stack_ts, Test0)
-    {
-        stack_ts<int> test_stk;
-        int num = 10;
-
-        auto stack_op = [&]
-        {
-            std::thread::id id = std::this_thread::get_id();
-            for (int i = 0; i < num; ++i)
-            {
-                test_stk.push(i);
-#ifdef DEBUGGING
-                DEBUG_ST << "thread(" << id << ")" << " push:" << i << std::endl;
-#endif
-            }
-            for (int i = 0; i < num; ++i)
-            {
-                auto p = test_stk.pop();
-#ifdef DEBUGGING
-                DEBUG_ST << "thread(" << id << ")" << " pop:" << *p << std::endl;
-#endif
-            }
-            return;
-        };
-
-        std::vector<std::thread> vt;
-        vt.resize(3);
-        for (int i = 0; i < vt.size(); ++i)
-        {
-            vt[i] = std::thread(stack_op);
-        }
-        for (int i = 0; i < vt.size(); ++i)
-        {
-            vt[i].join();
-        }
-        ASSERT_TRUE(test_stk.empty());
-    }
-
-    TEST(Test_queue_t, Test0)
-    {
-        queue_ts<int> test_que;
-        int num = 10;
-
-        std::thread t1 = std::thread([&](int num)
-            {
-                while (num--)
-                    test_que.push(num);
-            }, num);
-
-        std::thread t2 = std::thread([&](int num)
-            {
-                int count = 0;
-                while (count < num)
-                {
-                    int t;
-                    test_que.wait_and_pop(t);
-#ifdef DEBUGGING
-                    DEBUG_ST << "process " << t << std::endl;
-#endif
-                    ++count;
-                }
-            }, num);
-
-        t1.detach();
-        t2.join();
-
-        ASSERT_TRUE(test_que.empty());
-    }
-
-    TEST(Test_unordered_map_ts, Test0)
-    {
-        unordered_map_ts<int, double> test_ump;
-
-        int tot_count = 50;
-        int remove_count = 0;
-        int actual_remove_count = 0;
-
-        std::vector<int> nums(tot_count, 0);
-        std::iota(nums.begin(), nums.end(), 0);
-
-        auto rd = std::random_device{};
-        auto rng = std::default_random_engine{ rd() };
-
-        // t1和t2按不同随机序列进行插入和删除，因此remove_count有几率不等于tot_count
-        std::thread t1 = std::thread([&]
-            {
-                auto index = nums;
-                std::shuffle(std::begin(index), std::end(index), rng);
-                for (int i = 0; i < index.size(); ++i)
-                {
-                    test_ump.add_or_update_value(index[i], std::sqrt(index[i]));
-                }
-            });
-
-        std::thread t2 = std::thread([&]
-            {
-                auto index = nums;
-                std::shuffle(std::begin(index), std::end(index), rng);
-                for (int i = 0; i < index.size(); ++i)
-                {
-                    if (test_ump.remove_value(index[i]))
-                    {
-                        remove_count += 1;
-#ifdef DEBUGGING
-                        DEBUG_ST << "remove " << index[i] << std::endl;
-#endif
-                    }
-                }
-            });
-
-        t1.join();
-        t2.join();
-
-        for (int i = 0; i < tot_count; ++i)
-        {
-            if (test_ump.get_value(i, -1) == -1)
-                actual_remove_count += 1;
-        }
-
-#ifdef DEBUGGING
-        DEBUG_ST << "remove_count: " << remove_count << std::endl;
-#endif
-        ASSERT_EQ(remove_count, actual_remove_count);
-    }
-
-    TEST(Test_list_ts, Test0)
-    {
-        list_ts<int> test_list;
-        int num = 20;
-
-        for (int i = 0; i < num; ++i)
-        {
-            test_list.push_front(i);
-        }
-
-        std::thread t1 = std::thread([&]
-            {
-                while (true)
-                {
-                    std::this_thread::sleep_for(milliseconds(10));
-                    test_list.remove_if([](int x) { return x % 2 == 0; });
-                }
-            });
-        t1.detach();
-        
-        std::thread t2 = std::thread([&]
-            {
-                while (!test_list.empty())
-                {
-                    std::this_thread::sleep_for(milliseconds(2));
-                    test_list.for_each([](int& x) { x *= 2; });
-                }
-            });
-        t2.join();
-
-        ASSERT_TRUE(test_list.empty());
-    }
+#include "pch.h"
+#include "common.h"
+
+namespace test_threadsafe
+{
+    TEST(Test_stack_ts, Test0)
+    {
+        stack_ts<int> test_stk;
+        int num = 10;
+
+        auto stack_op = [&]
+        {
+            std::thread::id id = std::this_thread::get_id();
+            for (int i = 0; i < num; ++i)
+            {
+                test_stk.push(i);
+#ifdef DEBUGGING
+                DEBUG_ST << "thread(" << id << ")" << " push:" << i << std::endl;
+#endif
+            }
+            for (int i = 0; i < num; ++i)
+            {
+                auto p = test_stk.pop();
+#ifdef DEBUGGING
+                DEBUG_ST << "thread(" << id << ")" << " pop:" << *p << std::endl;
+#endif
+            }
+            return;
+        };
+
+        std::vector<std::thread> vt;
+        vt.resize(3);
+        for (int i = 0; i < vt.size(); ++i)
+        {
+            vt[i] = std::thread(stack_op);
+        }
+        for (int i = 0; i < vt.size(); ++i)
+        {
+            vt[i].join();
+        }
+        ASSERT_TRUE(test_stk.empty());
+    }
+
+    TEST(Test_queue_t, Test0)
+    {
+        queue_ts<int> test_que;
+        int num = 10;
+
+        std::thread t1 = std::thread([&](int num)
+            {
+                while (num--)
+                    test_que.push(num);
+            }, num);
+
+        std::thread t2 = std::thread([&](int num)
+            {
+                int count = 0;
+                while (count < num)
+                {
+                    int t;
+                    test_que.wait_and_pop(t);
+#ifdef DEBUGGING
+                    DEBUG_ST << "process " << t << std::endl;
+#endif
+                    ++count;
+                }
+            }, num);
+
+        t1.detach();
+        t2.join();
+
+        ASSERT_TRUE(test_que.empty());
+    }
+
+    TEST(Test_bounded_queue_ts, Test0)
+    {
+        // 消费者慢于生产者时队列长度不超过容量，生产者阻塞
+        bounded_queue_ts<int> que(4);
+        const int num = 2000;
+        std::thread producer([&]
+            {
+                for (int i = 0; i < num; ++i)
+                    que.push(i);
+                que.close();
+            });
+        std::vector<int> popped;
+        int x = 0;
+        while (que.wait_and_pop(x))
+        {
+            popped.push_back(x);
+            if (popped.size() % 100 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        producer.join();
+        ASSERT_EQ(popped.size(), num);
+        for (int i = 0; i < num; ++i)
+            ASSERT_EQ(popped[i], i);
+        const queue_occupancy stats = que.stats();
+        ASSERT_EQ(stats.pushes, num);
+        ASSERT_LE(stats.max_size, 4u);
+        ASSERT_LE(stats.average_size, 4.0);
+
+        // 关闭后push失败，剩余元素仍可取出
+        bounded_queue_ts<std::unique_ptr<int>> q2(2);
+        ASSERT_TRUE(q2.try_push(std::make_unique<int>(1)));
+        ASSERT_TRUE(q2.push(std::make_unique<int>(2)));
+        ASSERT_FALSE(q2.try_push(std::make_unique<int>(3)));
+        q2.close();
+        ASSERT_FALSE(q2.push(std::make_unique<int>(4)));
+        std::unique_ptr<int> p;
+        ASSERT_TRUE(q2.try_pop(p));
+        ASSERT_EQ(*p, 1);
+        ASSERT_TRUE(q2.wait_and_pop(p));
+        ASSERT_EQ(*p, 2);
+        ASSERT_FALSE(q2.wait_and_pop(p));
+        ASSERT_TRUE(q2.empty());
+    }
+
+    TEST(Test_unordered_map_ts, Test0)
+    {
+        unordered_map_ts<int, double> test_ump;
+
+        int tot_count = 50;
+        int remove_count = 0;
+        int actual_remove_count = 0;
+
+        std::vector<int> nums(tot_count, 0);
+        std::iota(nums.begin(), nums.end(), 0);
+
+        auto rd = std::random_device{};
+        auto rng = std::default_random_engine{ rd() };
+
+        // t1和t2按不同随机序列进行插入和删除，因此remove_count有几率不等于tot_count
+        std::thread t1 = std::thread([&]
+            {
+                auto index = nums;
+                std::shuffle(std::begin(index), std::end(index), rng);
+                for (int i = 0; i < index.size(); ++i)
+                {
+                    test_ump.add_or_update_value(index[i], std::sqrt(index[i]));
+                }
+            });
+
+        std::thread t2 = std::thread([&]
+            {
+                auto index = nums;
+                std::shuffle(std::begin(index), std::end(index), rng);
+                for (int i = 0; i < index.size(); ++i)
+                {
+                    if (test_ump.remove_value(index[i]))
+                    {
+                        remove_count += 1;
+#ifdef DEBUGGING
+                        DEBUG_ST << "remove " << index[i] << std::endl;
+#endif
+                    }
+                }
+            });
+
+        t1.join();
+        t2.join();
+
+        for (int i = 0; i < tot_count; ++i)
+        {
+            if (test_ump.get_value(i, -1) == -1)
+                actual_remove_count += 1;
+        }
+
+#ifdef DEBUGGING
+        DEBUG_ST << "remove_count: " << remove_count << std::endl;
+#endif
+        ASSERT_EQ(remove_count, actual_remove_count);
+    }
+
+    TEST(Test_list_ts, Test0)
+    {
+        list_ts<int> test_list;
+        int num = 20;
+
+        for (int i = 0; i < num; ++i)
+        {
+            test_list.push_front(i);
+        }
+
+        std::thread t1 = std::thread([&]
+            {
+                while (!test_list.empty())
+                {
+                    std::this_thread::sleep_for(milliseconds(10));
+                    test_list.remove_if([](int x) { return x % 2 == 0; });
+                }
+            });
+        
+        std::thread t2 = std::thread([&]
+            {
+                while (!test_list.empty())
+                {
+                    std::this_thread::sleep_for(milliseconds(2));
+                    test_list.for_each([](int& x) { x *= 2; });
+                }
+            });
+        t2.join();
+        // t1访问test_list，须在test_list析构前结束
+        t1.join();
+
+        ASSERT_TRUE(test_list.empty());
+    }
+
+    TEST(Test_work_stealing_deque, Test0)
+    {
+        work_stealing_deque<int*> deq(4);
+        ASSERT_EQ(deq.pop(), nullptr);
+        ASSERT_EQ(deq.steal(), nullptr);
+
+        // 所有者后进先出，窃取者先进先出；容量不足时扩容
+        std::vector<int> items(100);
+        for (auto& x : items)
+            deq.push(&x);
+        ASSERT_EQ(deq.pop(), &items[99]);
+        ASSERT_EQ(deq.steal(), &items[0]);
+        while (deq.pop());
+        ASSERT_TRUE(deq.empty());
+
+        // 所有者push、pop的同时3个线程窃取，每个元素恰好被取走一次
+        const int num = 200000;
+        std::vector<int> values(num);
+        std::vector<std::atomic<int>> taken(num);
+        std::atomic<bool> owner_done(false);
+        auto take = [&](int* p) { taken[p - values.data()].fetch_add(1); };
+
+        std::vector<std::thread> thieves(3);
+        for (auto& t : thieves)
+        {
+            t = std::thread([&]
+                {
+                    while (!owner_done.load() || !deq.empty())
+                    {
+                        if (int* p = deq.steal())
+                            take(p);
+                    }
+                });
+        }
+        for (int i = 0; i < num; ++i)
+        {
+            deq.push(&values[i]);
+            if (i % 3 == 0)
+                if (int* p = deq.pop())
+                    take(p);
+        }
+        while (int* p = deq.pop())
+            take(p);
+        owner_done.store(true);
+        for (auto& t : thieves)
+            t.join();
+
+        for (int i = 0; i < num; ++i)
+            ASSERT_EQ(taken[i].load(), 1);
+    }
+
+    TEST(Test_magazine_allocator, Test0)
+    {
+        magazine_allocator<int> alloc;
+        int* p1 = alloc.allocate(1);
+        alloc.deallocate(p1, 1);
+        // 线程缓存后进先出
+        int* p2 = alloc.allocate(1);
+        ASSERT_EQ(p1, p2);
+        alloc.deallocate(p2, 1);
+
+        // 区块在一个线程分配，在另一个线程释放
+        std::vector<double*> blocks(1000);
+        magazine_allocator<double> dalloc;
+        std::thread t1([&]
+            {
+                for (auto& p : blocks)
+                    p = dalloc.allocate(1);
+            });
+        t1.join();
+        std::thread t2([&]
+            {
+                for (auto p : blocks)
+                    dalloc.deallocate(p, 1);
+            });
+        t2.join();
+
+        stack_ts<std::string, std::allocator<std::string>> test_stk;
+        test_stk.push("bitstl");
+        ASSERT_EQ(*test_stk.pop(), "bitstl");
+    }
+
+    TEST(Test_magazine_allocator, Test1)
+    {
+        // 每个线程对共享的容器反复push、pop，比较节点分配方式对扩展性的影响
+        const int total_ops = int(1e6);
+        auto run = [&](auto& container, int thread_num, auto op)
+            {
+                std::vector<std::thread> vt(thread_num);
+                for (auto& t : vt)
+                {
+                    t = std::thread([&]
+                        {
+                            for (int i = 0; i < total_ops / thread_num; ++i)
+                                op(container, i);
+                        });
+                }
+                for (auto& t : vt)
+                    t.join();
+            };
+
+        auto stack_op = [](auto& stk, int i)
+            {
+                stk.push(i);
+                stk.pop();
+            };
+        auto queue_op = [](auto& que, int i)
+            {
+                que.push(i);
+                que.try_pop();
+            };
+
+        for (int thread_num = 1; thread_num <= 64; thread_num *= 2)
+        {
+            LOG << "stack_ts, " << thread_num << " threads" << std::endl;
+            {
+                stack_ts<int> stk1;
+                stack_ts<int, std::allocator<int>> stk2;
+                BENCHMARK(run(stk1, thread_num, stack_op); ,
+                    run(stk2, thread_num, stack_op););
+            }
+            LOG << "queue_ts, " << thread_num << " threads" << std::endl;
+            {
+                queue_ts<int> que1;
+                queue_ts<int, std::allocator<int>> que2;
+                BENCHMARK(run(que1, thread_num, queue_op); ,
+                    run(que2, thread_num, queue_op););
+            }
+        }
+    }
 }
\ No newline at end of file